@@ -0,0 +1,33 @@
+/**\file alloc.cc
+ * \brief Count memory allocations for the benchmarks
+ *
+ *	Replaces the global operator new, so bench::Time() can
+ *	report allocations per item along with the time. The
+ *	default new[] and sized delete come through here too.
+ */
+
+//
+// Include files
+//
+#include <cstdlib>
+#include <new>
+
+#include "bench.h"
+
+long bench::Allocations = 0;
+
+void* operator new(size_t Size)
+{
+	bench::Allocations++;
+	void* Result = malloc(Size == 0 ? 1 : Size);
+	if (Result == 0)
+	{
+		throw std::bad_alloc();
+	}
+	return Result;
+}
+
+void operator delete(void* Pointer) noexcept
+{
+	free(Pointer);
+}
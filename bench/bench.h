@@ -0,0 +1,67 @@
+/**\file bench.h
+ * \brief Timing for the runtime library benchmarks
+ */
+#ifndef _bench_h_
+#define _bench_h_
+
+//
+// Include files
+//
+#include <chrono>
+#include <cstdio>
+
+namespace bench
+{
+/**
+ * \brief Somewhere to put results so the compiler can't drop them
+ */
+extern volatile long Sink;
+
+/**
+ * \brief Memory allocations so far (counted in alloc.cc)
+ */
+extern long Allocations;
+
+/**
+ * \brief Time a piece of code
+ *
+ *	Runs Body(Count) Repeat times and reports the best run, as
+ *	nanoseconds per item, along with the allocations per item.
+ *
+ * \return Best time, in nanoseconds per item
+ */
+template <class F>
+double Time(
+	const char* Name,	/**< What is being timed */
+	long Count,		/**< Items handled by one call of Body */
+	F Body,			/**< Code to time */
+	int Repeat = 5		/**< Number of runs */
+)
+{
+	double Best = 0.0;
+	long Allocated = 0;
+
+	for (int loop = 0; loop < Repeat; loop++)
+	{
+		long StartAllocations = Allocations;
+		std::chrono::steady_clock::time_point Start =
+			std::chrono::steady_clock::now();
+		Body(Count);
+		std::chrono::duration<double, std::nano> Elapsed =
+			std::chrono::steady_clock::now() - Start;
+		Allocated = Allocations - StartAllocations;
+
+		double PerItem = Elapsed.count() / Count;
+		if ((loop == 0) || (PerItem < Best))
+		{
+			Best = PerItem;
+		}
+	}
+
+	printf("%-32s %10.1f ns %12.0f /s %8.2f allocs\n", Name, Best,
+		1e9 / Best, (double)Allocated / Count);
+	return Best;
+}
+}
+
+#endif
@@ -0,0 +1,166 @@
+/**\file convert.cc
+ * \brief Benchmark number/text conversions
+ *
+ *	Times NUM$, STR$ and VAL against the C and C++ library
+ *	routines they replace, on a mix of "business" numbers
+ *	(amounts with two places) and random doubles.
+ */
+
+//
+// Include files
+//
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "basicfun.h"
+#include "bench.h"
+
+volatile long bench::Sink;
+
+int main(int argc, char **argv)
+{
+	long Count = (argc > 1) ? atol(argv[1]) : 1000000;
+	std::mt19937_64 Random(1);
+	std::vector<double> Numbers(Count);
+	std::vector<long> Integers(Count);
+	std::vector<std::string> Text(Count);
+	std::vector<std::string> FullText(Count);
+	std::vector<std::string> IntegerText(Count);
+
+	//
+	// Half amounts of money, half anything at all
+	//
+	for (long loop = 0; loop < Count; loop++)
+	{
+		if (loop & 1)
+		{
+			Numbers[loop] = (double)(long)(Random() % 10000000) / 100.0;
+		}
+		else
+		{
+			std::uniform_real_distribution<double> Any(-1e6, 1e6);
+			Numbers[loop] = Any(Random);
+		}
+		Integers[loop] = (long)(Random() % 2000000000) - 1000000000;
+		char Buffer[32];
+		snprintf(Buffer, sizeof(Buffer), "%.17g", Numbers[loop]);
+		FullText[loop] = Buffer;
+		Text[loop] = basic::str(Numbers[loop]);
+		IntegerText[loop] = std::to_string(Integers[loop]);
+	}
+
+	printf("%ld values\n\n", Count);
+
+	//
+	// Number to text
+	//
+	bench::Time("NUM$(double)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::Qnum(Numbers[loop]).size();
+		}
+	});
+	bench::Time("STR$(double)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::str(Numbers[loop]).size();
+		}
+	});
+	bench::Time("std::to_string(double)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += std::to_string(Numbers[loop]).size();
+		}
+	});
+	bench::Time("snprintf(%.17g)", Count, [&](long Count)
+	{
+		char Buffer[32];
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += snprintf(Buffer, sizeof(Buffer), "%.17g",
+				Numbers[loop]);
+		}
+	});
+	bench::Time("NUM$(long)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::Qnum(Integers[loop]).size();
+		}
+	});
+
+	//
+	// Text to number
+	//
+	printf("\n");
+	bench::Time("VAL (as printed)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += (long)basic::Val(Text[loop]);
+		}
+	});
+	bench::Time("strtod (as printed)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += (long)strtod(Text[loop].c_str(), 0);
+		}
+	});
+	bench::Time("VAL (17 digits)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += (long)basic::Val(FullText[loop]);
+		}
+	});
+	bench::Time("strtod (17 digits)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += (long)strtod(FullText[loop].c_str(), 0);
+		}
+	});
+	bench::Time("std::stod (17 digits)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += (long)std::stod(FullText[loop]);
+		}
+	});
+	bench::Time("VAL%", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::ValInteger(IntegerText[loop]);
+		}
+	});
+	bench::Time("std::stol", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += std::stol(IntegerText[loop]);
+		}
+	});
+
+	//
+	// Every value has to come back the same
+	//
+	for (long loop = 0; loop < Count; loop++)
+	{
+		if ((basic::Val(FullText[loop]) != Numbers[loop]) ||
+			(basic::Val(Text[loop]) != strtod(Text[loop].c_str(), 0)))
+		{
+			printf("\nMismatch: %s read back as %.17g\n",
+				FullText[loop].c_str(), basic::Val(FullText[loop]));
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+#!/bin/bash
+#
+# corpus.sh
+#
+#	End to end benchmark. Translates each program in example/,
+#	compiles it, and runs the ones that have scripted input in
+#	bench/input/<name>.in. Then does the same for the synthetic
+#	programs written by bench-genbas, which stress the parser,
+#	the string functions and file I/O.
+#
+#	The translate, compile and run times and peak memory (from
+#	bench-runstat) are written to a JSON report. Messages from
+#	the translator and compiler go to <name>.err in the work
+#	directory, and the program's output to <name>.out.
+#
+# Usage:
+#	corpus.sh <btran> <b1filter> <bin dir> <work dir> <report>
+#
+#	<bin dir> is where bench-runstat and bench-genbas are.
+#	The compiler is $CXX (default c++) with $CXXFLAGS (default
+#	-O2), against the headers in lib/ and $BTRAN_LIBRARY
+#	(default <bin dir>/lib/libbtran.a).
+#
+#	Sizes of the synthetic programs can be changed with
+#	GEN_PARSE (blocks), GEN_STRING (passes) and GEN_IO (lines).
+#	A run is stopped after $RUN_TIMEOUT (default 60) seconds.
+#
+
+if [ $# -ne 5 ]
+then
+	echo "Usage: $0 <btran> <b1filter> <bin dir> <work dir> <report>" >&2
+	exit 1
+fi
+
+BTRAN=$(realpath "$1")
+B1FILTER=$(realpath "$2")
+BINDIR=$(realpath "$3")
+WORK=$4
+REPORT=$(realpath -m "$5")
+
+HERE=$(dirname "$(realpath "$0")")
+EXAMPLE=$HERE/../example
+LIBDIR=$HERE/../lib
+LIBRARY=${BTRAN_LIBRARY:-$BINDIR/lib/libbtran.a}
+RUNSTAT=$BINDIR/bench-runstat
+GENBAS=$BINDIR/bench-genbas
+CXX=${CXX:-c++}
+CXXFLAGS=${CXXFLAGS:--O2}
+RUN_TIMEOUT=${RUN_TIMEOUT:-60}
+
+mkdir -p "$WORK" || exit 1
+cd "$WORK" || exit 1
+
+#
+# trek.bas reads this at run time
+#
+cp "$EXAMPLE/morgul.bas" .
+
+#
+# Program name, translator input filter, translator options.
+# The same ways example/Makefile builds them.
+#
+PROGRAMS="
+amazin b1filter -i
+kmaze - -
+moon - -
+revrse - -i
+snak b1filter -
+snoopy - -
+superstartrek - -
+trek b1filter -
+works - -
+"
+
+#
+# Synthetic programs: name, bench-genbas arguments
+#
+GENERATED="
+gen-parse parse ${GEN_PARSE:-350}
+gen-string string ${GEN_STRING:-200000}
+gen-io io ${GEN_IO:-200000}
+"
+
+FIRST=1
+
+#
+# Translate, compile and (maybe) run one program
+#
+# $1 = name, $2 = BASIC source, $3 = filter, $4 = options,
+# $5 = input for the run ("" to not run it)
+#
+bench_one()
+{
+	local name=$1 source=$2 filter=$3 options=$4 input=$5
+	local translate compile run="null" input_file=$source
+
+	echo "$name" >&2
+
+	if [ "$filter" = "b1filter" ]
+	then
+		"$B1FILTER" "$source" > "$name.b2s"
+		input_file=$name.b2s
+	fi
+	[ "$options" = "-" ] && options=""
+
+	rm -f "$name" "$name.out"
+	translate=$("$RUNSTAT" -o "$name.cc" "$BTRAN" $options \
+		"$input_file" 2> "$name.err")
+	compile=$("$RUNSTAT" $CXX $CXXFLAGS -w -std=c++14 -I "$LIBDIR" \
+		"$name.cc" "$LIBRARY" -o "$name" 2>> "$name.err")
+
+	if [ -n "$input" ] && [ -x "$name" ]
+	then
+		run=$("$RUNSTAT" -i "$input" -o "$name.out" \
+			timeout "$RUN_TIMEOUT" "./$name")
+	fi
+
+	[ $FIRST -eq 0 ] && echo "," >> "$REPORT"
+	FIRST=0
+	printf '\t\t{ "name": "%s", "lines": %d,\n' \
+		"$name" $(wc -l < "$source") >> "$REPORT"
+	printf '\t\t  "translate": %s,\n' "$translate" >> "$REPORT"
+	printf '\t\t  "compile": %s,\n' "$compile" >> "$REPORT"
+	printf '\t\t  "run": %s }' "$run" >> "$REPORT"
+}
+
+printf '{\n\t"cxx": "%s",\n\t"cxxflags": "%s",\n\t"programs": [\n' \
+	"$CXX" "$CXXFLAGS" > "$REPORT"
+
+while read name filter options
+do
+	[ -z "$name" ] && continue
+	input=""
+	[ -f "$HERE/input/$name.in" ] && input=$HERE/input/$name.in
+	bench_one "$name" "$EXAMPLE/$name.bas" "$filter" "$options" "$input"
+done <<< "$PROGRAMS"
+
+while read name kind size
+do
+	[ -z "$name" ] && continue
+	"$GENBAS" $kind $size > "$name.bas"
+	bench_one "$name" "$name.bas" - - /dev/null
+done <<< "$GENERATED"
+
+printf '\n\t]\n}\n' >> "$REPORT"
+echo "Report in $REPORT" >&2
@@ -0,0 +1,127 @@
+/**\file error.cc
+ * \brief Benchmark raising and handling errors
+ *
+ *	Compares the ways a translated program gets from an error
+ *	to its handler: throwing to a WHEN ERROR IN block, and
+ *	jumping to an ON ERROR GOTO handler, along with the cost of
+ *	looking up the message with ERT$.
+ */
+
+//
+// Include files
+//
+#include <cstdlib>
+#include <string>
+
+#include "basicfun.h"
+#include "bench.h"
+
+volatile long bench::Sink;
+
+/**
+ * \brief Errors caught by WHEN ERROR IN
+ */
+static void RaiseThrow(
+	long Count		/**< Errors to raise */
+)
+{
+	for (long loop = 0; loop < Count; loop++)
+	{
+		try
+		{
+			throw basic::BasicError(basic::ErrEndOfFile, 100);
+		}
+		catch (basic::BasicError &Be)
+		{
+			basic::Context().Error = Be;
+			bench::Sink += basic::err();
+		}
+	}
+}
+
+/**
+ * \brief Errors trapped by ON ERROR GOTO, building a BasicError
+ *
+ *	What OnErrorHit used to do.
+ */
+static void RaiseCopy(
+	long Count		/**< Errors to raise */
+)
+{
+	OnErrorStack;
+
+	for (long loop = 0; loop < Count; loop++)
+	{
+		OnErrorGoto(Handler);
+		if (ErrorStack)
+		{
+			basic::Context().Error = basic::BasicError(basic::ErrEndOfFile, 100);
+			goto *ErrorStack;
+		}
+		continue;
+Handler:
+		bench::Sink += basic::err();
+	}
+}
+
+/**
+ * \brief Errors trapped by ON ERROR GOTO
+ */
+static void RaiseLight(
+	long Count		/**< Errors to raise */
+)
+{
+	OnErrorStack;
+
+	for (long loop = 0; loop < Count; loop++)
+	{
+		OnErrorGoto(Handler);
+		OnErrorHit(basic::ErrEndOfFile, 100);
+		continue;
+Handler:
+		bench::Sink += basic::err();
+	}
+}
+
+int main(int argc, char **argv)
+{
+	long Count = (argc > 1) ? atol(argv[1]) : 1000000;
+
+	printf("%ld errors\n\n", Count);
+
+	bench::Time("WHEN ERROR IN (throw)", Count / 10, RaiseThrow);
+	bench::Time("ON ERROR GOTO (copy)", Count, RaiseCopy);
+	bench::Time("ON ERROR GOTO", Count, RaiseLight);
+
+	bench::Time("ERT$", Count, [](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::ert(loop % 300).size();
+		}
+	});
+	bench::Time("ERT$ into a new string", Count, [](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			std::string Text = basic::ert(loop % 300);
+			bench::Sink += Text.size();
+		}
+	});
+
+	//
+	// Both ways have to leave the same thing behind
+	//
+	RaiseThrow(1);
+	int ThrowErr = basic::err();
+	RaiseLight(1);
+	if ((ThrowErr != basic::ErrEndOfFile) || (basic::err() != ThrowErr) ||
+		(basic::erl() != 100) ||
+		(basic::ert(basic::err()) != "?End of file on device"))
+	{
+		printf("\nError state mismatch\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
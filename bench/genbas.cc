@@ -0,0 +1,166 @@
+/**\file genbas.cc
+ * \brief Write synthetic BASIC programs for the corpus benchmark
+ *
+ *	Usage: bench-genbas parse|string|io <size>
+ *
+ *	parse	A long program (<size> blocks of assignments, IF,
+ *		SELECT and string expressions, and a SUB for every
+ *		50 blocks), to load the translator and the compiler.
+ *	string	A loop of <size> passes through the string functions
+ *		(concatenation, LEFT$, MID$, RIGHT$, INSTR, EDIT$,
+ *		SEG$, TRM$, NUM1$ and VAL).
+ *	io	Writes <size> lines to a file with PRINT #, then
+ *		reads them back with LINPUT #.
+ *
+ *	Each program prints a CHECK line, so a run can be checked
+ *	against another translator or library version.
+ */
+
+//
+// Include files
+//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * \brief Long program for the translator
+ */
+static void Parse(
+	long Size		/**< Number of blocks */
+)
+{
+	long Subs = (Size + 49) / 50;
+
+	printf("1\t! Synthetic parser benchmark, %ld blocks\n", Size);
+	printf("\tDECLARE LONG A, B, C, T\n");
+	printf("\tDECLARE STRING S\n");
+	printf("\tT = 0\n");
+
+	for (long loop = 1; loop <= Size; loop++)
+	{
+		//
+		// BASIC line numbers stop at 32767
+		//
+		if (loop + 1000 < 32000)
+		{
+			printf("%ld", loop + 1000);
+		}
+		printf("\tA = %ld * 3%% + B - (C / 7%%)\n", loop);
+		printf("\tIF A > %ld THEN\n", loop);
+		printf("\t\tB = B + 1%%\n");
+		printf("\tELSE\n");
+		printf("\t\tC = C + 2%%\n");
+		printf("\tEND IF\n");
+		printf("\tSELECT MOD(A, 4%%)\n");
+		printf("\tCASE 0\n");
+		printf("\t\tS = \"ZERO\" + NUM1$(%ld)\n", loop);
+		printf("\tCASE 1, 2\n");
+		printf("\t\tS = LEFT$(\"BLOCK%ld\", 3%%)\n", loop);
+		printf("\tCASE ELSE\n");
+		printf("\t\tS = \"\"\n");
+		printf("\tEND SELECT\n");
+		printf("\tT = T + LEN(S) + MOD(A, 1000%%)\n");
+		if (loop % 50 == 0)
+		{
+			printf("\tCALL GEN%ld(T)\n", loop / 50);
+		}
+	}
+
+	printf("\tPRINT \"CHECK\"; T\n");
+	printf("32767\tEND\n");
+
+	for (long loop = 1; loop <= Subs; loop++)
+	{
+		printf("\n\tSUB GEN%ld(LONG X)\n", loop);
+		printf("\tDECLARE LONG I\n");
+		printf("\tFOR I = 1 TO %ld\n", loop % 10 + 1);
+		printf("\t\tX = X + I * %ld\n", loop);
+		printf("\tNEXT I\n");
+		printf("\tEND SUB\n");
+	}
+}
+
+/**
+ * \brief Loop through the string functions
+ */
+static void String(
+	long Size		/**< Passes through the loop */
+)
+{
+	printf("1\t! Synthetic string benchmark, %ld passes\n", Size);
+	printf("\tDECLARE LONG I, J, T\n");
+	printf("\tT = 0\n");
+	printf("\tFOR I = 1 TO %ld\n", Size);
+	printf("\t\tA$ = \"ITEM\" + NUM1$(I) + \"-\" + "
+		"STRING$(MOD(I, 7) + 1, 65 + MOD(I, 26))\n");
+	printf("\t\tB$ = LEFT$(A$, 3) + MID$(A$, 5, 4) + RIGHT$(A$, 6)\n");
+	printf("\t\tJ = INSTR(1, B$, \"-\")\n");
+	printf("\t\tC$ = EDIT$(\"  \" + B$ + \"  \", 128 + 8)\n");
+	printf("\t\tIF C$ <> \"\" THEN T = T + LEN(C$) + J\n");
+	printf("\t\tD$ = SEG$(C$, 2, 5) + TRM$(A$ + \"   \")\n");
+	printf("\t\tT = T + VAL(NUM1$(MOD(I, 100))) + LEN(D$)\n");
+	printf("\tNEXT I\n");
+	printf("\tPRINT \"CHECK\"; T\n");
+	printf("\tEND\n");
+}
+
+/**
+ * \brief Write a file and read it back
+ */
+static void Io(
+	long Size		/**< Lines to write */
+)
+{
+	printf("1\t! Synthetic I/O benchmark, %ld lines\n", Size);
+	printf("\tDECLARE LONG I, T\n");
+	printf("\tON ERROR GOTO 19000\n");
+	printf("\tOPEN \"genio.tmp\" FOR OUTPUT AS FILE #1%%\n");
+	printf("\tFOR I = 1 TO %ld\n", Size);
+	printf("\t\tPRINT #1%%, \"LINE\"; I; \"VALUE\"; I * 3\n");
+	printf("\tNEXT I\n");
+	printf("\tCLOSE #1%%\n");
+	printf("\tOPEN \"genio.tmp\" FOR INPUT AS FILE #1%%\n");
+	printf("\tT = 0\n");
+	printf("\tFOR I = 1 TO %ld\n", Size);
+	printf("\t\tLINPUT #1%%, L$\n");
+	printf("\t\tT = T + LEN(L$)\n");
+	printf("\tNEXT I\n");
+	printf("\tCLOSE #1%%\n");
+	printf("\tKILL \"genio.tmp\"\n");
+	printf("\tPRINT \"CHECK\"; T\n");
+	printf("\tGOTO 32767\n");
+	printf("\n19000\tPRINT \"ERROR\"; ERR; \"AT\"; ERL\n");
+	printf("\tRESUME 32767\n");
+	printf("\n32767\tEND\n");
+}
+
+int main(int argc, char* argv[])
+{
+	long Size = (argc > 2) ? atol(argv[2]) : 0;
+
+	if ((argc != 3) || (Size <= 0))
+	{
+		fprintf(stderr, "Usage: %s parse|string|io <size>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (strcmp(argv[1], "parse") == 0)
+	{
+		Parse(Size);
+	}
+	else if (strcmp(argv[1], "string") == 0)
+	{
+		String(Size);
+	}
+	else if (strcmp(argv[1], "io") == 0)
+	{
+		Io(Size);
+	}
+	else
+	{
+		fprintf(stderr, "%s: unknown program '%s'\n", argv[0], argv[1]);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,259 @@
+/**\file library.cc
+ * \brief Benchmark the runtime library's everyday routines
+ *
+ *	One pass over each of the routines translated programs
+ *	spend their time in: PRINT USING, EDIT$, NUM$/STR$, INSTR,
+ *	LSET/RSET, READ from DATA, and arrays built by
+ *	VectorGenerator. Inputs are a fixed mix of the kinds of
+ *	values business programs use, so runs can be compared.
+ */
+
+//
+// Include files
+//
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "basicfun.h"
+#include "datalist.h"
+#include "pusing.h"
+#include "bench.h"
+
+volatile long bench::Sink;
+
+/**
+ * \brief DATA statement values, as the translator writes them
+ */
+static const char* DataValues[] =
+{
+	"10", "ACME WIDGETS", "1234.56", "-7", "SMITH, J", "0.001",
+	"42", "NET 30", "99999.99", "3", "RETURNED", "-0.5",
+	"100", "INVOICE", "12.5", "8", "PAID IN FULL", "65535",
+	0
+};
+
+int main(int argc, char **argv)
+{
+	long Count = (argc > 1) ? atol(argv[1]) : 200000;
+	std::mt19937_64 Random(1);
+	std::vector<double> Amounts(Count);
+	std::vector<long> Integers(Count);
+	std::vector<std::string> Lines(Count);
+	const char* Names[] = { "  acme widgets  ", "Smith,\tJohn ",
+		"  INVOICE 1234 ", "net 30 days", "\"quoted  text\"  " };
+
+	for (long loop = 0; loop < Count; loop++)
+	{
+		Amounts[loop] = (double)(long)(Random() % 10000000) / 100.0;
+		if (loop & 1)
+		{
+			Amounts[loop] = -Amounts[loop];
+		}
+		Integers[loop] = (long)(Random() % 2000000) - 1000000;
+		Lines[loop] = std::string(Names[loop % 5]) + " ORDER " +
+			std::to_string(Integers[loop]) + " STATUS OPEN";
+	}
+
+	printf("%ld values\n\n", Count);
+
+	//
+	// PRINT USING
+	//
+	basic::PUsing Money("$$#,###,###.##-");
+	bench::Time("PUsing::Output(money)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			Money.SetFormat("$$#,###,###.##-");
+			bench::Sink += Money.Output(Amounts[loop]).size() +
+				Money.Finish().size();
+		}
+	});
+	basic::PUsing Fixed("####.##");
+	bench::Time("PUsing::Output(####.##)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			Fixed.SetFormat("####.##");
+			bench::Sink += Fixed.Output(Amounts[loop] / 1000.0).size() +
+				Fixed.Finish().size();
+		}
+	});
+	basic::PUsing Text("'LLLLLLLLLLLLLLL|");
+	bench::Time("PUsing::Output(string)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			Text.SetFormat("'LLLLLLLLLLLLLLL|");
+			bench::Sink += Text.Output(Lines[loop]).size() +
+				Text.Finish().size();
+		}
+	});
+
+	//
+	// EDIT$
+	//
+	printf("\n");
+	bench::Time("edit(32) upper case", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::edit(Lines[loop], 32).size();
+		}
+	});
+	bench::Time("edit(8+128) trim", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::edit(Lines[loop], 8 + 128).size();
+		}
+	});
+	bench::Time("edit(2+16+32+256) squeeze", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::edit(Lines[loop], 2 + 16 + 32 + 256).size();
+		}
+	});
+
+	//
+	// NUM$ and STR$
+	//
+	printf("\n");
+	bench::Time("Qnum(double)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::Qnum(Amounts[loop]).size();
+		}
+	});
+	bench::Time("Qnum(long)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::Qnum(Integers[loop]).size();
+		}
+	});
+	bench::Time("str(double)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::str(Amounts[loop]).size();
+		}
+	});
+	bench::Time("str(long)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::str(Integers[loop]).size();
+		}
+	});
+
+	//
+	// INSTR
+	//
+	printf("\n");
+	bench::Time("instr(string)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::instr(1, Lines[loop], "STATUS");
+		}
+	});
+	basic::Needle Status("STATUS");
+	bench::Time("instr(Needle)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::instr(1, Lines[loop], Status);
+		}
+	});
+	bench::Time("instr(char, not found)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			bench::Sink += basic::instr(1, Lines[loop], "#");
+		}
+	});
+
+	//
+	// LSET and RSET into a field
+	//
+	printf("\n");
+	std::string Field(20, ' ');
+	bench::Time("Lset(20)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			Lset(Field, Lines[loop]);
+			bench::Sink += Field[0];
+		}
+	});
+	bench::Time("Rset(20)", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			Rset(Field, Names[loop % 5]);
+			bench::Sink += Field[19];
+		}
+	});
+
+	//
+	// READ from DATA, as a program reading a table would:
+	// a number, a name and an amount at a time.
+	//
+	printf("\n");
+	basic::DataListClass DataList(DataValues);
+	bench::Time("DataListClass::Read (3 items)", Count, [&](long Count)
+	{
+		long Number;
+		std::string Name;
+		double Amount;
+
+		for (long loop = 0; loop < Count; loop++)
+		{
+			if (loop % 6 == 0)
+			{
+				DataList.Reset();
+			}
+			DataList.Read(Number);
+			DataList.Read(Name);
+			DataList.Read(Amount);
+			bench::Sink += Number + Name.size() + (long)Amount;
+		}
+	});
+
+	//
+	// DIM A(9,9), built and summed
+	//
+	printf("\n");
+	bench::Time("VectorGenerator(10,10) build", Count / 10, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			auto Array = basic::VectorGenerator<double>::Generate(10, 10);
+			bench::Sink += Array.size();
+		}
+	});
+	auto Table = basic::VectorGenerator<double>::Generate(100, 100);
+	bench::Time("VectorGenerator(100,100) sum", Count / 100, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			double Sum = 0.0;
+			for (size_t row = 0; row < Table.size(); row++)
+			{
+				for (size_t column = 0; column < Table[row].size(); column++)
+				{
+					Sum += Table[row][column];
+				}
+			}
+			Table[loop % 100][loop % 97] += 1.0;
+			bench::Sink += (long)Sum;
+		}
+	});
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,118 @@
+/**\file runstat.cc
+ * \brief Run a command and report the time and memory it used
+ *
+ *	Used by corpus.sh to time the translator, the compiler and
+ *	the translated programs. Prints one JSON object:
+ *
+ *	{ "status": 0, "wall_ms": 12.3, "user_ms": 10.1,
+ *	  "sys_ms": 2.0, "peak_rss_kb": 4520 }
+ *
+ *	The CPU times and peak RSS cover everything the command
+ *	started too (the compiler driver runs cc1plus and as), as
+ *	long as it waited for them.
+ *
+ *	Usage: bench-runstat [-i input] [-o output] command [args...]
+ */
+
+//
+// Include files
+//
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \brief Point a file descriptor at a file
+ */
+static void Redirect(
+	int Fd,			/**< Descriptor to replace */
+	const char* Name,	/**< File to use */
+	int Flags		/**< How to open it */
+)
+{
+	int NewFd = open(Name, Flags, 0644);
+
+	if (NewFd < 0)
+	{
+		perror(Name);
+		_exit(127);
+	}
+	dup2(NewFd, Fd);
+	close(NewFd);
+}
+
+int main(int argc, char* argv[])
+{
+	const char* Input = "/dev/null";
+	const char* Output = "/dev/null";
+	int Arg = 1;
+
+	while ((Arg + 1 < argc) && (argv[Arg][0] == '-'))
+	{
+		if (strcmp(argv[Arg], "-i") == 0)
+		{
+			Input = argv[Arg + 1];
+		}
+		else if (strcmp(argv[Arg], "-o") == 0)
+		{
+			Output = argv[Arg + 1];
+		}
+		else
+		{
+			break;
+		}
+		Arg += 2;
+	}
+	if (Arg >= argc)
+	{
+		fprintf(stderr, "Usage: %s [-i input] [-o output] "
+			"command [args...]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::chrono::steady_clock::time_point Start =
+		std::chrono::steady_clock::now();
+
+	pid_t Child = fork();
+	if (Child < 0)
+	{
+		perror("fork");
+		return EXIT_FAILURE;
+	}
+	if (Child == 0)
+	{
+		Redirect(0, Input, O_RDONLY);
+		Redirect(1, Output, O_WRONLY | O_CREAT | O_TRUNC);
+		execvp(argv[Arg], argv + Arg);
+		perror(argv[Arg]);
+		_exit(127);
+	}
+
+	int Status;
+	while ((waitpid(Child, &Status, 0) < 0) && (errno == EINTR))
+	{
+	}
+
+	std::chrono::duration<double, std::milli> Wall =
+		std::chrono::steady_clock::now() - Start;
+	struct rusage Usage;
+	getrusage(RUSAGE_CHILDREN, &Usage);
+
+	int ExitCode = WIFEXITED(Status) ? WEXITSTATUS(Status) :
+		128 + WTERMSIG(Status);
+
+	printf("{ \"status\": %d, \"wall_ms\": %.3f, \"user_ms\": %.3f, "
+		"\"sys_ms\": %.3f, \"peak_rss_kb\": %ld }\n",
+		ExitCode, Wall.count(),
+		Usage.ru_utime.tv_sec * 1e3 + Usage.ru_utime.tv_usec / 1e3,
+		Usage.ru_stime.tv_sec * 1e3 + Usage.ru_stime.tv_usec / 1e3,
+		Usage.ru_maxrss);
+
+	return ExitCode;
+}
@@ -0,0 +1,104 @@
+/**\file search.cc
+ * \brief Benchmark INSTR
+ *
+ *	Searches long records for strings of several lengths, the
+ *	way a parsing program does, comparing INSTR (with and without
+ *	a prepared search string) against std::string::find.
+ */
+
+//
+// Include files
+//
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "basicfun.h"
+#include "bench.h"
+
+volatile long bench::Sink;
+
+int main(int argc, char **argv)
+{
+	long Count = (argc > 1) ? atol(argv[1]) : 20000;
+	std::mt19937 Random(1);
+	std::vector<std::string> Records(64);
+	const char* Words[] = { "CUSTOMER", "INVOICE", "AMOUNT", "DATE",
+		"STATUS", "REMARK", "ADDRESS", "BALANCE" };
+
+	//
+	// Records of "KEY=VALUE," pairs, about 4K each, with what is
+	// being looked for near the end.
+	//
+	for (size_t loop = 0; loop < Records.size(); loop++)
+	{
+		std::string& Record = Records[loop];
+
+		while (Record.size() < 4000)
+		{
+			Record += Words[Random() % 8];
+			Record += '=';
+			for (int digit = 0; digit < 8; digit++)
+			{
+				Record += (char)('0' + Random() % 10);
+			}
+			Record += ',';
+		}
+		Record += "TERMS=NET30;SHIPPING_INSTRUCTIONS=LEAVE AT THE REAR "
+			"DOOR IF NOBODY ANSWERS|";
+	}
+
+	const char* Patterns[] = { "|", "NET", "TERMS=NET30",
+		"SHIPPING_INSTRUCTIONS=LEAVE AT THE REAR DOOR IF NOBODY" };
+
+	printf("%ld searches of %lu byte records\n\n", Count,
+		(unsigned long)Records[0].size());
+
+	for (int which = 0; which < 4; which++)
+	{
+		std::string Pattern = Patterns[which];
+		basic::Needle Prepared(Pattern);
+
+		printf("Search string of %lu\n", (unsigned long)Pattern.size());
+
+		bench::Time("  INSTR", Count, [&](long Count)
+		{
+			for (long loop = 0; loop < Count; loop++)
+			{
+				bench::Sink += basic::instr(1, Records[loop & 63], Pattern);
+			}
+		});
+		bench::Time("  INSTR (prepared)", Count, [&](long Count)
+		{
+			for (long loop = 0; loop < Count; loop++)
+			{
+				bench::Sink += basic::instr(1, Records[loop & 63], Prepared);
+			}
+		});
+		bench::Time("  std::string::find", Count, [&](long Count)
+		{
+			for (long loop = 0; loop < Count; loop++)
+			{
+				bench::Sink += Records[loop & 63].find(Pattern);
+			}
+		});
+
+		//
+		// Has to find the same place
+		//
+		for (size_t loop = 0; loop < Records.size(); loop++)
+		{
+			size_t Want = Records[loop].find(Pattern) + 1;
+
+			if ((basic::instr(1, Records[loop], Pattern) != (int)Want) ||
+				(basic::instr(1, Records[loop], Prepared) != (int)Want))
+			{
+				printf("\nMismatch searching for %s\n", Patterns[which]);
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
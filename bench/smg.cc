@@ -0,0 +1,124 @@
+/**\file smg.cc
+ * \brief Benchmark batched and unbatched SMG screen updates
+ *
+ *	Draws the same data entry screen over and over on the
+ *	headless pasteboard, once with every call output as it is
+ *	made, and once with the screen built inside a display
+ *	update. Besides the time, reports the frames output and the
+ *	cells they changed (smg_headless_frames/smg_headless_cells),
+ *	which is roughly what a terminal would have been sent.
+ */
+
+//
+// Include files
+//
+#include <cstdlib>
+#include <string>
+
+#include "smgroutines.h"
+#include "bench.h"
+
+volatile long bench::Sink;
+
+/**
+ * \brief Field labels on the screen
+ */
+static const char* Labels[] =
+{
+	"Customer", "Name", "Address", "City", "State", "Zip",
+	"Phone", "Terms", "Credit limit", "Balance", "Last order",
+	"Salesman", "Territory", "Status",
+	0
+};
+
+/**
+ * \brief Draw one screen
+ *
+ *	Each screen differs from the one before it in its values,
+ *	as when paging through records.
+ */
+static void DrawScreen(
+	ncurses_struct *Display,	/**< Display to draw on */
+	long Record			/**< Record being shown */
+)
+{
+	smg$erase_display(&Display, 1, 20, 1, 78);
+	smg$put_chars(&Display, "CUSTOMER MAINTENANCE", 29, 0, 0,
+		SMG$M_BOLD);
+	smg$draw_line(&Display, 2, 1, 2, 78);
+
+	for (int loop = 0; Labels[loop] != 0; loop++)
+	{
+		std::string Value = std::to_string(Record * 31 + loop * 7);
+
+		smg$put_chars(&Display, Labels[loop], 2, loop + 3);
+		smg$put_chars(&Display, Value, 20, loop + 3, 0, SMG$M_REVERSE);
+	}
+	smg$put_chars(&Display, "Record " + std::to_string(Record),
+		2, 19);
+}
+
+/**
+ * \brief Frames and cells output by one way of drawing
+ */
+static void Report(
+	const char* Name,	/**< How it was drawn */
+	long Count,		/**< Screens drawn */
+	long Frames,		/**< Frames before drawing */
+	long Cells		/**< Cells before drawing */
+)
+{
+	printf("%-32s %10.1f frames %8.1f cells per screen\n", Name,
+		(double)(smg_headless_frames() - Frames) / Count,
+		(double)(smg_headless_cells() - Cells) / Count);
+}
+
+int main(int argc, char **argv)
+{
+	long Count = (argc > 1) ? atol(argv[1]) : 2000;
+	long Pasteboard;
+	std::string Device("NL:");
+	ncurses_struct *Display;
+	long Frames;
+	long Cells;
+
+	smg$create_pasteboard(&Pasteboard, &Device);
+	smg$create_virtual_display(20, 78, &Display, SMG$M_BORDER, 0, 0);
+	smg$paste_virtual_display(&Display, &Pasteboard, 2, 2);
+
+	printf("%ld screens\n\n", Count);
+
+	//
+	// Every call output as it is made
+	//
+	Frames = smg_headless_frames();
+	Cells = smg_headless_cells();
+	bench::Time("unbatched", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			DrawScreen(Display, loop);
+		}
+	}, 1);
+	Report("unbatched output", Count, Frames, Cells);
+
+	//
+	// The whole screen output once it is finished
+	//
+	Frames = smg_headless_frames();
+	Cells = smg_headless_cells();
+	bench::Time("batched", Count, [&](long Count)
+	{
+		for (long loop = 0; loop < Count; loop++)
+		{
+			smg$begin_display_update(&Display);
+			DrawScreen(Display, loop);
+			smg$end_display_update(&Display);
+		}
+	}, 1);
+	Report("batched output", Count, Frames, Cells);
+
+	bench::Sink += smg_headless_frame().size();
+	smg$delete_virtual_display(&Display);
+	return 0;
+}
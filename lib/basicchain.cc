@@ -0,0 +1,214 @@
+/** \file basicchain.cc
+ * \brief CHAIN between translated programs
+ */
+
+//
+// Include files
+//
+#include <iostream>
+#include <cctype>
+#include <cstdlib>
+#include <map>
+#include <unistd.h>
+
+#include "basicfun.h"
+#include "basicchain.h"
+
+/**
+ * \brief Table of registered programs
+ *
+ *	Filled in by static ChainEntry objects before main() runs,
+ *	and only read after that, so it can be shared by all jobs.
+ */
+static std::map<std::string, basic::ChainProgram>& ChainTable()
+{
+	static std::map<std::string, basic::ChainProgram> Table;
+	return Table;
+}
+
+/**
+ * \brief Register a program
+ */
+basic::ChainEntry::ChainEntry(
+	const char* Name,	/**< Name to register under */
+	ChainProgram Program	/**< Its entry point */
+)
+{
+	ChainTable()[ChainName(Name)] = Program;
+}
+
+/**
+ * \brief Reduce a file specification to a program name
+ *
+ *	Strips off any device, directory, file type and version, and
+ *	upper cases the rest, so "SYS$LOGIN:[MENU]PAYROLL.EXE;3",
+ *	"payroll.bas" and "PAYROLL" all find the same program.
+ *
+ * \return Program name
+ */
+std::string basic::ChainName(
+	const std::string& Program	/**< File specification */
+)
+{
+	std::string::size_type Start = Program.find_last_of(":]>/");
+	Start = (Start == std::string::npos) ? 0 : Start + 1;
+
+	std::string::size_type End = Program.find_first_of(".; ", Start);
+	if (End == std::string::npos)
+	{
+		End = Program.size();
+	}
+
+	std::string Result = Program.substr(Start, End - Start);
+	for (std::string::size_type loop = 0; loop < Result.size(); loop++)
+	{
+		Result[loop] = toupper((unsigned char)Result[loop]);
+	}
+	return Result;
+}
+
+/**
+ * \brief Look up a registered program
+ *
+ * \return Entry point, or NULL if the program isn't registered
+ */
+basic::ChainProgram basic::ChainLookup(
+	const std::string& Program	/**< Program name */
+)
+{
+	std::map<std::string, ChainProgram>::iterator Find =
+		ChainTable().find(ChainName(Program));
+
+	if (Find == ChainTable().end())
+	{
+		return 0;
+	}
+	return Find->second;
+}
+
+/**
+ * \brief Start a program that isn't linked in
+ *
+ *	Replaces this process with the named program. Nothing is
+ *	carried over (COMMON is lost). Only returns if the exec
+ *	fails.
+ */
+static void ChainExec(
+	const std::string& Program	/**< Program name */
+)
+{
+	std::string Name = basic::ChainName(Program);
+
+	for (std::string::size_type loop = 0; loop < Name.size(); loop++)
+	{
+		Name[loop] = tolower((unsigned char)Name[loop]);
+	}
+
+	std::cout.flush();
+	std::cerr.flush();
+	for (int loop = 0; loop <= basic::MaxChannel; loop++)
+	{
+		if (basic::Context().Channel[loop].is_open())
+		{
+			basic::Context().Channel[loop].close();
+		}
+	}
+
+	execlp(Name.c_str(), Name.c_str(), (char*)0);
+}
+
+/**
+ * \brief Run a program, and whatever it CHAINs to
+ *
+ *	Called from the host's main() to start the first program.
+ *	Each CHAIN unwinds back to here and the next program is
+ *	called in its place.
+ *
+ * \return Exit status of the last program run
+ */
+int basic::ChainRun(
+	const std::string& Program,	/**< First program to run */
+	int argc,			/**< Arguments passed to each program */
+	char **argv			/**< Arguments passed to each program */
+)
+{
+	RuntimeContext& Job = Context();
+	std::string Next = Program;
+	int Result = EXIT_SUCCESS;
+
+	Job.ChainActive++;
+	while (true)
+	{
+		ChainProgram Entry = ChainLookup(Next);
+
+		if (Entry == 0)
+		{
+			Job.ChainActive--;
+			ChainExec(Next);
+			throw basic::BasicError(ErrCantFindFile);
+		}
+
+		try
+		{
+			Result = Entry(argc, argv);
+			break;
+		}
+		catch (ChainTransfer &Transfer)
+		{
+			//
+			// Like VAX BASIC, a CHAIN closes all files and
+			// starts the next program with its own DATA.
+			//
+			for (int loop = 0; loop <= MaxChannel; loop++)
+			{
+				if (Job.Channel[loop].is_open())
+				{
+					Job.Channel[loop].close();
+				}
+			}
+			Job.DataCursor.clear();
+			Job.MapStorage.clear();
+			Job.Error = BasicError();
+			Next = Transfer.Program;
+		}
+		catch (...)
+		{
+			Job.ChainActive--;
+			throw;
+		}
+	}
+	Job.ChainActive--;
+
+	return Result;
+}
+
+/**
+ * \brief CHAIN
+ *
+ * \bug A starting line number is accepted, but the program
+ *	is always started at the top.
+ */
+void basic::BasicChain(
+	const std::string& Program,	/**< Program to chain to */
+	long Line			/**< Starting line (ignored) */
+)
+{
+	if (ChainLookup(Program) == 0)
+	{
+		ChainExec(Program);
+		throw basic::BasicError(ErrCantFindFile);
+	}
+
+	//
+	// Unwind back to ChainRun if there is one, otherwise this
+	// program wasn't started from ChainRun, so start a chain
+	// here and leave when it finishes.
+	//
+	if (Context().ChainActive != 0)
+	{
+		throw ChainTransfer(Program, Line);
+	}
+
+	static char* NoArguments[] = { 0 };
+	exit(ChainRun(Program, 0, NoArguments));
+}
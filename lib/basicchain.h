@@ -0,0 +1,102 @@
+/**\file basicchain.h
+ * \brief CHAIN between translated programs
+ *
+ *	Programs translated with 'btran -k <name>' don't get a main().
+ *	Instead their main program is registered under <name>, so
+ *	that several of them can be linked into one binary. The
+ *	host's main() starts one with basic::ChainRun(), and a CHAIN
+ *	to another registered program is then just a function call,
+ *	with COMMON areas left in memory for the next program.
+ *
+ *	A CHAIN to a program that isn't registered falls back to
+ *	exec'ing a binary of that name.
+ */
+#ifndef _BASICCHAIN_H_
+#define _BASICCHAIN_H_
+
+//
+// include files
+//
+#include <string>
+#include <memory>
+
+#include "basiccontext.h"
+
+namespace basic
+{
+/**
+ * \brief Entry point of a registered program
+ */
+typedef int (*ChainProgram)(int argc, char **argv);
+
+/**
+ * \brief Registers a program for CHAIN
+ *
+ * btran emits a static one of these for each program translated
+ * with '-k', so the registration happens before main() runs.
+ */
+class ChainEntry
+{
+public:
+	ChainEntry(const char* Name, ChainProgram Program);
+};
+
+/**
+ * \brief Thrown by CHAIN to leave the current program
+ *
+ * Caught by ChainRun, which then calls the next program.
+ * Unwinding this way runs the destructors of the program
+ * being left.
+ */
+class ChainTransfer
+{
+public:
+	std::string Program;	/**< \brief Name of program to run next */
+	long Line;		/**< \brief Requested starting line */
+
+public:
+	/**
+	 * \brief Constructor
+	 */
+	ChainTransfer(const std::string& NewProgram, long NewLine)
+	{
+		Program = NewProgram;
+		Line = NewLine;
+	}
+};
+
+std::string ChainName(const std::string& Program);
+ChainProgram ChainLookup(const std::string& Program);
+int ChainRun(const std::string& Program, int argc, char **argv);
+void BasicChain(const std::string& Program, long Line = 0);
+
+/**
+ * \brief Find (or create) a COMMON area
+ *
+ * COMMON areas live in the jobs context, so they survive a
+ * CHAIN. The next program gets the same object back if it
+ * declares the COMMON with the same layout (the list of member
+ * types that btran passes in). A COMMON with a different layout
+ * starts out fresh.
+ *
+ * \return The COMMON area
+ */
+template <class T>
+T& ChainCommon(
+	const char* Name,	/**< Name of the COMMON */
+	const char* Layout	/**< Member types of the COMMON */
+)
+{
+	RuntimeContext::CommonArea &Area = Context().Common[Name];
+
+	if (!Area.Data || (Area.Layout != Layout))
+	{
+		Area.Data = std::shared_ptr<void>(new T(),
+			[](void* Old) { delete static_cast<T*>(Old); });
+		Area.Layout = Layout;
+	}
+	return *static_cast<T*>(Area.Data.get());
+}
+}
+
+#endif
@@ -22,28 +22,11 @@
 
 #include "bstring.h"
 #include "basicfun.h"
+#include "basiccontext.h"
 
-namespace basic
-{
-#ifdef RSTS_FILES
-const static int MaxChannel = 13;	/** \brief Maximum number of IO channels
-					 * 
-					 * Channel 12 is maximum
-					 */
-#else
-const static int MaxChannel = 100;	/** \brief Maximum number of IO Channels
-					 *
-					 * Channel 99 is maximum
-					 */
-#endif
-}
-
-/**
- * \brief Define the array of channels
- *
- * Creates an array of IO channels 
- * (number depends on if you are emulating a RSTS/E ot a VAX
- */
-extern std::fstream BasicChannel[basic::MaxChannel + 1];
+//
+// The channels themselves are part of the RuntimeContext
+// (basic::Context().Channel[]), so that each job has its own.
+//
 
 #endif
@@ -0,0 +1,133 @@
+/** \file basiccontext.cc
+ * \brief Per job runtime state
+ */
+
+//
+// Include files
+//
+#include <mutex>
+
+#include "basiccontext.h"
+
+/**
+ * \brief Context installed on this thread (NULL until first used)
+ */
+thread_local basic::RuntimeContext* basic::CurrentContext = 0;
+
+/**
+ * \brief Give this thread its own context
+ *
+ *	Used when nothing has been installed with SetContext, which
+ *	is the normal case for a stand alone program.
+ */
+basic::RuntimeContext& basic::DefaultContext()
+{
+	static thread_local RuntimeContext ThreadContext;
+
+	CurrentContext = &ThreadContext;
+	return ThreadContext;
+}
+
+/**
+ * \brief Install a context on this thread
+ *
+ *	A host running several jobs creates a RuntimeContext for
+ *	each one and installs it on the thread running that job.
+ *	Passing NULL goes back to the threads default context.
+ *
+ * \return The previously installed context (NULL if none)
+ */
+basic::RuntimeContext* basic::SetContext(
+	RuntimeContext* NewContext	/**< Context to use */
+)
+{
+	RuntimeContext* Previous = CurrentContext;
+
+	CurrentContext = NewContext;
+	return Previous;
+}
+
+/**
+ * \brief Largest size each MAP/COMMON is declared with, by name
+ *
+ *	Filled in before main() by every module's MapReserve
+ *	objects, so it is built on first use rather than relying
+ *	on the order modules are initialized in.
+ */
+static std::map<std::string, size_t>& MapReserved(
+	std::mutex*& Lock	/**< Returned lock guarding it */
+)
+{
+	static std::map<std::string, size_t> Reserved;
+	static std::mutex ReservedLock;
+
+	Lock = &ReservedLock;
+	return Reserved;
+}
+
+/**
+ * \brief Record the size a module uses for a MAP or COMMON
+ *
+ *	Like the VAX linker with overlaid PSECTs, the area is
+ *	made as large as the largest declaration in any module,
+ *	so one module's views are never left behind by another
+ *	module asking for more.
+ */
+void basic::ReserveMapArea(
+	const std::string& Name,	/**< Name of MAP/COMMON */
+	size_t Size			/**< Bytes the module uses */
+)
+{
+	std::mutex* Lock;
+	std::map<std::string, size_t>& Reserved = MapReserved(Lock);
+	std::lock_guard<std::mutex> Hold(*Lock);
+	size_t& Largest = Reserved[Name];
+
+	if (Largest < Size)
+	{
+		Largest = Size;
+	}
+}
+
+/**
+ * \brief Find a byte exact MAP or COMMON area
+ *
+ *	Creates the area (filled with zeros) the first time it is
+ *	asked for, at the largest size reserved for that name by
+ *	any module (see ReserveMapArea). An area is never moved
+ *	once made, since views of it are handed out, so asking for
+ *	more than that is an error.
+ *
+ * \return Start of the area
+ */
+char* basic::RuntimeContext::MapArea(
+	const std::string& Name,	/**< Name of MAP/COMMON */
+	size_t NewSize,			/**< Bytes needed */
+	int IsCommon,			/**< COMMON (kept over CHAIN) */
+	size_t &Size			/**< Returned size of the area */
+)
+{
+	std::vector<char> &Area =
+		IsCommon ? CommonStorage[Name] : MapStorage[Name];
+
+	if (Area.empty())
+	{
+		std::mutex* Lock;
+		std::map<std::string, size_t>& Reserved = MapReserved(Lock);
+		std::lock_guard<std::mutex> Hold(*Lock);
+		std::map<std::string, size_t>::const_iterator Find =
+			Reserved.find(Name);
+
+		if ((Find != Reserved.end()) && (Find->second > NewSize))
+		{
+			NewSize = Find->second;
+		}
+		Area.assign(NewSize, 0);
+	}
+	else if (Area.size() < NewSize)
+	{
+		throw BasicError(ErrIllegalUsage);
+	}
+	Size = Area.size();
+	return Area.data();
+}
@@ -0,0 +1,144 @@
+/**\file basiccontext.h
+ * \brief Per job runtime state
+ *
+ *	Everything a translated program changes while it runs
+ *	(I/O channels, error state, DATA pointers, PRINT USING
+ *	state, random numbers) lives in a RuntimeContext instead
+ *	of in global variables, so that several programs can run
+ *	as threads in one process without stepping on each other.
+ *
+ *	The generated code reaches the current context through
+ *	basic::Context(), which is thread local. Each thread gets
+ *	a default context the first time it asks for one, or a
+ *	host can create one per job and install it with
+ *	basic::SetContext().
+ */
+#ifndef _BASICCONTEXT_H_
+#define _BASICCONTEXT_H_
+
+//
+// include files
+//
+#include <fstream>
+#include <string>
+#include <map>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+#include "pusing.h"
+#include "basicerror.h"
+#include "basicrandom.h"
+
+namespace basic
+{
+#ifdef RSTS_FILES
+const static int MaxChannel = 13;	/** \brief Maximum number of IO channels
+					 *
+					 * Channel 12 is maximum
+					 */
+#else
+const static int MaxChannel = 100;	/** \brief Maximum number of IO Channels
+					 *
+					 * Channel 99 is maximum
+					 */
+#endif
+
+/**
+ * \brief State of one running BASIC job
+ */
+class RuntimeContext
+{
+public:
+	/**
+	 * \brief One COMMON area (see ChainCommon)
+	 */
+	struct CommonArea
+	{
+		std::shared_ptr<void> Data;	/**< \brief The COMMON itself */
+		std::string Layout;		/**< \brief Its member types */
+	};
+
+public:
+	std::fstream Channel[MaxChannel + 1];	/**< \brief IO channels */
+	BasicError Error;		/**< \brief Last error (ERR, ERL, ERN$) */
+	long Status;			/**< \brief Status flag */
+	PUsing PUse;			/**< \brief Print using state */
+	std::vector<int> DataCursor;	/**< \brief Next DATA item, by DataListClass slot */
+	RandomGenerator Random;		/**< \brief Random number generator */
+	std::map<std::string, CommonArea> Common;
+					/**< \brief COMMON areas, by name */
+	std::map<std::string, std::vector<char> > MapStorage;
+					/**< \brief Byte exact MAP areas, by name */
+	std::map<std::string, std::vector<char> > CommonStorage;
+					/**< \brief Byte exact COMMON areas, by name */
+	int ChainActive;		/**< \brief Running under ChainRun */
+
+public:
+	/**
+	 * \brief Constructor
+	 */
+	RuntimeContext()
+	{
+		Status = 0;
+		ChainActive = 0;
+	}
+
+	/**
+	 * \brief RANDOMIZE
+	 *
+	 *	Seeds from the clock, mixed with where this context is,
+	 *	so jobs started together still get different numbers.
+	 */
+	void Randomize()
+	{
+		Random.seed((uint64_t)std::chrono::high_resolution_clock::now().
+			time_since_epoch().count() ^ (uint64_t)(uintptr_t)this);
+	}
+
+	char* MapArea(const std::string& Name, size_t NewSize, int IsCommon,
+		size_t &Size);
+
+private:
+	//
+	// Channels can't be copied, and sharing the
+	// rest would defeat the purpose.
+	//
+	RuntimeContext(const RuntimeContext&);
+	RuntimeContext& operator=(const RuntimeContext&);
+};
+
+extern thread_local RuntimeContext* CurrentContext;
+RuntimeContext& DefaultContext();
+RuntimeContext* SetContext(RuntimeContext* NewContext);
+void ReserveMapArea(const std::string& Name, size_t Size);
+
+/**
+ * \brief Context for the job running on this thread
+ */
+inline RuntimeContext& Context()
+{
+	if (CurrentContext == 0)
+	{
+		return DefaultContext();
+	}
+	return *CurrentContext;
+}
+
+/**
+ * \brief Raise an error for an ON ERROR handler
+ *
+ *	Records the error where ERR and ERL will find it, without
+ *	throwing. The caller then jumps to the handler itself.
+ */
+inline void SetError(
+	int Code,		/**< Error number */
+	int Line		/**< Line the error happened on */
+)
+{
+	Context().Error.Set(Code, Line);
+}
+}
+
+#endif
@@ -0,0 +1,107 @@
+/**\file basicerror.h
+ * \brief BASIC error numbers and messages
+ *
+ *	The error numbers are the RSTS/E ones that VAX BASIC kept.
+ *	Only the ones the library and the generated code raise
+ *	themselves have names; any other number can still be used
+ *	in an ERROR statement.
+ */
+#ifndef _BASICERROR_H_
+#define _BASICERROR_H_
+
+//
+// include files
+//
+#include <string>
+
+#include "bstring.h"
+
+namespace basic
+{
+/**
+ * \brief Error numbers raised by the runtime
+ */
+enum ErrorCode
+{
+	ErrNone = 0,			/**< \brief No error */
+	ErrCantFindFile = 5,		/**< \brief Can't find file or account */
+	ErrEndOfFile = 11,		/**< \brief End of file on device */
+	ErrIoFailure = 12,		/**< \brief Fatal system I/O failure */
+	ErrWaitExhausted = 15,		/**< \brief Wait exhausted */
+	ErrFloatOverflow = 48,		/**< \brief Floating point error or overflow */
+	ErrDataFormat = 50,		/**< \brief Data format error */
+	ErrIntegerOverflow = 51,	/**< \brief Integer error or overflow */
+	ErrIllegalNumber = 52,		/**< \brief Illegal number */
+	ErrOnOutOfRange = 58,		/**< \brief ON statement out of range */
+	ErrDivideByZero = 61,		/**< \brief Division by 0 */
+	ErrIllegalUsage = 135,		/**< \brief Illegal usage */
+	ErrDecimalOverflow = 181,	/**< \brief Decimal error or overflow */
+	ErrMaximum = 300		/**< \brief Highest error number */
+};
+
+string_view ErrorText(long Number);
+
+/**
+ * \brief Error trapping stuff
+ */
+class BasicError
+{
+public:
+	int err;		/**< \brief Basc error number */
+	int erl;		/**< Line number for error */
+	std::string ern;	/**< Function name of error */
+
+public:
+	/**
+	 * \brief Empty constructor
+	 */
+	BasicError()
+	{
+		err = 0;
+		erl = 0;
+	}
+	/**
+	 * \brief Constructor
+	 */
+	BasicError(int newerr, int newerl = 0, std::string newern = "")
+	{
+		err = newerr;
+		erl = newerl;
+		ern = newern;
+	}
+	/**
+	 * Copy constructor
+	 */
+	BasicError(const BasicError &be)
+	{
+		err = be.err;
+		erl = be.erl;
+		ern = be.ern;
+	}
+	/**
+	 * Assignment
+	 */
+	BasicError& operator=(const BasicError &be)
+	{
+		err = be.err;
+		erl = be.erl;
+		ern = be.ern;
+		return *this;
+	}
+	/**
+	 * \brief Record an error in place
+	 *
+	 *	Used when an ON ERROR handler is active, so the error
+	 *	doesn't have to be built and copied, or thrown.
+	 */
+	void Set(int newerr, int newerl)
+	{
+		err = newerr;
+		erl = newerl;
+		ern.clear();
+	}
+
+};
+}
+
+#endif
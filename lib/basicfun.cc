@@ -6,9 +6,6 @@
 #include "basicfun.h"
 #include <time.h>
 
-long Status;		/**< \brief Status flag */
-basic::BasicError Be;	/**< Global error values */
-
 /**
  * \brief SYS function
  *
@@ -16,6 +16,10 @@
 
 #include "bstring.h"
 #include "pusing.h"
+#include "basiccontext.h"
+#include "basicchain.h"
+#include "basicmap.h"
+#include "decimal.h"
 
 #ifndef PI
 static const double PI = 3.1415926535; /**< \brief Pi (Someone else already defined this) */
@@ -51,11 +55,6 @@ static const char ESC = 27;	/**< \brief Escape */
 static const char SP = 32;	/**< \brief Space */
 static const char DEL = 127;	/**< \brief Delete */
 
-//
-// Error routines
-//
-extern long Status;		/* Status flag */
-
 //
 // Array of vector code stolen from
 // https://mklimenko.github.io/english/2019/08/17/multidimensional-vector-allocation/
@@ -94,47 +93,6 @@ template <typename T>
 	}
 };
 
-/**
- * \brief Error trapping stuff
- */
-class BasicError
-{
-public:
-	int err;		/**< \brief Basc error number */
-	int erl;		/**< Line number for error */
-	std::string ern;	/**< Function name of error */
-
-public:
-	/**
-	 * \brief Empty constructor
-	 */
-	BasicError()
-	{
-		err = 0;
-		erl = 0;
-	}
-	/**
-	 * \brief Constructor
-	 */
-	BasicError(int newerr, int newerl = 0, std::string newern = "")
-	{
-		err = newerr;
-		erl = newerl;
-		ern = newern;
-	}
-	/**
-	 * Copy constructor
-	 */
-	BasicError(const BasicError &be)
-	{
-		err = be.err;
-		erl = be.erl;
-		ern = be.ern;
-	}
-
-};
-extern basic::BasicError Be;
-
 #define __C(a, b) a ## b
 #define __U(p, q) __C(p, q)
 /** 
@@ -172,7 +130,8 @@ extern basic::BasicError Be;
  */
 static inline void OnErrorDie()
 {
-	std::cerr << "%Error " << Be.err << " at " << Be.erl << std::endl;
+	std::cerr << "%Error " << Context().Error.err << " at " <<
+		Context().Error.erl << std::endl;
 	exit(EXIT_FAILURE);
 }
 /**
@@ -195,29 +154,41 @@ static inline void OnErrorDie()
  * \brief Generate error
  */
 #define OnErrorHit(x,y) if (ErrorStack) \
-	{ Be.err = x; Be.erl = y; goto *ErrorStack; } else \
+	{ basic::SetError(x, y); goto *ErrorStack; } else \
 	throw basic::BasicError(x, y); ;
 /**
  * \brief return error line
  */
 static inline int erl()
 {
-	return Be.erl;
+	return Context().Error.erl;
 }
 /**
  * \brief return error number
  */
 static inline int err()
 {
-	return Be.err;
+	return Context().Error.err;
+}
+/**
+ * \brief return name of function that had the error
+ */
+static inline std::string ern()
+{
+	return Context().Error.ern;
+}
+/**
+ * \brief STATUS
+ */
+static inline long status()
+{
+	return Context().Status;
 }
 
 /**
  * \brief Rnd (random number between 0 and 1)
  *
- *	This is a real nasty hack, and may not produce as
- *	wide a range of random numbers as basic desires.
- *	This version has a small chance of returning 1.
+ *	Returns a number in [0, 1) from the job's own generator.
  *	
  * \bug fmax parameter is ignored because of strange
  *	usage in many basic programs which assume the value doesn't
@@ -227,7 +198,33 @@ inline double floatrand(
 	double fmax = 1.0	/**< Maximum value to return  (ignored)*/
 )
 {
-	return ((double) rand()) / ((double) RAND_MAX); // * fmax;
+	return Context().Random.Double();
+}
+
+/**
+ * \brief Fill an array with RND values
+ *
+ *	Gives the same numbers as calling RND Count times, for
+ *	filling a whole matrix at once.
+ */
+inline void floatrand(
+	double* Dest,		/**< Where to put them */
+	size_t Count		/**< How many */
+)
+{
+	Context().Random.Fill(Dest, Count);
+}
+
+/**
+ * \brief Restart RND with a given seed
+ *
+ *	For tests, and for programs that need to repeat a run.
+ */
+inline void RandomSeed(
+	uint64_t Seed		/**< Seed to start from */
+)
+{
+	Context().Random.seed(Seed);
 }
 
 //
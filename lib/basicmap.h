@@ -0,0 +1,392 @@
+/**\file basicmap.h
+ * \brief Byte exact MAP and COMMON areas
+ *
+ *	A MAP or COMMON is a named block of bytes. Each MAP statement
+ *	naming the block describes one way of looking at those bytes,
+ *	so several MAPs with the same name overlay each other, and a
+ *	record read into the block is seen through all of them.
+ *
+ *	btran emits a MapBuffer for each MAP/COMMON statement, which
+ *	finds the named block in the jobs context, and a view for
+ *	each member at its offset in the block:
+ *
+ *	\code
+ *	basic::MapBuffer rec_M1("REC", 24, 0);
+ *	basic::MapString nam(rec_M1.Data + 0, 10);
+ *	basic::MapValue<int16_t> code(rec_M1.Data + 10);
+ *	\endcode
+ *
+ *	Members are packed with no alignment, as on the VAX, and are
+ *	read and written with memcpy, so they can be at any offset.
+ *	Floating point members are kept in the VAX formats (see
+ *	vaxnumber.h), so records match those written on the VAX.
+ */
+#ifndef _BASICMAP_H_
+#define _BASICMAP_H_
+
+//
+// include files
+//
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "bstring.h"
+#include "basiccontext.h"
+#include "vaxnumber.h"
+
+namespace basic
+{
+/**
+ * \brief Handle on a named MAP or COMMON block
+ */
+class MapBuffer
+{
+public:
+	char* Data;		/**< \brief Start of the block */
+	size_t Size;		/**< \brief Size of the block */
+
+public:
+	/**
+	 * \brief Find the named block, making it at least Size bytes
+	 */
+	MapBuffer(
+		const char* Name,	/**< Name of MAP/COMMON */
+		size_t NewSize = 0,	/**< Bytes needed (0 = as is) */
+		int Common = 0		/**< Is this a COMMON */
+	)
+	{
+		Data = Context().MapArea(Name, NewSize, Common, Size);
+	}
+};
+
+/**
+ * \brief Reserve a MAP or COMMON at the size a module uses
+ *
+ * btran emits one of these at file scope for each byte exact
+ * MAP/COMMON, so every module's size is known before any of
+ * them runs (see ReserveMapArea).
+ */
+class MapReserve
+{
+public:
+	//! Constructor
+	MapReserve(
+		const char* Name,	/**< Name of MAP/COMMON */
+		size_t Size		/**< Bytes this module uses */
+	)
+	{
+		ReserveMapArea(Name, Size);
+	}
+};
+
+/**
+ * \brief Numeric member of a MAP
+ *
+ * Behaves like a variable of type T stored at a fixed
+ * place in the block, in the format given by Storage.
+ */
+template <class T, class Storage = NativeStorage<T> >
+class MapValue
+{
+private:
+	char* Data;		/**< \brief Where the value is */
+
+public:
+	//! Constructor
+	explicit MapValue(char* Where) { Data = Where; }
+	//! Copy the view (not the value)
+	MapValue(const MapValue& Other) { Data = Other.Data; }
+
+	//! Fetch value
+	operator T() const
+	{
+		return Storage::Get(Data);
+	}
+	//! Store value
+	MapValue& operator=(T Value)
+	{
+		Storage::Put(Data, Value);
+		return *this;
+	}
+	//! Store value from another member
+	MapValue& operator=(const MapValue& Other)
+	{
+		return *this = (T)Other;
+	}
+
+	//! +=
+	MapValue& operator+=(T Value) { return *this = (T)*this + Value; }
+	//! -=
+	MapValue& operator-=(T Value) { return *this = (T)*this - Value; }
+	//! *=
+	MapValue& operator*=(T Value) { return *this = (T)*this * Value; }
+	//! /=
+	MapValue& operator/=(T Value) { return *this = (T)*this / Value; }
+	//! Prefix ++
+	MapValue& operator++() { return *this = (T)*this + 1; }
+	//! Prefix --
+	MapValue& operator--() { return *this = (T)*this - 1; }
+	//! Postfix ++
+	T operator++(int) { T Old = *this; *this = Old + 1; return Old; }
+	//! Postfix --
+	T operator--(int) { T Old = *this; *this = Old - 1; return Old; }
+
+	//! INPUT into a member
+	friend std::istream& operator>>(std::istream& is, MapValue Member)
+	{
+		T Value;
+		is >> Value;
+		Member = Value;
+		return is;
+	}
+};
+
+/**
+ * \brief Array of numbers in a MAP
+ */
+template <class T, class Storage = NativeStorage<T> >
+class MapArray
+{
+private:
+	char* Data;		/**< \brief Where element 0 is */
+
+public:
+	//! Constructor
+	explicit MapArray(char* Where) { Data = Where; }
+
+	//! Element of the array
+	MapValue<T, Storage> operator[](size_t Index) const
+		{ return MapValue<T, Storage>(Data + Index * Storage::Size); }
+};
+
+/**
+ * \brief Fixed length string member of a MAP
+ *
+ * Assigning to it works like LSET: the value is truncated
+ * or padded with spaces to the length of the member.
+ */
+class MapString
+{
+private:
+	char* Data;		/**< \brief Where the string is */
+	size_t Length;		/**< \brief Its length */
+
+public:
+	//! Constructor
+	MapString(char* Where, size_t NewLength)
+		{ Data = Where; Length = NewLength; }
+	//! Copy the view (not the value)
+	MapString(const MapString& Other)
+		{ Data = Other.Data; Length = Other.Length; }
+
+	//! Fetch value
+	operator std::string() const { return std::string(Data, Length); }
+	//! Look at value without copying it
+	operator string_view() const { return string_view(Data, Length); }
+	//! Fetch value
+	std::string str() const { return std::string(Data, Length); }
+
+	//! Store value (LSET)
+	MapString& operator=(string_view Value)
+	{
+		size_t Copy = (Value.size() < Length) ? Value.size() : Length;
+		memmove(Data, Value.data(), Copy);
+		memset(Data + Copy, ' ', Length - Copy);
+		return *this;
+	}
+	//! Store value (LSET)
+	MapString& operator=(const std::string& Value)
+		{ return *this = string_view(Value); }
+	//! Store value (LSET)
+	MapString& operator=(const char* Value)
+		{ return *this = string_view(Value); }
+	//! Store value from another member
+	MapString& operator=(const MapString& Value)
+		{ return *this = string_view(Value); }
+	//! Store value (RSET)
+	void Rset(string_view Value)
+	{
+		size_t Copy = (Value.size() < Length) ? Value.size() : Length;
+		memmove(Data + Length - Copy, Value.data() + Value.size() - Copy, Copy);
+		memset(Data, ' ', Length - Copy);
+	}
+	//! A$ = A$ + B$
+	MapString& operator+=(string_view Value)
+		{ return *this = str() + Value.to_string(); }
+
+	//
+	// Enough of std::string for the code btran generates
+	//
+	//! LEN()
+	size_t size() const { return Length; }
+	//! LEN()
+	size_t length() const { return Length; }
+	//! Character in string
+	char& operator[](size_t Index) const { return Data[Index]; }
+	//! Part of string
+	std::string substr(size_t Start, size_t Count = std::string::npos) const
+		{ return string_view(*this).substr(Start, Count).to_string(); }
+	//! INSTR()
+	size_t find(string_view Search, size_t Start = 0) const
+		{ return string_view(*this).find(Search, Start); }
+	//! Search for any of a set of characters
+	size_t find_first_of(string_view Search, size_t Start = 0) const
+		{ return string_view(*this).find_first_of(Search, Start); }
+
+	//! PRINT
+	friend std::ostream& operator<<(std::ostream& os, const MapString& Value)
+		{ return os.write(Value.Data, Value.Length); }
+	//! INPUT
+	friend std::istream& operator>>(std::istream& is, MapString Value)
+		{ std::string Work; is >> Work; Value = Work; return is; }
+};
+
+//! Concatenate
+inline std::string operator+(const MapString& Left, string_view Right)
+	{ return Concat(string_view(Left), Right); }
+//! Concatenate
+inline std::string operator+(string_view Left, const MapString& Right)
+	{ return Concat(Left, string_view(Right)); }
+//! Concatenate
+inline std::string operator+(const MapString& Left, const MapString& Right)
+	{ return Concat(string_view(Left), string_view(Right)); }
+
+//! Compare
+inline bool operator==(const MapString& Left, string_view Right)
+	{ return string_view(Left) == Right; }
+//! Compare
+inline bool operator==(string_view Left, const MapString& Right)
+	{ return Left == string_view(Right); }
+//! Compare
+inline bool operator!=(const MapString& Left, string_view Right)
+	{ return string_view(Left) != Right; }
+//! Compare
+inline bool operator!=(string_view Left, const MapString& Right)
+	{ return Left != string_view(Right); }
+//! Compare
+inline bool operator<(const MapString& Left, string_view Right)
+	{ return string_view(Left) < Right; }
+//! Compare
+inline bool operator<(string_view Left, const MapString& Right)
+	{ return Left < string_view(Right); }
+//! Compare
+inline bool operator>(const MapString& Left, string_view Right)
+	{ return string_view(Left) > Right; }
+//! Compare
+inline bool operator>(string_view Left, const MapString& Right)
+	{ return Left > string_view(Right); }
+
+//! Length of a piece of a concatenation
+inline std::string::size_type ConcatSize(const MapString& Source)
+	{ return Source.size(); }
+//! Append a piece of a concatenation
+inline void ConcatPiece(std::string& Dest, const MapString& Source)
+	{ ConcatPiece(Dest, string_view(Source)); }
+
+/**
+ * \brief A$ = A$ + B$ + ... for a MAP member
+ */
+template <typename... Parts>
+inline MapString& Append(
+	MapString& Dest,		/**< Member to append to */
+	const Parts&... Part		/**< Pieces to append */
+)
+{
+	return Dest = Concat(string_view(Dest), Part...);
+}
+
+/**
+ * \brief Array of fixed length strings in a MAP
+ */
+class MapStringArray
+{
+private:
+	char* Data;		/**< \brief Where element 0 is */
+	size_t Length;		/**< \brief Length of each element */
+
+public:
+	//! Constructor
+	MapStringArray(char* Where, size_t NewLength)
+		{ Data = Where; Length = NewLength; }
+
+	//! Element of the array
+	MapString operator[](size_t Index) const
+		{ return MapString(Data + Index * Length, Length); }
+};
+
+/**
+ * \brief Copy of a MAP member passed BY REF
+ *
+ * A member is a view of bytes in the block, not a variable, so
+ * nothing can point at it. This holds a copy for the call to
+ * work on, and stores it back into the member when the call
+ * (the full expression) is done.
+ */
+template <class T, class Member>
+class MapRef
+{
+private:
+	Member View;		/**< \brief Member to store back into */
+	T Value;		/**< \brief Copy the call works on */
+
+public:
+	//! Constructor
+	explicit MapRef(const Member& NewView) : View(NewView), Value(NewView) {}
+	//! Copy (only made while returning one from ByRef)
+	MapRef(const MapRef& Other) : View(Other.View), Value(Other.Value) {}
+	//! Destructor, copies the value back
+	~MapRef() { View = Value; }
+
+	//! Pass as a pointer
+	operator T*() { return &Value; }
+	//! Pass as a reference
+	operator T&() { return Value; }
+};
+
+/**
+ * \brief BY REF of an ordinary variable
+ */
+template <class T>
+inline T* ByRef(T& Value) { return &Value; }
+/**
+ * \brief BY REF of a numeric MAP member
+ */
+template <class T, class Storage>
+inline MapRef<T, MapValue<T, Storage> > ByRef(MapValue<T, Storage> Value)
+	{ return MapRef<T, MapValue<T, Storage> >(Value); }
+/**
+ * \brief BY REF of a string MAP member
+ */
+inline MapRef<std::string, MapString> ByRef(MapString Value)
+	{ return MapRef<std::string, MapString>(Value); }
+
+/**
+ * \brief Where the data for a MAP is (for OPEN ... MAP)
+ */
+inline char* MapData(const MapBuffer& Map) { return Map.Data; }
+/**
+ * \brief Where the data for a MAP is (for OPEN ... MAP)
+ */
+template <class T>
+inline char* MapData(T& Map) { return (char*)&Map; }
+/**
+ * \brief Size of a MAP (for OPEN ... MAP)
+ */
+inline size_t MapSize(const MapBuffer& Map) { return Map.Size; }
+/**
+ * \brief Size of a MAP (for OPEN ... MAP)
+ */
+template <class T>
+inline size_t MapSize(T& Map) { return sizeof(Map); }
+}
+
+//! LSET into a MAP member
+static inline void Lset(basic::MapString dest, basic::string_view source)
+	{ dest = source; }
+//! RSET into a MAP member
+static inline void Rset(basic::MapString dest, basic::string_view source)
+	{ dest.Rset(source); }
+
+#endif
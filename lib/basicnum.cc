@@ -0,0 +1,890 @@
+/** \file basicnum.cc
+ * \brief Conversions between numbers and text
+ *
+ *	NUM$, NUM1$ and STR$ start from a digit string that reads back
+ *	as the same number (Grisu2, after Florian Loitsch, "Printing
+ *	Floating-Point Numbers Quickly and Accurately with Integers",
+ *	which is the shortest such string for all but a fraction of a
+ *	percent of numbers), cut down to the digits BASIC shows for
+ *	the type.
+ *	VAL and VAL% parse the text themselves, only handing the
+ *	rare number that can't be converted exactly to strtod.
+ */
+
+//
+// Include files
+//
+#include <cstdint>
+#include <cstdlib>
+#include <climits>
+#include <cmath>
+#include <string>
+
+#include "bstring.h"
+#include "basiccontext.h"
+
+//******************************************************************
+// Shortest digits (Grisu2)
+//******************************************************************
+
+/**
+ * \brief Floating point number as a 64 bit mantissa and binary exponent
+ */
+struct DiyFp
+{
+	uint64_t F;	/**< \brief Mantissa */
+	int E;		/**< \brief Binary exponent */
+
+	DiyFp(uint64_t NewF = 0, int NewE = 0) { F = NewF; E = NewE; }
+
+	//! Split a (positive, finite) double
+	explicit DiyFp(double Number)
+	{
+		uint64_t Bits;
+		memcpy(&Bits, &Number, sizeof(Bits));
+
+		int Biased = (int)((Bits >> 52) & 0x7ff);
+		F = Bits & 0xfffffffffffffULL;
+		if (Biased != 0)
+		{
+			F += 0x10000000000000ULL;
+			E = Biased - 1075;
+		}
+		else
+		{
+			E = -1074;
+		}
+	}
+
+	//! Difference (same exponent)
+	DiyFp operator-(const DiyFp& Right) const
+		{ return DiyFp(F - Right.F, E); }
+
+	//! Product, rounded to 64 bits
+	DiyFp operator*(const DiyFp& Right) const
+	{
+		unsigned __int128 Product = (unsigned __int128)F * Right.F;
+		uint64_t High = (uint64_t)(Product >> 64);
+
+		if ((uint64_t)Product & 0x8000000000000000ULL)
+		{
+			High++;
+		}
+		return DiyFp(High, E + Right.E + 64);
+	}
+
+	//! Shift so the top bit is set
+	DiyFp Normalize() const
+	{
+		int Shift = __builtin_clzll(F);
+		return DiyFp(F << Shift, E - Shift);
+	}
+
+	/**
+	 * \brief Upper and lower bounds of the numbers that round
+	 *	to this one, with a common exponent
+	 */
+	void Boundaries(DiyFp& Minus, DiyFp& Plus) const
+	{
+		Plus = DiyFp((F << 1) + 1, E - 1).Normalize();
+		if (F == 0x10000000000000ULL)
+		{
+			Minus = DiyFp((F << 2) - 1, E - 2);
+		}
+		else
+		{
+			Minus = DiyFp((F << 1) - 1, E - 1);
+		}
+		Minus.F <<= Minus.E - Plus.E;
+		Minus.E = Plus.E;
+	}
+};
+
+/**
+ * \brief 10^-348, 10^-340, ... 10^340 as normalized DiyFp's
+ */
+static const struct
+{
+	uint64_t F;	/**< \brief Mantissa */
+	int E;		/**< \brief Binary exponent */
+} CachedPower[] =
+{
+	{ 0xfa8fd5a0081c0288ULL, -1220 },	// 1e-348
+	{ 0xbaaee17fa23ebf76ULL, -1193 },	// 1e-340
+	{ 0x8b16fb203055ac76ULL, -1166 },	// 1e-332
+	{ 0xcf42894a5dce35eaULL, -1140 },	// 1e-324
+	{ 0x9a6bb0aa55653b2dULL, -1113 },	// 1e-316
+	{ 0xe61acf033d1a45dfULL, -1087 },	// 1e-308
+	{ 0xab70fe17c79ac6caULL, -1060 },	// 1e-300
+	{ 0xff77b1fcbebcdc4fULL, -1034 },	// 1e-292
+	{ 0xbe5691ef416bd60cULL, -1007 },	// 1e-284
+	{ 0x8dd01fad907ffc3cULL,  -980 },	// 1e-276
+	{ 0xd3515c2831559a83ULL,  -954 },	// 1e-268
+	{ 0x9d71ac8fada6c9b5ULL,  -927 },	// 1e-260
+	{ 0xea9c227723ee8bcbULL,  -901 },	// 1e-252
+	{ 0xaecc49914078536dULL,  -874 },	// 1e-244
+	{ 0x823c12795db6ce57ULL,  -847 },	// 1e-236
+	{ 0xc21094364dfb5637ULL,  -821 },	// 1e-228
+	{ 0x9096ea6f3848984fULL,  -794 },	// 1e-220
+	{ 0xd77485cb25823ac7ULL,  -768 },	// 1e-212
+	{ 0xa086cfcd97bf97f4ULL,  -741 },	// 1e-204
+	{ 0xef340a98172aace5ULL,  -715 },	// 1e-196
+	{ 0xb23867fb2a35b28eULL,  -688 },	// 1e-188
+	{ 0x84c8d4dfd2c63f3bULL,  -661 },	// 1e-180
+	{ 0xc5dd44271ad3cdbaULL,  -635 },	// 1e-172
+	{ 0x936b9fcebb25c996ULL,  -608 },	// 1e-164
+	{ 0xdbac6c247d62a584ULL,  -582 },	// 1e-156
+	{ 0xa3ab66580d5fdaf6ULL,  -555 },	// 1e-148
+	{ 0xf3e2f893dec3f126ULL,  -529 },	// 1e-140
+	{ 0xb5b5ada8aaff80b8ULL,  -502 },	// 1e-132
+	{ 0x87625f056c7c4a8bULL,  -475 },	// 1e-124
+	{ 0xc9bcff6034c13053ULL,  -449 },	// 1e-116
+	{ 0x964e858c91ba2655ULL,  -422 },	// 1e-108
+	{ 0xdff9772470297ebdULL,  -396 },	// 1e-100
+	{ 0xa6dfbd9fb8e5b88fULL,  -369 },	// 1e-92
+	{ 0xf8a95fcf88747d94ULL,  -343 },	// 1e-84
+	{ 0xb94470938fa89bcfULL,  -316 },	// 1e-76
+	{ 0x8a08f0f8bf0f156bULL,  -289 },	// 1e-68
+	{ 0xcdb02555653131b6ULL,  -263 },	// 1e-60
+	{ 0x993fe2c6d07b7facULL,  -236 },	// 1e-52
+	{ 0xe45c10c42a2b3b06ULL,  -210 },	// 1e-44
+	{ 0xaa242499697392d3ULL,  -183 },	// 1e-36
+	{ 0xfd87b5f28300ca0eULL,  -157 },	// 1e-28
+	{ 0xbce5086492111aebULL,  -130 },	// 1e-20
+	{ 0x8cbccc096f5088ccULL,  -103 },	// 1e-12
+	{ 0xd1b71758e219652cULL,   -77 },	// 1e-4
+	{ 0x9c40000000000000ULL,   -50 },	// 1e4
+	{ 0xe8d4a51000000000ULL,   -24 },	// 1e12
+	{ 0xad78ebc5ac620000ULL,     3 },	// 1e20
+	{ 0x813f3978f8940984ULL,    30 },	// 1e28
+	{ 0xc097ce7bc90715b3ULL,    56 },	// 1e36
+	{ 0x8f7e32ce7bea5c70ULL,    83 },	// 1e44
+	{ 0xd5d238a4abe98068ULL,   109 },	// 1e52
+	{ 0x9f4f2726179a2245ULL,   136 },	// 1e60
+	{ 0xed63a231d4c4fb27ULL,   162 },	// 1e68
+	{ 0xb0de65388cc8ada8ULL,   189 },	// 1e76
+	{ 0x83c7088e1aab65dbULL,   216 },	// 1e84
+	{ 0xc45d1df942711d9aULL,   242 },	// 1e92
+	{ 0x924d692ca61be758ULL,   269 },	// 1e100
+	{ 0xda01ee641a708deaULL,   295 },	// 1e108
+	{ 0xa26da3999aef774aULL,   322 },	// 1e116
+	{ 0xf209787bb47d6b85ULL,   348 },	// 1e124
+	{ 0xb454e4a179dd1877ULL,   375 },	// 1e132
+	{ 0x865b86925b9bc5c2ULL,   402 },	// 1e140
+	{ 0xc83553c5c8965d3dULL,   428 },	// 1e148
+	{ 0x952ab45cfa97a0b3ULL,   455 },	// 1e156
+	{ 0xde469fbd99a05fe3ULL,   481 },	// 1e164
+	{ 0xa59bc234db398c25ULL,   508 },	// 1e172
+	{ 0xf6c69a72a3989f5cULL,   534 },	// 1e180
+	{ 0xb7dcbf5354e9beceULL,   561 },	// 1e188
+	{ 0x88fcf317f22241e2ULL,   588 },	// 1e196
+	{ 0xcc20ce9bd35c78a5ULL,   614 },	// 1e204
+	{ 0x98165af37b2153dfULL,   641 },	// 1e212
+	{ 0xe2a0b5dc971f303aULL,   667 },	// 1e220
+	{ 0xa8d9d1535ce3b396ULL,   694 },	// 1e228
+	{ 0xfb9b7cd9a4a7443cULL,   720 },	// 1e236
+	{ 0xbb764c4ca7a44410ULL,   747 },	// 1e244
+	{ 0x8bab8eefb6409c1aULL,   774 },	// 1e252
+	{ 0xd01fef10a657842cULL,   800 },	// 1e260
+	{ 0x9b10a4e5e9913129ULL,   827 },	// 1e268
+	{ 0xe7109bfba19c0c9dULL,   853 },	// 1e276
+	{ 0xac2820d9623bf429ULL,   880 },	// 1e284
+	{ 0x80444b5e7aa7cf85ULL,   907 },	// 1e292
+	{ 0xbf21e44003acdd2dULL,   933 },	// 1e300
+	{ 0x8e679c2f5e44ff8fULL,   960 },	// 1e308
+	{ 0xd433179d9c8cb841ULL,   986 },	// 1e316
+	{ 0x9e19db92b4e31ba9ULL,  1013 },	// 1e324
+	{ 0xeb96bf6ebadf77d9ULL,  1039 },	// 1e332
+	{ 0xaf87023b9bf0ee6bULL,  1066 },	// 1e340
+};
+
+/**
+ * \brief Powers of 10 that fit in 64 bits
+ */
+static const uint64_t Power10[] =
+{
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+	10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+	100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+	100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+	100000000000000000ULL, 1000000000000000000ULL,
+	10000000000000000000ULL
+};
+
+/**
+ * \brief Find a cached power that scales a number with binary
+ *	exponent E into the range Grisu works in
+ */
+static DiyFp GetCachedPower(
+	int E,		/**< Binary exponent to scale */
+	int& K		/**< Returned decimal exponent of the scaled number */
+)
+{
+	double Estimate = (-61 - E) * 0.30102999566398114 + 347;
+	int Index = (int)Estimate;
+
+	if (Estimate - Index > 0.0)
+	{
+		Index++;
+	}
+	Index = (Index >> 3) + 1;
+	K = -(-348 + Index * 8);
+	return DiyFp(CachedPower[Index].F, CachedPower[Index].E);
+}
+
+/**
+ * \brief Nudge the last digit towards the exact value
+ */
+static void GrisuRound(
+	char* Buffer,		/**< Digits so far */
+	int Length,		/**< Number of digits */
+	uint64_t Delta,		/**< Width of the rounding interval */
+	uint64_t Rest,		/**< Remainder after these digits */
+	uint64_t TenKappa,	/**< Value of one in the last digit */
+	uint64_t Distance	/**< Distance to the upper bound */
+)
+{
+	while ((Rest < Distance) && (Delta - Rest >= TenKappa) &&
+		((Rest + TenKappa < Distance) ||
+		(Distance - Rest > Rest + TenKappa - Distance)))
+	{
+		Buffer[Length - 1]--;
+		Rest += TenKappa;
+	}
+}
+
+/**
+ * \brief Generate the digits between the bounds
+ */
+static void DigitGen(
+	const DiyFp& W,		/**< Scaled number */
+	const DiyFp& Mp,	/**< Scaled upper bound */
+	uint64_t Delta,		/**< Width of the rounding interval */
+	char* Buffer,		/**< Returned digits */
+	int& Length,		/**< Returned number of digits */
+	int& K			/**< Decimal exponent (adjusted) */
+)
+{
+	const DiyFp One((uint64_t)1 << -Mp.E, Mp.E);
+	const uint64_t Distance = (Mp - W).F;
+	uint32_t P1 = (uint32_t)(Mp.F >> -One.E);
+	uint64_t P2 = Mp.F & (One.F - 1);
+	int Kappa = 1;
+
+	while ((Kappa < 10) && (P1 >= Power10[Kappa]))
+	{
+		Kappa++;
+	}
+	Length = 0;
+
+	//
+	// Digits of the integer part
+	//
+	while (Kappa > 0)
+	{
+		uint32_t Divisor = (uint32_t)Power10[Kappa - 1];
+		uint32_t Digit = P1 / Divisor;
+
+		P1 %= Divisor;
+		if ((Digit != 0) || (Length != 0))
+		{
+			Buffer[Length++] = (char)('0' + Digit);
+		}
+		Kappa--;
+
+		uint64_t Rest = ((uint64_t)P1 << -One.E) + P2;
+		if (Rest <= Delta)
+		{
+			K += Kappa;
+			GrisuRound(Buffer, Length, Delta, Rest,
+				Power10[Kappa] << -One.E, Distance);
+			return;
+		}
+	}
+
+	//
+	// Digits of the fraction
+	//
+	while (true)
+	{
+		P2 *= 10;
+		Delta *= 10;
+
+		char Digit = (char)(P2 >> -One.E);
+		if ((Digit != 0) || (Length != 0))
+		{
+			Buffer[Length++] = (char)('0' + Digit);
+		}
+		P2 &= One.F - 1;
+		Kappa--;
+		if (P2 < Delta)
+		{
+			K += Kappa;
+			GrisuRound(Buffer, Length, Delta, P2, One.F,
+				(-Kappa < 20) ? Distance * Power10[-Kappa] : 0);
+			return;
+		}
+	}
+}
+
+/**
+ * \brief Shortest digits that read back as the same number
+ *
+ *	The number is Buffer * 10^K.
+ *
+ * \return Number of digits (at most 17)
+ */
+static int ShortestDigits(
+	double Number,		/**< Number to convert (positive, finite) */
+	char* Buffer,		/**< Returned digits */
+	int& K			/**< Returned decimal exponent */
+)
+{
+	const DiyFp V(Number);
+	DiyFp Minus;
+	DiyFp Plus;
+	int Length;
+
+	V.Boundaries(Minus, Plus);
+
+	const DiyFp Scale = GetCachedPower(Plus.E, K);
+	const DiyFp W = V.Normalize() * Scale;
+	DiyFp Wp = Plus * Scale;
+	DiyFp Wm = Minus * Scale;
+
+	Wm.F++;
+	Wp.F--;
+	DigitGen(W, Wp, Wp.F - Wm.F, Buffer, Length, K);
+	return Length;
+}
+
+//******************************************************************
+// BASIC layout
+//******************************************************************
+
+static const int DoubleDigits = 16;	/**< \brief Digits shown for a DOUBLE */
+static const int SingleDigits = 6;	/**< \brief Digits shown for a SINGLE */
+
+/**
+ * \brief Lay out a number the way BASIC shows it
+ *
+ *	Uses at most Precision significant digits, drops trailing
+ *	zeros, and leaves off the zero in front of the point
+ *	(".5"). With Exponent set, numbers too large or too small to
+ *	show that way use E notation (".123456E+07"). With Spaces
+ *	set, positive numbers get a leading space, and all numbers
+ *	a trailing one (NUM$).
+ *
+ * \return String containing converted value.
+ */
+static std::string LayoutNumber(
+	double Number,		/**< Number to convert */
+	int Precision,		/**< Significant digits for the type */
+	int Exponent,		/**< Allow E notation */
+	int Spaces		/**< Leading and trailing spaces */
+)
+{
+	char Digits[32];
+	char Result[400];	// Big enough for NUM1$ of any double
+	char* Ptr = Result;
+	int K;
+
+	if (Number < 0)
+	{
+		*Ptr++ = '-';
+		Number = -Number;
+	}
+	else if (Spaces)
+	{
+		*Ptr++ = ' ';
+	}
+
+	if (Number == 0.0)
+	{
+		*Ptr++ = '0';
+	}
+	else if (!std::isfinite(Number))
+	{
+		Ptr += sprintf(Ptr, std::isnan(Number) ? "NaN" : "Inf");
+	}
+	else
+	{
+		int Length = ShortestDigits(Number, Digits, K);
+		int Point = Length + K;		// Digits in front of the point
+
+		//
+		// Round to the precision of the type
+		//
+		if (Length > Precision)
+		{
+			int Carry = Digits[Precision] >= '5';
+
+			Length = Precision;
+			for (int loop = Length - 1; Carry && (loop >= 0); loop--)
+			{
+				Carry = (Digits[loop] == '9');
+				Digits[loop] = Carry ? '0' : Digits[loop] + 1;
+			}
+			if (Carry)
+			{
+				Digits[0] = '1';
+				Point++;
+			}
+		}
+		while ((Length > 1) && (Digits[Length - 1] == '0'))
+		{
+			Length--;
+		}
+
+		if (Exponent && ((Point > Precision) || (Point < -3)))
+		{
+			//
+			// .ddddddE+xx
+			//
+			int Power = (Point < 0) ? -Point : Point;
+
+			*Ptr++ = '.';
+			memcpy(Ptr, Digits, Length);
+			Ptr += Length;
+			*Ptr++ = 'E';
+			*Ptr++ = (Point < 0) ? '-' : '+';
+			if (Power >= 100)
+			{
+				*Ptr++ = '0' + Power / 100;
+			}
+			*Ptr++ = '0' + Power / 10 % 10;
+			*Ptr++ = '0' + Power % 10;
+		}
+		else if (Point <= 0)
+		{
+			*Ptr++ = '.';
+			memset(Ptr, '0', -Point);
+			Ptr += -Point;
+			memcpy(Ptr, Digits, Length);
+			Ptr += Length;
+		}
+		else if (Point >= Length)
+		{
+			memcpy(Ptr, Digits, Length);
+			Ptr += Length;
+			memset(Ptr, '0', Point - Length);
+			Ptr += Point - Length;
+		}
+		else
+		{
+			memcpy(Ptr, Digits, Point);
+			Ptr += Point;
+			*Ptr++ = '.';
+			memcpy(Ptr, Digits + Point, Length - Point);
+			Ptr += Length - Point;
+		}
+	}
+
+	if (Spaces)
+	{
+		*Ptr++ = ' ';
+	}
+	return std::string(Result, Ptr - Result);
+}
+
+/**
+ * \brief NUM$(integer)
+ *
+ *	Leading space (or minus sign) and a trailing space.
+ *
+ * \return String containing converted value.
+ */
+std::string basic::Qnum(
+	long Number	/**< Number to convert */
+)
+{
+	char Result[24];
+	char* Ptr = Result + sizeof(Result);
+	unsigned long Value = (Number < 0) ? 0 - (unsigned long)Number : Number;
+
+	*--Ptr = ' ';
+	do
+	{
+		*--Ptr = '0' + Value % 10;
+		Value /= 10;
+	} while (Value != 0);
+	*--Ptr = (Number < 0) ? '-' : ' ';
+
+	return std::string(Ptr, Result + sizeof(Result) - Ptr);
+}
+
+/**
+ * \brief NUM$(float)
+ *
+ *	Leading space (or minus sign) and a trailing space, using
+ *	E notation for very large or small numbers.
+ *
+ * \return String containing converted value.
+ */
+std::string basic::Qnum(
+	double Number	/**< Value to convert */
+)
+{
+	return LayoutNumber(Number, DoubleDigits, 1, 1);
+}
+
+/**
+ * \brief NUM$(single)
+ *
+ * \return String containing converted value.
+ */
+std::string basic::Qnum(
+	float Number	/**< Value to convert */
+)
+{
+	return LayoutNumber(Number, SingleDigits, 1, 1);
+}
+
+/**
+ * \brief NUM1$(integer)
+ *
+ * \return String containing converted value.
+ */
+std::string basic::Qnum1(
+	long Number	/**< Number to convert */
+)
+{
+	return std::to_string(Number);
+}
+
+/**
+ * \brief NUM1$(float)
+ *
+ *	NUM1$ differs from NUM$ in that it has no spaces, and never
+ *	uses E notation.
+ *
+ * \return String containing converted value.
+ */
+std::string basic::Qnum1(
+	double Number	/**< Number to convert */
+)
+{
+	return LayoutNumber(Number, DoubleDigits, 0, 0);
+}
+
+/**
+ * \brief NUM1$(single)
+ *
+ * \return String containing converted value.
+ */
+std::string basic::Qnum1(
+	float Number	/**< Number to convert */
+)
+{
+	return LayoutNumber(Number, SingleDigits, 0, 0);
+}
+
+/**
+ * \brief STR$(float)
+ *
+ *	Like NUM$, without the spaces.
+ *
+ * \return String containing converted value.
+ */
+std::string basic::str(
+	double Number	/**< Number to convert */
+)
+{
+	return LayoutNumber(Number, DoubleDigits, 1, 0);
+}
+
+/**
+ * \brief STR$(single)
+ *
+ * \return String containing converted value.
+ */
+std::string basic::str(
+	float Number	/**< Number to convert */
+)
+{
+	return LayoutNumber(Number, SingleDigits, 1, 0);
+}
+
+//******************************************************************
+// Parsing
+//******************************************************************
+
+/**
+ * \brief Doubles that are exact powers of 10
+ */
+static const double ExactPower10[] =
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * \brief Trim the spaces and tabs BASIC allows around a number
+ */
+static basic::string_view TrimNumber(
+	basic::string_view Text		/**< Text to trim */
+)
+{
+	while (!Text.empty() && ((Text.front() == ' ') || (Text.front() == '\t')))
+	{
+		Text.remove_prefix(1);
+	}
+	while (!Text.empty() && ((Text.back() == ' ') || (Text.back() == '\t')))
+	{
+		Text.remove_suffix(1);
+	}
+	return Text;
+}
+
+/**
+ * \brief Parse a floating point number
+ *
+ *	Accepts an optional sign, digits with an optional decimal
+ *	point, and an optional E (or D) exponent, with spaces and
+ *	tabs around it. An empty string is zero.
+ *
+ * \return 0 if successful, otherwise the BASIC error number
+ *	(52 for a badly formed number, 48 if it is too large).
+ */
+int basic::ValParse(
+	string_view Text,	/**< Text to parse */
+	double& Result		/**< Returned value */
+)
+{
+	Text = TrimNumber(Text);
+	Result = 0.0;
+
+	const char* Ptr = Text.data();
+	const char* End = Ptr + Text.size();
+	int Negative = 0;
+	uint64_t Mantissa = 0;
+	int MantissaDigits = 0;		// Significant digits in Mantissa
+	int Dropped = 0;		// Digits that didn't fit in Mantissa
+	int Scale = 0;			// Power of 10 to apply
+	int AnyDigits = 0;
+
+	if (Ptr == End)
+	{
+		return 0;
+	}
+
+	if ((*Ptr == '-') || (*Ptr == '+'))
+	{
+		Negative = (*Ptr == '-');
+		Ptr++;
+	}
+
+	//
+	// Mantissa
+	//
+	for (int Fraction = 0; Ptr != End; Ptr++)
+	{
+		if ((*Ptr == '.') && !Fraction)
+		{
+			Fraction = 1;
+			continue;
+		}
+		if ((*Ptr < '0') || (*Ptr > '9'))
+		{
+			break;
+		}
+		AnyDigits = 1;
+		if ((MantissaDigits < 19) && ((MantissaDigits != 0) || (*Ptr != '0')))
+		{
+			Mantissa = Mantissa * 10 + (*Ptr - '0');
+			MantissaDigits++;
+			Scale -= Fraction;
+		}
+		else if (MantissaDigits != 0)
+		{
+			Dropped = Dropped || (*Ptr != '0');
+			Scale += !Fraction;
+		}
+		else
+		{
+			Scale -= Fraction;
+		}
+	}
+	if (!AnyDigits)
+	{
+		return ErrIllegalNumber;
+	}
+
+	//
+	// Exponent
+	//
+	if ((Ptr != End) && ((*Ptr == 'E') || (*Ptr == 'e') ||
+		(*Ptr == 'D') || (*Ptr == 'd')))
+	{
+		int ExpNegative = 0;
+		int Exp = 0;
+
+		Ptr++;
+		if ((Ptr != End) && ((*Ptr == '-') || (*Ptr == '+')))
+		{
+			ExpNegative = (*Ptr == '-');
+			Ptr++;
+		}
+		if ((Ptr == End) || (*Ptr < '0') || (*Ptr > '9'))
+		{
+			return ErrIllegalNumber;
+		}
+		for (; (Ptr != End) && (*Ptr >= '0') && (*Ptr <= '9'); Ptr++)
+		{
+			if (Exp < 100000)
+			{
+				Exp = Exp * 10 + (*Ptr - '0');
+			}
+		}
+		Scale += ExpNegative ? -Exp : Exp;
+	}
+	if (Ptr != End)
+	{
+		return ErrIllegalNumber;
+	}
+
+	//
+	// Exact when the mantissa and power of 10 are both exact
+	// doubles, which covers nearly everything typed in.
+	//
+	if (Mantissa == 0)
+	{
+		Result = Negative ? -0.0 : 0.0;
+		return 0;
+	}
+	if (!Dropped && (Mantissa < (1ULL << 53)) && (Scale >= -22) && (Scale <= 22))
+	{
+		Result = (Scale < 0) ? (double)Mantissa / ExactPower10[-Scale] :
+			(double)Mantissa * ExactPower10[Scale];
+	}
+	else
+	{
+		//
+		// Let the C library do the hard ones. It needs a
+		// terminated copy, which is usually small.
+		//
+		char Buffer[64];
+		std::string Large;
+		char* Copy = Buffer;
+
+		if (Text.size() >= sizeof(Buffer))
+		{
+			Large.assign(Text.data(), Text.size());
+			Copy = &Large[0];
+		}
+		else
+		{
+			memcpy(Buffer, Text.data(), Text.size());
+			Buffer[Text.size()] = '\0';
+		}
+		std::replace(Copy, Copy + Text.size(), 'D', 'E');
+		std::replace(Copy, Copy + Text.size(), 'd', 'E');
+		Result = fabs(strtod(Copy, 0));
+	}
+
+	if (std::isinf(Result))
+	{
+		return ErrFloatOverflow;
+	}
+	if (Negative)
+	{
+		Result = -Result;
+	}
+	return 0;
+}
+
+/**
+ * \brief Parse an integer
+ *
+ *	Accepts an optional sign and digits, with spaces and tabs
+ *	around it. An empty string is zero.
+ *
+ * \return 0 if successful, otherwise the BASIC error number
+ *	(52 for a badly formed number, 51 if it is too large).
+ */
+int basic::ValParse(
+	string_view Text,	/**< Text to parse */
+	long& Result		/**< Returned value */
+)
+{
+	Text = TrimNumber(Text);
+	Result = 0;
+
+	const char* Ptr = Text.data();
+	const char* End = Ptr + Text.size();
+	int Negative = 0;
+	unsigned long Value = 0;
+	unsigned long Limit = (unsigned long)LONG_MAX;
+
+	if (Ptr == End)
+	{
+		return 0;
+	}
+	if ((*Ptr == '-') || (*Ptr == '+'))
+	{
+		Negative = (*Ptr == '-');
+		Limit += Negative;
+		Ptr++;
+	}
+	if (Ptr == End)
+	{
+		return ErrIllegalNumber;
+	}
+
+	for (; Ptr != End; Ptr++)
+	{
+		if ((*Ptr < '0') || (*Ptr > '9'))
+		{
+			return ErrIllegalNumber;
+		}
+		if ((Value > Limit / 10) || (Value * 10 > Limit - (*Ptr - '0')))
+		{
+			return ErrIntegerOverflow;
+		}
+		Value = Value * 10 + (*Ptr - '0');
+	}
+
+	Result = Negative ? (long)(0 - Value) : (long)Value;
+	return 0;
+}
+
+/**
+ * \brief VAL()
+ *
+ * \return Value of the string.
+ *	Throws "Illegal number" if it isn't a number.
+ */
+double basic::Val(
+	string_view Text	/**< String to convert */
+)
+{
+	double Result;
+	int Error = ValParse(Text, Result);
+
+	if (Error != 0)
+	{
+		throw BasicError(Error);
+	}
+	return Result;
+}
+
+/**
+ * \brief VAL%()
+ *
+ * \return Value of the string.
+ *	Throws "Illegal number" if it isn't an integer, and
+ *	"Integer error or overflow" if it is too large.
+ */
+long basic::ValInteger(
+	string_view Text	/**< String to convert */
+)
+{
+	long Result;
+	int Error = ValParse(Text, Result);
+
+	if (Error != 0)
+	{
+		throw BasicError(Error);
+	}
+	return Result;
+}
@@ -0,0 +1,191 @@
+/** \file basicprofile.cc
+ * \brief Line level profiling of translated programs
+ */
+
+//
+// Include files
+//
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "basicprofile.h"
+
+/**
+ * \brief Where the time goes before the first line starts
+ *
+ *	Also what new threads start out charging. Not reported.
+ */
+static basic::ProfileLine Startup = { "(startup)", 0, 0, 0 };
+
+thread_local basic::ProfileLine* basic::ProfileCurrent = &Startup;
+thread_local uint64_t basic::ProfileLast = 0;
+
+static basic::ProfileTable* Tables = 0;	/**< \brief Registered modules */
+
+/**
+ * \brief Register a module's lines
+ *
+ *	Called during static initialization, from the table the
+ *	translator writes into each module. The first one arranges
+ *	for the report to be written at exit.
+ */
+basic::ProfileTable::ProfileTable(
+	ProfileLine* NewLines,		/**< Lines in the module */
+	size_t NewCount			/**< Number of lines */
+)
+{
+	Lines = NewLines;
+	Count = NewCount;
+	Next = Tables;
+	if (Tables == 0)
+	{
+		std::atexit(ProfileReport);
+	}
+	Tables = this;
+}
+
+/**
+ * \brief Text of a source line, for the report
+ *
+ *	The source files are read (once each) when the report is
+ *	written. If one can't be found, the text is left blank.
+ */
+static const std::string& SourceText(
+	const char* File,	/**< BASIC source file */
+	int Line		/**< Line number */
+)
+{
+	static std::map<std::string, std::vector<std::string> > Sources;
+	static const std::string Blank;
+
+	std::map<std::string, std::vector<std::string> >::iterator Find =
+		Sources.find(File);
+	if (Find == Sources.end())
+	{
+		std::ifstream Source(File);
+		std::vector<std::string> &Text = Sources[File];
+		std::string ThisLine;
+
+		while (std::getline(Source, ThisLine))
+		{
+			Text.push_back(ThisLine);
+		}
+		Find = Sources.find(File);
+	}
+
+	if ((Line < 1) || (Line > (int)Find->second.size()))
+	{
+		return Blank;
+	}
+	return Find->second[Line - 1];
+}
+
+/**
+ * \brief Order lines by time used, then by where they are
+ */
+static bool MoreTicks(
+	const basic::ProfileLine* a,	/**< First line */
+	const basic::ProfileLine* b	/**< Second line */
+)
+{
+	if (a->Ticks != b->Ticks)
+	{
+		return a->Ticks > b->Ticks;
+	}
+	int Compare = std::string(a->File).compare(b->File);
+	if (Compare != 0)
+	{
+		return Compare < 0;
+	}
+	return a->Line < b->Line;
+}
+
+/**
+ * \brief Write out the hot spots
+ *
+ *	Called at exit. Every line that was run is listed, the
+ *	ones that used the most time first.
+ */
+void basic::ProfileReport()
+{
+	//
+	// Charge the line that was running at exit
+	//
+	uint64_t Now = ProfileClock();
+	ProfileCurrent->Ticks += Now - ProfileLast;
+	ProfileLast = Now;
+	ProfileCurrent = &Startup;
+
+	std::vector<const ProfileLine*> Lines;
+	uint64_t Total = 0;
+
+	for (ProfileTable* Table = Tables; Table != 0; Table = Table->Next)
+	{
+		for (size_t loop = 0; loop < Table->Count; loop++)
+		{
+			if (Table->Lines[loop].Hits != 0)
+			{
+				Lines.push_back(Table->Lines + loop);
+				Total += Table->Lines[loop].Ticks;
+			}
+		}
+	}
+	std::sort(Lines.begin(), Lines.end(), MoreTicks);
+
+	FILE* Report = stderr;
+	const char* ReportName = getenv("BASIC_PROFILE");
+
+	if ((ReportName != 0) && (*ReportName != '\0'))
+	{
+		Report = fopen(ReportName, "w");
+		if (Report == 0)
+		{
+			perror(ReportName);
+			return;
+		}
+	}
+
+	fprintf(Report, "\nBASIC line profile (%s)\n\n",
+#if defined(__x86_64__) || defined(__i386__)
+		"ticks are processor cycles"
+#else
+		"ticks are nanoseconds"
+#endif
+		);
+	fprintf(Report, "%7s %15s %12s %10s  %s\n",
+		"%time", "ticks", "hits", "ticks/hit", "line");
+
+	for (size_t loop = 0; loop < Lines.size(); loop++)
+	{
+		const ProfileLine* Line = Lines[loop];
+		std::string Text = SourceText(Line->File, Line->Line);
+
+		//
+		// Enough of the source to recognize it
+		//
+		Text.erase(0, Text.find_first_not_of(" \t"));
+		if (Text.size() > 50)
+		{
+			Text = Text.substr(0, 47) + "...";
+		}
+
+		fprintf(Report, "%7.2f %15llu %12llu %10llu  %s:%d  %s\n",
+			Total ? 100.0 * Line->Ticks / Total : 0.0,
+			(unsigned long long)Line->Ticks,
+			(unsigned long long)Line->Hits,
+			(unsigned long long)(Line->Ticks / Line->Hits),
+			Line->File, Line->Line, Text.c_str());
+	}
+	fprintf(Report, "%7.2f %15llu  total\n", 100.0,
+		(unsigned long long)Total);
+
+	if (Report != stderr)
+	{
+		fclose(Report);
+	}
+}
@@ -0,0 +1,102 @@
+/**\file basicprofile.h
+ * \brief Line level profiling of translated programs
+ *
+ *	When a program is translated with -f, btran puts a
+ *	ProfileHit() in front of each statement, naming the BASIC
+ *	file and line it came from. Each one counts the hit and
+ *	charges the clock ticks since the previous one to the line
+ *	that was running, so a line gets the time spent in
+ *	everything it does (including the library calls), up to
+ *	the start of the next line.
+ *
+ *	At exit, the lines are written out sorted by the time they
+ *	used, to standard error or to the file named by the
+ *	BASIC_PROFILE environment variable.
+ *
+ *	The counters aren't locked, so the numbers for a program
+ *	running the same code on several threads at once are only
+ *	approximate.
+ */
+#ifndef _BASICPROFILE_H_
+#define _BASICPROFILE_H_
+
+//
+// include files
+//
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace basic
+{
+/**
+ * \brief Counters for one BASIC source line
+ *
+ *	The translator writes a table of these (just the file and
+ *	line, so they start out as zero) for each module.
+ */
+struct ProfileLine
+{
+	const char* File;	/**< \brief BASIC source file */
+	int Line;		/**< \brief Line in the source file */
+	uint64_t Hits;		/**< \brief Times the line started */
+	uint64_t Ticks;		/**< \brief Clock ticks used by the line */
+};
+
+/**
+ * \brief Registers a module's table of lines for the report
+ */
+class ProfileTable
+{
+public:
+	ProfileLine* Lines;	/**< \brief Lines in the module */
+	size_t Count;		/**< \brief Number of lines */
+	ProfileTable* Next;	/**< \brief Next module */
+
+	ProfileTable(ProfileLine* NewLines, size_t NewCount);
+};
+
+extern thread_local ProfileLine* ProfileCurrent;
+extern thread_local uint64_t ProfileLast;
+
+/**
+ * \brief Read the clock
+ *
+ *	The time stamp counter where there is one (a few cycles to
+ *	read), otherwise nanoseconds from the steady clock.
+ */
+inline uint64_t ProfileClock()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * \brief A line is starting
+ *
+ *	Charges the time since the last call to the line that was
+ *	running, and makes this one the running line.
+ */
+inline void ProfileHit(
+	ProfileLine &Line	/**< Line that is starting */
+)
+{
+	uint64_t Now = ProfileClock();
+
+	ProfileCurrent->Ticks += Now - ProfileLast;
+	ProfileLast = Now;
+	ProfileCurrent = &Line;
+	Line.Hits++;
+}
+
+void ProfileReport();
+}
+
+#endif
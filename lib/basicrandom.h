@@ -0,0 +1,137 @@
+/**\file basicrandom.h
+ * \brief Random numbers for RND
+ *
+ *	xoshiro256++ (Blackman and Vigna). It is small and fast,
+ *	has a period of 2^256 - 1, and passes the usual statistical
+ *	tests, which is more than can be said for rand().
+ *
+ *	Each RuntimeContext has its own generator, so jobs running
+ *	on different threads don't share (or lock) any state, and
+ *	a job seeded with the same number always gets the same
+ *	numbers.
+ */
+#ifndef _BASICRANDOM_H_
+#define _BASICRANDOM_H_
+
+//
+// include files
+//
+#include <cstddef>
+#include <cstdint>
+
+namespace basic
+{
+/**
+ * \brief xoshiro256++ random number generator
+ *
+ *	Meets the requirements of a uniform random bit generator,
+ *	so it can be used with the <random> distributions.
+ */
+class RandomGenerator
+{
+public:
+	typedef uint64_t result_type;	/**< \brief Type of a raw number */
+
+	/**
+	 * \brief Seed used when a job doesn't RANDOMIZE
+	 *
+	 *	Like VAX BASIC, a program that doesn't RANDOMIZE gets
+	 *	the same numbers every time it runs.
+	 */
+	static const uint64_t DefaultSeed = 0x2545f4914f6cdd1dULL;
+
+private:
+	uint64_t State[4];		/**< \brief Generator state */
+
+	/**
+	 * \brief Rotate left
+	 */
+	static uint64_t Rotate(uint64_t Value, int Count)
+	{
+		return (Value << Count) | (Value >> (64 - Count));
+	}
+
+public:
+	/**
+	 * \brief Constructor
+	 */
+	explicit RandomGenerator(
+		uint64_t Seed = DefaultSeed	/**< Starting seed */
+	)
+	{
+		seed(Seed);
+	}
+
+	/**
+	 * \brief Restart the sequence
+	 *
+	 *	The seed is spread over the state with splitmix64, so
+	 *	any seed (zero included) gives a good starting state,
+	 *	and nearby seeds give unrelated sequences.
+	 */
+	void seed(
+		uint64_t Seed		/**< New seed */
+	)
+	{
+		for (int loop = 0; loop < 4; loop++)
+		{
+			uint64_t Mix = (Seed += 0x9e3779b97f4a7c15ULL);
+			Mix = (Mix ^ (Mix >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			Mix = (Mix ^ (Mix >> 27)) * 0x94d049bb133111ebULL;
+			State[loop] = Mix ^ (Mix >> 31);
+		}
+	}
+
+	//! Smallest raw number
+	static constexpr result_type min() { return 0; }
+	//! Largest raw number
+	static constexpr result_type max() { return UINT64_MAX; }
+
+	/**
+	 * \brief Next raw number
+	 */
+	result_type operator()()
+	{
+		uint64_t Result = Rotate(State[0] + State[3], 23) + State[0];
+		uint64_t Shifted = State[1] << 17;
+
+		State[2] ^= State[0];
+		State[3] ^= State[1];
+		State[1] ^= State[2];
+		State[0] ^= State[3];
+		State[2] ^= Shifted;
+		State[3] = Rotate(State[3], 45);
+
+		return Result;
+	}
+
+	/**
+	 * \brief Next number in [0, 1)
+	 *
+	 *	Uses the top 53 bits, so every value is a multiple
+	 *	of 2^-53 and 1.0 can never come back.
+	 */
+	double Double()
+	{
+		return (double)((*this)() >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	/**
+	 * \brief Fill an array with numbers in [0, 1)
+	 *
+	 *	Gives the same numbers as calling Double() Count times.
+	 */
+	void Fill(
+		double* Dest,		/**< Where to put them */
+		size_t Count		/**< How many */
+	)
+	{
+		for (size_t loop = 0; loop < Count; loop++)
+		{
+			Dest[loop] = Double();
+		}
+	}
+};
+}
+
+#endif
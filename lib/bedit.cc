@@ -38,7 +38,7 @@
  *	\note Also used by CVT$$ code.
  */
 std::string basic::edit(
-	const std::string &Source,	/**< String to be converted */
+	basic::string_view Source,	/**< String to be converted */
 	const int Code			/**< Flag for conversion */
 )
 {
@@ -184,7 +184,7 @@ std::string basic::edit(
 			((Result.back() == ' ') ||
 			(Result.back() == '\t')))
 		{
-			Result.erase(Result.back(), 1);
+			Result.pop_back();
 		}
 	}
 
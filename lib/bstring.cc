@@ -21,77 +21,15 @@
 #include <string>
 #include <iostream>
 #include <cstring>
+#include <climits>
 
 #include "basicfun.h"
 #include "bstring.h"
 #include "basicchannel.h"
-
-//
-// Global values
-//
-long basic::Status = 0;		/**< Status (status) */
-
+#include "keyboard.h"
 
 //******************************************************************
 
-/**
- * \brief NUM$(integer)
- *
- * Convert an intger value into a string.
- *
- * \return String containing converted value.
- */
-std::string basic::Qnum(
-	long Number	/**< Number to convert */
-)
-{
-	return std::to_string(Number) + " ";
-}
-
-/**
- * \brief NUM$(float)
- *
- *	Convert an float value into a string.
- *
- * \return String containing converted value.
- */
-std::string basic::Qnum(
-	double Number	/**< Value to convert */
-)
-{
-	return std::to_string(Number);
-}
-
-/**
- * \brief NUM1$(integer)
- *
- * Convert an intger value into a string.
- *
- * \return String containing converted value.
- * \note NUM$ and NUM1$ are the same for inteer values.
- */
-std::string basic::Qnum1(
-	long Number	/**< Number to convert */
-)
-{
-	return std::to_string(Number);
-}
-
-/**
- * \brief NUM1$(float)
- * Convert a float value into a string.
- * NUM1$ differs from NUM$ in that it will not use scientific
- * notation in the converted string.
- *
- * \return String containing converted value.
-*/
-std::string basic::Qnum1(
-	double Number	/**< Number to convert */
-)
-{
-	return std::to_string(Number);
-}
-
 /**
  * \brief RAD$()
  *
@@ -280,27 +218,46 @@ void basic::BChange2(
 /**
  * \brief Inkey
  *
- *	Input a single character from the user
+ *	Input a single key from the user. Keys other than
+ *	characters come back as their names ("UP", "PF1", "F10").
+ *	Throws "Wait exhausted" if a wait is given and nothing is
+ *	typed in that many seconds.
+ *
+ * \bug Always reads the terminal, whatever the channel.
  */
 std::string basic::Inkey(
 	long channel,		/**< IO Channel to use */
-	long timeout		/**< Timeout value */
+	long timeout		/**< Seconds to wait, 0 for ever */
 )
 {
-//	std::cerr << "Inkey not yet implemented!" << std::endln;
-	exit(1);
+	int Key = TerminalKeyboard().Read((timeout > 0) ? timeout * 1000 : -1);
+
+	switch (Key)
+	{
+	case KeyTimeout:
+		throw BasicError(ErrWaitExhausted);
+	case KeyCancelled:
+		throw BasicError(ErrEndOfFile);
+	}
+	return KeyName(Key);
 }
 
 /**
  * \brief Convert ascii to integer
  *
- *	Really needs some error trapping.
- * \return integer value of string
- * \bug should use STRTOD instead of ATOI.
+ * \return integer value of string.
+ *	Throws "Illegal number" if it isn't an integer, and
+ *	"Integer error or overflow" if it doesn't fit in an int.
  */
 int basic::atoi(
 	const std::string &str	/**< String to convert */
 )
 {
-	return atoi(str.c_str());
+	long Value = ValInteger(str);
+
+	if ((Value < INT_MIN) || (Value > INT_MAX))
+	{
+		throw BasicError(ErrIntegerOverflow);
+	}
+	return Value;
 }
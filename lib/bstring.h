@@ -19,10 +19,13 @@
 #include <string>
 #include <cstring>
 #include <iostream>
+#include <algorithm>
+#include <type_traits>
 
 #include <string>
 //#include <boost/regex.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/utility/string_view.hpp>
 #include <boost/algorithm/string/trim.hpp>
 
 #ifndef MAX_INPUT
@@ -40,97 +43,317 @@
 namespace basic
 {
 /**
- * \brief LEFT$()
+ * \brief Read only reference to string data
  *
- * Return the left part of a string.
+ * Functions that only look at a string take one of these, so
+ * that passing a literal or a fixed length string doesn't build
+ * a temporary std::string on every call.
+ */
+typedef boost::string_view string_view;
+
+//
+// Substrings
+//
+//	The *_view versions return a view into the original string
+//	instead of a new one. btran uses them where the result is only
+//	looked at (compared, searched, or appended to something else),
+//	so taking a substring doesn't allocate. The view is only good
+//	as long as the original string is.
+//
+
+/**
+ * \brief LEFT$(), as a view
  *
- * \return Left part of the string
+ * \return First Length characters (all of them if it is shorter,
+ *	none if Length is less than 1)
  */
-inline std::string left(
-	const std::string& Source,	/**< Original string */
+inline string_view left_view(
+	string_view Source,		/**< Original string */
 	long Length			/**< Characters to take */
-	)
-	{ return std::string(Source, 0, Length); }
+)
+{
+	return (Length <= 0) ? string_view() : Source.substr(0, Length);
+}
 
 /**
- * \brief RIGHT$()
- *
- * Return the right part of a string
+ * \brief RIGHT$(), as a view
  *
- * If you use substr past the end of the string, it crashes.
- *
- * \return Right part of string
+ * \return Characters from position Start (from 1) to the end
  */
-inline std::string right(
-	const std::string& Source,	/**< Original string */
-	long Length			/**< Characters to skip over */
+inline string_view right_view(
+	string_view Source,		/**< Original string */
+	long Start			/**< First character to take */
 )
 {
-	if (Length <= 0)
-	{
-		Length = 1;
-	}
-	if (Length <= Source.size())
+	if (Start <= 0)
 	{
-		return std::string(Source, Length - 1);
+		Start = 1;
 	}
-	else
+	if ((unsigned long)Start > Source.size())
 	{
-		return "";
+		return string_view();
 	}
+	return Source.substr(Start - 1);
 }
 
 /**
- * \brief SEG$()
- * \return substring
+ * \brief SEG$(), as a view
+ *
+ * \return Characters from position Start to position End
+ *	(from 1, inclusive)
  */
-inline std::string Qseg(
-	const std::string& Source,	/**< Original string */
+inline string_view Qseg_view(
+	string_view Source,		/**< Original string */
 	long Start,			/**< Start position */
 	long End			/**< End position */
-	)
+)
 {
 	if (Start <= 0)
 	{
 		Start = 1;
 	}
-	if (Start < Source.size())
-	{
-		return std::string(Source, Start - 1, End - Start + 1);
-	}
-	else
+	if (((unsigned long)Start > Source.size()) || (End < Start))
 	{
-		return "";
+		return string_view();
 	}
+	return Source.substr(Start - 1, End - Start + 1);
 }
 
-//! MID$()
-inline std::string mid(const std::string& Source, long Start, long Length)
+/**
+ * \brief MID$(), as a view
+ *
+ * \return Length characters from position Start (from 1)
+ */
+inline string_view mid_view(
+	string_view Source,		/**< Original string */
+	long Start,			/**< Start position */
+	long Length			/**< Characters to take */
+)
 {
 	if (Start <= 0)
 	{
 		Start = 1;
 	}
-	if (Start <= Source.size())
+	if (((unsigned long)Start > Source.size()) || (Length <= 0))
 	{
-		return std::string(Source, Start - 1, Length);
+		return string_view();
 	}
-	else
+	return Source.substr(Start - 1, Length);
+}
+
+/**
+ * \brief TRM$(), as a view
+ *
+ * \return String without trailing spaces and tabs
+ */
+inline string_view trm_view(
+	string_view Source		/**< Original string */
+)
+{
+	return Source.substr(0, Source.find_last_not_of(" \t") + 1);
+}
+
+//! LEFT$()
+inline std::string left(string_view Source, long Length)
+	{ return left_view(Source, Length).to_string(); }
+//! RIGHT$()
+inline std::string right(string_view Source, long Start)
+	{ return right_view(Source, Start).to_string(); }
+//! SEG$()
+inline std::string Qseg(string_view Source, long Start, long End)
+	{ return Qseg_view(Source, Start, End).to_string(); }
+//! MID$()
+inline std::string mid(string_view Source, long Start, long Length)
+	{ return mid_view(Source, Start, Length).to_string(); }
+//! TRM$()
+inline std::string trm(string_view Source)
+	{ return trm_view(Source).to_string(); }
+
+//
+// String concatenation
+//
+//	btran turns 'A$ + B$ + C$' into 'basic::Concat(a, b, c)', and
+//	'A$ = A$ + B$ + C$' into 'basic::Append(a, b, c)', so that the
+//	result is allocated once instead of once per '+'.
+//
+
+/**
+ * \brief Length of one piece of a concatenation
+ */
+inline std::string::size_type ConcatSize(
+	const std::string& Source	/**< Piece to measure */
+)
+	{ return Source.size(); }
+
+/**
+ * \brief Length of one piece of a concatenation
+ */
+inline std::string::size_type ConcatSize(
+	const char* Source		/**< Piece to measure */
+)
+	{ return strlen(Source); }
+
+/**
+ * \brief Length of one piece of a concatenation
+ */
+inline std::string::size_type ConcatSize(
+	char Source			/**< Piece to measure */
+)
+	{ return 1; }
+
+/**
+ * \brief Length of one piece of a concatenation
+ */
+inline std::string::size_type ConcatSize(
+	string_view Source		/**< Piece to measure */
+)
+	{ return Source.size(); }
+
+/**
+ * \brief Append one piece of a concatenation
+ */
+inline void ConcatPiece(
+	std::string& Dest,		/**< String to append to */
+	const std::string& Source	/**< Piece to append */
+)
+	{ Dest += Source; }
+
+/**
+ * \brief Append one piece of a concatenation
+ */
+inline void ConcatPiece(
+	std::string& Dest,		/**< String to append to */
+	const char* Source		/**< Piece to append */
+)
+	{ Dest += Source; }
+
+/**
+ * \brief Append one piece of a concatenation
+ */
+inline void ConcatPiece(
+	std::string& Dest,		/**< String to append to */
+	char Source			/**< Piece to append */
+)
+	{ Dest += Source; }
+
+/**
+ * \brief Append one piece of a concatenation
+ */
+inline void ConcatPiece(
+	std::string& Dest,		/**< String to append to */
+	string_view Source		/**< Piece to append */
+)
+	{ Dest.append(Source.data(), Source.size()); }
+
+/**
+ * \brief Total length of a concatenation (end of list)
+ */
+inline std::string::size_type ConcatLength()
+	{ return 0; }
+
+/**
+ * \brief Total length of a concatenation
+ */
+template <typename First, typename... Rest>
+inline std::string::size_type ConcatLength(
+	const First& Part,		/**< First piece */
+	const Rest&... Parts		/**< Remaining pieces */
+)
+	{ return ConcatSize(Part) + ConcatLength(Parts...); }
+
+/**
+ * \brief Append pieces to a string (end of list)
+ */
+inline void ConcatAppend(
+	std::string& Dest		/**< String to append to */
+)
+	{ }
+
+/**
+ * \brief Append pieces to a string
+ */
+template <typename First, typename... Rest>
+inline void ConcatAppend(
+	std::string& Dest,		/**< String to append to */
+	const First& Part,		/**< First piece */
+	const Rest&... Parts		/**< Remaining pieces */
+)
+{
+	ConcatPiece(Dest, Part);
+	ConcatAppend(Dest, Parts...);
+}
+
+/**
+ * \brief A$ + B$ + ...
+ *
+ * Sums the lengths, allocates once, and appends each piece.
+ *
+ * \return Concatenated string
+ */
+template <typename... Parts>
+inline std::string Concat(
+	const Parts&... Part		/**< Pieces to join */
+)
+{
+	std::string Result;
+	Result.reserve(ConcatLength(Part...));
+	ConcatAppend(Result, Part...);
+	return Result;
+}
+
+/**
+ * \brief A$ = A$ + B$ + ...
+ *
+ * Appends in place, growing the buffer at least geometrically so
+ * that building a string in a loop stays linear.
+ *
+ * \return The destination string
+ */
+template <typename... Parts>
+inline std::string& Append(
+	std::string& Dest,		/**< String to append to */
+	const Parts&... Part		/**< Pieces to append */
+)
+{
+	std::string::size_type Need = Dest.size() + ConcatLength(Part...);
+	if (Need > Dest.capacity())
 	{
-		return "";
+		Dest.reserve(std::max(Need, 2 * Dest.capacity()));
 	}
+	ConcatAppend(Dest, Part...);
+	return Dest;
+}
+
+/**
+ * \brief Hash for SELECT CASE on strings
+ *
+ * btran hashes each literal CASE label with this same function
+ * (32 bit FNV-1a, offset by Seed) when it translates the program,
+ * and dispatches on the result with a switch.
+ * The two versions must stay identical.
+ *
+ * \return 32 bit hash value
+ */
+inline unsigned long SelectHash(
+	const std::string& Source,	/**< String being selected on */
+	unsigned long Seed		/**< Seed chosen by btran */
+)
+{
+	unsigned long Hash = (2166136261UL ^ Seed) & 0xffffffffUL;
+
+	for (std::string::size_type loop = 0; loop < Source.size(); loop++)
+	{
+		Hash ^= (unsigned char)Source[loop];
+		Hash = (Hash * 16777619UL) & 0xffffffffUL;
+	}
+	return Hash;
 }
-//! TRM$()
-inline std::string trm(const std::string& Source)
-	{ std::string work = Source;
-	work.erase(work.find_last_not_of(" \t") + 1);
-	return work; }
 
 //
 // Various string type functions
 //
-int instr(unsigned long Start, char* Base, char* Search);
-std::string edit(const std::string& Source, const int Code);
+int instr(long Start, char* Base, char* Search);
+std::string edit(string_view Source, const int Code);
 std::string sys(const std::string& Source);
 long cvtai(std::string x);
 std::string cvtia(int x);
@@ -159,36 +382,73 @@ inline std::string Char(int Character) { return std::string(1, (const char)Chara
 inline std::string Qspace(long Count) { return std::string(Count, ' '); }
 
 std::string Qnum(long Number);
-//! NUM$()
-inline std::string Qnum(int Number) { return Qnum((long)Number); }
+//! NUM$() of the other integer types
+template <class N, typename std::enable_if<std::is_integral<N>::value, int>::type = 0>
+inline std::string Qnum(N Number) { return Qnum((long)Number); }
 std::string Qnum(double Number);
+std::string Qnum(float Number);
 std::string Qnum1(long Number);
-//! NUM1$()
-inline std::string Qnum1(int Number) { return Qnum1((long)Number); }
+//! NUM1$() of the other integer types
+template <class N, typename std::enable_if<std::is_integral<N>::value, int>::type = 0>
+inline std::string Qnum1(N Number) { return Qnum1((long)Number); }
 std::string Qnum1(double Number);
+std::string Qnum1(float Number);
 
 //! STR$()
 inline std::string str(long Number) { return Qnum1(Number); }
-//! STR$()
-inline std::string str(double Number) { return Qnum1(Number); }
+//! STR$() of the other integer types
+template <class N, typename std::enable_if<std::is_integral<N>::value, int>::type = 0>
+inline std::string str(N Number) { return Qnum1((long)Number); }
+std::string str(double Number);
+std::string str(float Number);
+
+int ValParse(string_view Text, double& Result);
+int ValParse(string_view Text, long& Result);
+double Val(string_view Text);
+long ValInteger(string_view Text);
+
+//
+// Substring searches (INSTR, POS)
+//
+size_t Find(string_view Text, string_view Pattern, size_t Start = 0);
 
-//! INSTR()
-inline int instr(unsigned long Start, const std::string& BaseString,
-	const std::string& SearchString)
-	{ return BaseString.find(SearchString, Start - 1) + 1; }
+/**
+ * \brief A search string prepared for repeated searches
+ *
+ * INSTR with the same search string over and over (typically a
+ * literal in a loop) can do the setup once. btran creates these
+ * for literal search strings.
+ */
+class Needle
+{
+private:
+	std::string Pattern;		/**< \brief String to look for */
+	size_t Skip[256];		/**< \brief Horspool shifts (long patterns) */
+
+public:
+	explicit Needle(string_view NewPattern);
+
+	//! The search string
+	const std::string& str() const { return Pattern; }
+	size_t Find(string_view Text, size_t Start = 0) const;
+};
+
+int instr(long Start, string_view BaseString, string_view SearchString);
+int instr(long Start, string_view BaseString, const Needle& SearchString);
+//! POS()
+inline int pos(char* Base, char* Search, long Start)
+	{ return instr(Start, Base, Search); }
 //! POS()
-inline int pos(char* Base, char* Search, unsigned long Start)
-	{ return instr(Start - 1, Base, Search) + 1; }
+inline int pos(string_view BaseString, string_view SearchString, long Start)
+	{ return instr(Start, BaseString, SearchString); }
 //! POS()
-inline int pos(const std::string& BaseString,const std::string& SearchString,
-	unsigned long Start)
-	{ return BaseString.find(SearchString, Start - 1) + 1; }
+inline int pos(string_view BaseString, const Needle& SearchString, long Start)
+	{ return instr(Start, BaseString, SearchString); }
 //! VAL()
-inline double atof(const std::string& Source)
-	{ return strtod(Source.c_str(), 0); }
+inline double atof(const std::string& Source) { return Val(Source); }
 
 std::string Qrad(const unsigned int Number);
-std::string& ert(const long Number);
+const std::string& ert(const long Number);
 
 void BChange1(const std::string& source, int *dest);
 void BChange1(const char* source, int *dest);
@@ -212,7 +472,7 @@ std::string Inkey(long channel, long wait = 0);
 static inline void Lset
 (
 	std::string &dest,		/**< String to modify */
-	const std::string &source	/**< String to copy into dest */
+	basic::string_view source	/**< String to copy into dest */
 )
 {
 	for (int loop = 0; loop < dest.size(); loop++)
@@ -237,7 +497,7 @@ static inline void Lset
 static inline void Rset
 (
 	std::string &dest,		/**< String to modify */
-	const std::string &source	/**< String to copy into dest */
+	basic::string_view source	/**< String to copy into dest */
 )
 {
 	int start = dest.size() - source.size();
@@ -8,36 +8,79 @@
 #ifndef _datalist_h_
 #define _datalist_h_
 
+#include <atomic>
+
+#include "basiccontext.h"
+#include "bstring.h"
+
 namespace basic
 {
+template <int P, int S> class Decimal;
+
 /**
  * \brief class to handle "DATA" statements
  *
  * Class to handle "DATA" statements.
+ *
+ * The values are constant, so the object is shared, but the
+ * position in the list belongs to the running job and is kept
+ * in its RuntimeContext. Each list is given a slot in the
+ * job's table of positions when it is built, so finding the
+ * position on a READ is just an index.
  */
 class DataListClass
 {
 private:
-	int count;		/**< \brief Current element */
 	const char** Values;	/**< \brief Array containing values */
+	int Slot;		/**< \brief Where the position is kept */
+
+	//! Hand out the slots
+	static int NewSlot()
+	{
+		static std::atomic<int> Next(0);
+		return Next++;
+	}
+	//! Position of the next value for this job
+	int& Count()
+	{
+		std::vector<int>& Cursor = Context().DataCursor;
+		if ((size_t)Slot >= Cursor.size())
+		{
+			Cursor.resize(Slot + 1, 0);
+		}
+		return Cursor[Slot];
+	}
+	//! Read off a number ("Data format error" if it isn't one)
+	template <class T>
+	void Number(T& result)
+	{
+		if (ValParse(Values[Count()++], result) != 0)
+		{
+			throw BasicError(ErrDataFormat);
+		}
+	}
 
 public:
 	//! Empty constructor
-	DataListClass() { count = 0; }
+	DataListClass() { Values = 0; Slot = NewSlot(); }
 	//! Constructor with data list
 	DataListClass(const char* List[])
-		{ Values = List; count = 0; }
+		{ Values = List; Slot = NewSlot(); }
 
 	//! Read off a double value
-	void Read(double& result) { result = atof(Values[count++]); }
+	void Read(double& result) { Number(result); }
 	//! Read off an integer value
-	void Read(int& result) { result = atoi(Values[count++]); }
+	void Read(int& result) { long Value; Number(Value); result = Value; }
 	//! Read off a long value
-	void Read(long& result) { result = atol(Values[count++]); }
+	void Read(long& result) { Number(result); }
 	//! Read off a string value
-	void Read(std::string& result) { result = Values[count++]; }
+	void Read(std::string& result) { result = Values[Count()++]; }
+	//! Read off a decimal value (exactly, without going through double)
+	template <int P, int S>
+	void Read(Decimal<P, S>& result)
+		{ result = Decimal<P, S>(Values[Count()++]); }
 	//! Reset to the beginning of the list
-	void Reset() { count = 0; }
+	void Reset() { Count() = 0; }
 };
 }
 #endif
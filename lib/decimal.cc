@@ -0,0 +1,80 @@
+/** \file decimal.cc
+ * \brief DECIMAL(p,s) numbers
+ */
+
+//
+// Include files
+//
+#include "decimal.h"
+
+/**
+ * \brief Left * Right / Divisor, when Left * Right doesn't fit
+ *
+ *	Only needed for DECIMALs wider than 18 digits with a lot of
+ *	places, so it favours being simple over being quick. The
+ *	product is formed in 256 bits and divided a bit at a time.
+ *
+ * \return The quotient, rounded half away from zero.
+ *	Throws "Decimal error or overflow" if it doesn't fit.
+ */
+basic::DecimalWide basic::DecimalMulDiv(
+	DecimalWide Left,	/**< Number to multiply */
+	DecimalWide Right,	/**< Number to multiply by */
+	DecimalWide Divisor	/**< Number to divide by (not zero) */
+)
+{
+	typedef unsigned __int128 Unsigned;
+	const Unsigned Low64 = ~(uint64_t)0;
+
+	int Negative = (Left < 0) != (Right < 0);
+	Negative = Negative != (Divisor < 0);
+	Unsigned A = (Left < 0) ? -(Unsigned)Left : (Unsigned)Left;
+	Unsigned B = (Right < 0) ? -(Unsigned)Right : (Unsigned)Right;
+	Unsigned C = (Divisor < 0) ? -(Unsigned)Divisor : (Unsigned)Divisor;
+
+	//
+	// 256 bit product, as two 128 bit halves
+	//
+	Unsigned P00 = (A & Low64) * (B & Low64);
+	Unsigned P01 = (A & Low64) * (B >> 64);
+	Unsigned P10 = (A >> 64) * (B & Low64);
+	Unsigned P11 = (A >> 64) * (B >> 64);
+	Unsigned Middle = (P00 >> 64) + (P01 & Low64) + (P10 & Low64);
+	Unsigned Low = (P00 & Low64) | (Middle << 64);
+	Unsigned High = P11 + (P01 >> 64) + (P10 >> 64) + (Middle >> 64);
+
+	if (High >= C)
+	{
+		throw BasicError(ErrDecimalOverflow);
+	}
+
+	//
+	// Long division, one bit at a time
+	//
+	Unsigned Remainder = High;
+	Unsigned Quotient = 0;
+
+	for (int loop = 127; loop >= 0; loop--)
+	{
+		int Carry = (int)(Remainder >> 127);
+
+		Remainder = (Remainder << 1) | ((Low >> loop) & 1);
+		Quotient <<= 1;
+		if (Carry || (Remainder >= C))
+		{
+			Remainder -= C;
+			Quotient |= 1;
+		}
+	}
+
+	if (Remainder >= C - Remainder)
+	{
+		Quotient++;
+	}
+	if (Quotient >> 127)
+	{
+		throw BasicError(ErrDecimalOverflow);
+	}
+
+	return Negative ? -(DecimalWide)Quotient : (DecimalWide)Quotient;
+}
@@ -0,0 +1,601 @@
+/**\file decimal.h
+ * \brief DECIMAL(p,s) numbers
+ *
+ *	A Decimal<P,S> holds a number with P digits, S of them after
+ *	the decimal point, exactly. It is kept as an integer scaled
+ *	by 10^S, in an int64_t when it fits (P <= 18) and in an
+ *	__int128 otherwise (P <= 31, as on the VAX), so money adds
+ *	up to the penny without floating point rounding.
+ *
+ *	As in VAX BASIC:
+ *	- Results are rounded (half away from zero) to S places.
+ *	- A result with more than P digits is "Decimal error or
+ *	  overflow" (181).
+ *	- Mixing a DECIMAL with a floating point value gives a
+ *	  floating point result, which is rounded again when it is
+ *	  stored back into a DECIMAL.
+ *	- DECIMAL without a size is DECIMAL(15,2).
+ */
+#ifndef _DECIMAL_H_
+#define _DECIMAL_H_
+
+//
+// include files
+//
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+#include "bstring.h"
+#include "pusing.h"
+#include "basiccontext.h"
+#include "vaxnumber.h"
+
+namespace basic
+{
+typedef __int128 DecimalWide;	/**< \brief Holds any intermediate result */
+
+/**
+ * \brief 10 to the power N
+ */
+constexpr DecimalWide DecimalPower(
+	int N			/**< Power (0 to 38) */
+)
+{
+	DecimalWide Result = 1;
+
+	while (N-- > 0)
+	{
+		Result *= 10;
+	}
+	return Result;
+}
+
+/**
+ * \brief Divide, rounding half away from zero
+ */
+template <class T>
+inline T DecimalDivide(
+	T Numerator,		/**< Number to divide */
+	T Divisor		/**< Number to divide by (not zero) */
+)
+{
+	T Quotient = Numerator / Divisor;
+	T Remainder = Numerator % Divisor;
+
+	if (Remainder < 0)
+	{
+		Remainder = -Remainder;
+	}
+	if (Remainder * 2 >= ((Divisor < 0) ? -Divisor : Divisor))
+	{
+		Quotient += ((Numerator < 0) != (Divisor < 0)) ? -1 : 1;
+	}
+	return Quotient;
+}
+
+DecimalWide DecimalMulDiv(DecimalWide Left, DecimalWide Right,
+	DecimalWide Divisor);
+
+/**
+ * \brief Fixed point DECIMAL(P,S) number
+ */
+template <int P, int S>
+class Decimal
+{
+	static_assert((P >= 1) && (P <= 31), "DECIMAL precision is 1 to 31");
+	static_assert((S >= 0) && (S <= P), "DECIMAL scale is 0 to precision");
+
+public:
+	/**
+	 * \brief Type holding the scaled value
+	 */
+	typedef typename std::conditional<(P <= 18), int64_t, DecimalWide>::type Store;
+
+private:
+	Store Value;		/**< \brief Value times 10^S */
+
+	/**
+	 * \brief Make sure a scaled value fits in P digits
+	 */
+	static Store Check(DecimalWide Scaled)
+	{
+		if ((Scaled >= DecimalPower(P)) || (Scaled <= -DecimalPower(P)))
+		{
+			throw BasicError(ErrDecimalOverflow);
+		}
+		return (Store)Scaled;
+	}
+
+public:
+	//! Zero
+	Decimal() { Value = 0; }
+	//! From an integer
+	Decimal(int Number) { Value = Check((DecimalWide)Number * DecimalPower(S)); }
+	//! From an integer
+	Decimal(long Number) { Value = Check((DecimalWide)Number * DecimalPower(S)); }
+	//! From an integer
+	Decimal(long long Number) { Value = Check((DecimalWide)Number * DecimalPower(S)); }
+	//! From a floating point number (rounded to S places)
+	Decimal(double Number)
+	{
+		long double Scaled = roundl((long double)Number * (long double)DecimalPower(S));
+
+		if (!(fabsl(Scaled) < (long double)DecimalPower(P)))
+		{
+			throw BasicError(ErrDecimalOverflow);
+		}
+		Value = (Store)Scaled;
+	}
+	//! From another DECIMAL (rounded to S places)
+	template <int P2, int S2>
+	Decimal(const Decimal<P2, S2>& Other)
+	{
+		if (S2 > S)
+		{
+			Value = Check(DecimalDivide<DecimalWide>(Other.Scaled(),
+				DecimalPower(S2 - S)));
+		}
+		else
+		{
+			Value = Check((DecimalWide)Other.Scaled() * DecimalPower(S - S2));
+		}
+	}
+	//! From text, exactly (DATA, INPUT, VAL)
+	explicit Decimal(string_view Text) { Value = Check(Parse(Text)); }
+	//! From text, exactly (DATA, INPUT, VAL)
+	explicit Decimal(const char* Text) { Value = Check(Parse(Text)); }
+
+	/**
+	 * \brief Make one from an already scaled value
+	 */
+	static Decimal FromScaled(DecimalWide Scaled)
+	{
+		Decimal Result;
+		Result.Value = Check(Scaled);
+		return Result;
+	}
+
+	//! The value times 10^S
+	Store Scaled() const { return Value; }
+	//! Is it negative
+	bool Negative() const { return Value < 0; }
+	//! Convert to floating point
+	operator double() const
+		{ return (double)((long double)Value / (long double)DecimalPower(S)); }
+
+	//
+	// Arithmetic between DECIMALs of this size
+	//
+	//! Add
+	friend Decimal operator+(const Decimal& Left, const Decimal& Right)
+		{ return FromScaled((DecimalWide)Left.Value + Right.Value); }
+	//! Subtract
+	friend Decimal operator-(const Decimal& Left, const Decimal& Right)
+		{ return FromScaled((DecimalWide)Left.Value - Right.Value); }
+	//! Multiply (rounded to S places)
+	friend Decimal operator*(const Decimal& Left, const Decimal& Right)
+	{
+		Store Product;
+		DecimalWide WideProduct;
+
+		//
+		// Stay in the storage type when the product fits, so the
+		// division by the (constant) scale is cheap.
+		//
+		if (!__builtin_mul_overflow(Left.Value, Right.Value, &Product))
+		{
+			return FromScaled(DecimalDivide<Store>(Product,
+				(Store)DecimalPower(S)));
+		}
+		if (__builtin_mul_overflow((DecimalWide)Left.Value,
+			(DecimalWide)Right.Value, &WideProduct))
+		{
+			return FromScaled(DecimalMulDiv(Left.Value, Right.Value,
+				DecimalPower(S)));
+		}
+		return FromScaled(DecimalDivide<DecimalWide>(WideProduct,
+			DecimalPower(S)));
+	}
+	//! Divide (rounded to S places)
+	friend Decimal operator/(const Decimal& Left, const Decimal& Right)
+	{
+		Store Numerator;
+		DecimalWide WideNumerator;
+
+		if (Right.Value == 0)
+		{
+			throw BasicError(ErrDivideByZero);
+		}
+		if (!__builtin_mul_overflow(Left.Value, (Store)DecimalPower(S),
+			&Numerator))
+		{
+			return FromScaled(DecimalDivide<Store>(Numerator, Right.Value));
+		}
+		if (__builtin_mul_overflow((DecimalWide)Left.Value,
+			DecimalPower(S), &WideNumerator))
+		{
+			return FromScaled(DecimalMulDiv(Left.Value, DecimalPower(S),
+				Right.Value));
+		}
+		return FromScaled(DecimalDivide<DecimalWide>(WideNumerator,
+			Right.Value));
+	}
+	//! Negate
+	Decimal operator-() const { return FromScaled(-(DecimalWide)Value); }
+	//! Unary plus
+	Decimal operator+() const { return *this; }
+
+	//! +=
+	Decimal& operator+=(const Decimal& Right) { return *this = *this + Right; }
+	//! -=
+	Decimal& operator-=(const Decimal& Right) { return *this = *this - Right; }
+	//! *=
+	Decimal& operator*=(const Decimal& Right) { return *this = *this * Right; }
+	//! /=
+	Decimal& operator/=(const Decimal& Right) { return *this = *this / Right; }
+	//! Prefix ++
+	Decimal& operator++() { return *this += Decimal(1); }
+	//! Prefix --
+	Decimal& operator--() { return *this -= Decimal(1); }
+	//! Postfix ++
+	Decimal operator++(int) { Decimal Old = *this; ++*this; return Old; }
+	//! Postfix --
+	Decimal operator--(int) { Decimal Old = *this; --*this; return Old; }
+
+	//
+	// Comparisons
+	//
+	//! ==
+	friend bool operator==(const Decimal& Left, const Decimal& Right)
+		{ return Left.Value == Right.Value; }
+	//! !=
+	friend bool operator!=(const Decimal& Left, const Decimal& Right)
+		{ return Left.Value != Right.Value; }
+	//! <
+	friend bool operator<(const Decimal& Left, const Decimal& Right)
+		{ return Left.Value < Right.Value; }
+	//! >
+	friend bool operator>(const Decimal& Left, const Decimal& Right)
+		{ return Left.Value > Right.Value; }
+	//! <=
+	friend bool operator<=(const Decimal& Left, const Decimal& Right)
+		{ return Left.Value <= Right.Value; }
+	//! >=
+	friend bool operator>=(const Decimal& Left, const Decimal& Right)
+		{ return Left.Value >= Right.Value; }
+
+	/**
+	 * \brief Digits of the absolute value, without a decimal point
+	 *
+	 * Always has more than S digits, so there is at least a
+	 * '0' in front of the decimal point.
+	 */
+	std::string Digits() const
+	{
+		char Work[48];
+		char* Ptr = Work + sizeof(Work);
+		DecimalWide Number = Value;
+
+		if (Number < 0)
+		{
+			Number = -Number;
+		}
+		do
+		{
+			*--Ptr = '0' + (int)(Number % 10);
+			Number /= 10;
+		} while ((Number != 0) || (Work + sizeof(Work) - Ptr <= S));
+
+		return std::string(Ptr, Work + sizeof(Work) - Ptr);
+	}
+
+	/**
+	 * \brief Exact text of the number, without trailing zeros
+	 */
+	std::string str() const
+	{
+		std::string Result = Digits();
+
+		if (S > 0)
+		{
+			Result.insert(Result.size() - S, 1, '.');
+			Result.erase(Result.find_last_not_of('0') + 1);
+			if (Result.back() == '.')
+			{
+				Result.pop_back();
+			}
+		}
+		if (Value < 0)
+		{
+			Result.insert(0, 1, '-');
+		}
+		return Result;
+	}
+
+	/**
+	 * \brief Convert text to a value scaled by 10^S
+	 *
+	 * Extra places are rounded off. Bad text is a "Data format
+	 * error" (50).
+	 */
+	static DecimalWide Parse(string_view Text)
+	{
+		size_t Ptr = 0;
+		int Minus = 0;
+		int Places = -1;
+		int Seen = 0;
+		DecimalWide Result = 0;
+		int Round = 0;
+
+		while ((Ptr < Text.size()) && (Text[Ptr] == ' '))
+		{
+			Ptr++;
+		}
+		if ((Ptr < Text.size()) && ((Text[Ptr] == '-') || (Text[Ptr] == '+')))
+		{
+			Minus = (Text[Ptr++] == '-');
+		}
+		for (; Ptr < Text.size(); Ptr++)
+		{
+			char Ch = Text[Ptr];
+
+			if ((Ch == '.') && (Places < 0))
+			{
+				Places = 0;
+			}
+			else if ((Ch >= '0') && (Ch <= '9'))
+			{
+				Seen = 1;
+				if (Places < S)
+				{
+					if (Result >= DecimalPower(P))
+					{
+						throw BasicError(ErrDecimalOverflow);
+					}
+					Result = Result * 10 + (Ch - '0');
+					if (Places >= 0)
+					{
+						Places++;
+					}
+				}
+				else if (Places == S)
+				{
+					Round = (Ch >= '5');
+					Places++;
+				}
+			}
+			else
+			{
+				break;
+			}
+		}
+		while ((Ptr < Text.size()) && (Text[Ptr] == ' '))
+		{
+			Ptr++;
+		}
+		if (!Seen || (Ptr != Text.size()))
+		{
+			throw BasicError(ErrDataFormat);
+		}
+
+		if (Places < 0)
+		{
+			Places = 0;
+		}
+		if (Places > S)
+		{
+			Places = S;
+		}
+		Result = Result * DecimalPower(S - Places) + Round;
+		return Minus ? -Result : Result;
+	}
+
+	//! PRINT
+	friend std::ostream& operator<<(std::ostream& os, const Decimal& Number)
+		{ return os << Number.str(); }
+	//! INPUT
+	friend std::istream& operator>>(std::istream& is, Decimal& Number)
+	{
+		std::string Work;
+		is >> Work;
+		Number = Decimal(Work.c_str());
+		return is;
+	}
+};
+
+//
+// Mixing with integers keeps the result exact, mixing with floating
+// point gives a floating point result.
+//
+#define DECIMAL_MIXED(op) \
+template <int P, int S, class N, \
+	typename std::enable_if<std::is_integral<N>::value, int>::type = 0> \
+inline Decimal<P, S> operator op(const Decimal<P, S>& Left, N Right) \
+	{ return Left op Decimal<P, S>((long long)Right); } \
+template <int P, int S, class N, \
+	typename std::enable_if<std::is_integral<N>::value, int>::type = 0> \
+inline Decimal<P, S> operator op(N Left, const Decimal<P, S>& Right) \
+	{ return Decimal<P, S>((long long)Left) op Right; } \
+template <int P, int S, class N, \
+	typename std::enable_if<std::is_floating_point<N>::value, int>::type = 0> \
+inline double operator op(const Decimal<P, S>& Left, N Right) \
+	{ return (double)Left op (double)Right; } \
+template <int P, int S, class N, \
+	typename std::enable_if<std::is_floating_point<N>::value, int>::type = 0> \
+inline double operator op(N Left, const Decimal<P, S>& Right) \
+	{ return (double)Left op (double)Right; }
+
+DECIMAL_MIXED(+)
+DECIMAL_MIXED(-)
+DECIMAL_MIXED(*)
+DECIMAL_MIXED(/)
+#undef DECIMAL_MIXED
+
+#define DECIMAL_COMPARE(op) \
+template <int P, int S, class N, \
+	typename std::enable_if<std::is_integral<N>::value, int>::type = 0> \
+inline bool operator op(const Decimal<P, S>& Left, N Right) \
+	{ return Left op Decimal<P, S>((long long)Right); } \
+template <int P, int S, class N, \
+	typename std::enable_if<std::is_integral<N>::value, int>::type = 0> \
+inline bool operator op(N Left, const Decimal<P, S>& Right) \
+	{ return Decimal<P, S>((long long)Left) op Right; } \
+template <int P, int S, class N, \
+	typename std::enable_if<std::is_floating_point<N>::value, int>::type = 0> \
+inline bool operator op(const Decimal<P, S>& Left, N Right) \
+	{ return (double)Left op (double)Right; } \
+template <int P, int S, class N, \
+	typename std::enable_if<std::is_floating_point<N>::value, int>::type = 0> \
+inline bool operator op(N Left, const Decimal<P, S>& Right) \
+	{ return (double)Left op (double)Right; }
+
+DECIMAL_COMPARE(==)
+DECIMAL_COMPARE(!=)
+DECIMAL_COMPARE(<)
+DECIMAL_COMPARE(>)
+DECIMAL_COMPARE(<=)
+DECIMAL_COMPARE(>=)
+#undef DECIMAL_COMPARE
+
+/**
+ * \brief Size of the result of mixing two DECIMAL sizes
+ *
+ * Enough digits in front of the point for either of them,
+ * and as many places as the one with the most.
+ */
+template <int P1, int S1, int P2, int S2>
+struct DecimalCommon
+{
+	static const int Scale = (S1 > S2) ? S1 : S2;	/**< \brief Places */
+	static const int Whole = ((P1 - S1) > (P2 - S2)) ? (P1 - S1) : (P2 - S2);
+							/**< \brief Digits in front */
+	static const int Precision = (Whole + Scale > 31) ? 31 : Whole + Scale;
+							/**< \brief Total digits */
+	typedef Decimal<Precision, (Scale < Precision) ? Scale : Precision> Type;
+							/**< \brief Result type */
+};
+
+#define DECIMAL_SIZES(op) \
+template <int P1, int S1, int P2, int S2, \
+	typename std::enable_if<(P1 != P2) || (S1 != S2), int>::type = 0> \
+inline typename DecimalCommon<P1, S1, P2, S2>::Type operator op( \
+	const Decimal<P1, S1>& Left, const Decimal<P2, S2>& Right) \
+{ \
+	typedef typename DecimalCommon<P1, S1, P2, S2>::Type Common; \
+	return Common(Left) op Common(Right); \
+}
+
+DECIMAL_SIZES(+)
+DECIMAL_SIZES(-)
+DECIMAL_SIZES(*)
+DECIMAL_SIZES(/)
+#undef DECIMAL_SIZES
+
+#define DECIMAL_SIZES(op) \
+template <int P1, int S1, int P2, int S2, \
+	typename std::enable_if<(P1 != P2) || (S1 != S2), int>::type = 0> \
+inline bool operator op(const Decimal<P1, S1>& Left, const Decimal<P2, S2>& Right) \
+{ \
+	typedef typename DecimalCommon<P1, S1, P2, S2>::Type Common; \
+	return Common(Left) op Common(Right); \
+}
+
+DECIMAL_SIZES(==)
+DECIMAL_SIZES(!=)
+DECIMAL_SIZES(<)
+DECIMAL_SIZES(>)
+DECIMAL_SIZES(<=)
+DECIMAL_SIZES(>=)
+#undef DECIMAL_SIZES
+
+/**
+ * \brief Stored as packed decimal (DECIMAL in a MAP)
+ */
+template <int P, int S>
+struct PackedStorage
+{
+	static const size_t Size = P / 2 + 1;	/**< \brief Bytes used */
+
+	//! Fetch value
+	static Decimal<P, S> Get(const char* Data)
+	{
+		int Bad = 0;
+		typename Decimal<P, S>::Store Scaled =
+			PackedToInteger<typename Decimal<P, S>::Store>(Data, P, Bad);
+
+		if (Bad)
+		{
+			throw BasicError(ErrDataFormat);
+		}
+		return Decimal<P, S>::FromScaled(Scaled);
+	}
+	//! Store value
+	static void Put(char* Data, const Decimal<P, S>& Value)
+	{
+		int Bad = 0;
+
+		IntegerToPacked(Value.Scaled(), Data, P, Bad);
+		if (Bad)
+		{
+			throw BasicError(ErrDecimalOverflow);
+		}
+	}
+};
+
+/**
+ * \brief PRINT USING a DECIMAL, from its exact digits
+ */
+template <int P, int S>
+std::string PUsing::Output(const Decimal<P, S>& Value)
+{
+	return OutputDecimal(Value.Negative(), Value.Digits(), S);
+}
+
+//! FORMAT$(decimal,string)
+template <int P, int S>
+inline std::string Format(const Decimal<P, S>& Value, const std::string& Format)
+{
+	PUsing Puse(Format);
+	std::string One = Puse.Output(Value);
+	std::string Two = Puse.Finish();
+	return One + Two;
+}
+//! FORMAT$(decimal,char)
+template <int P, int S>
+inline std::string Format(const Decimal<P, S>& Value, const char* Format)
+{
+	PUsing Puse(Format);
+	std::string One = Puse.Output(Value);
+	std::string Two = Puse.Finish();
+	return One + Two;
+}
+
+//! STR$(decimal), NUM1$(decimal)
+template <int P, int S>
+inline std::string str(const Decimal<P, S>& Number)
+{
+	std::string Result = Number.str();
+	std::string::size_type Zero = (Result[0] == '-') ? 1 : 0;
+
+	//
+	// Drop the leading zero of "0.5" or "-0.5" only
+	//
+	if (Result.compare(Zero, 2, "0.") == 0)
+	{
+		Result.erase(Zero, 1);
+	}
+	return Result;
+}
+//! NUM1$(decimal)
+template <int P, int S>
+inline std::string Qnum1(const Decimal<P, S>& Number) { return str(Number); }
+//! NUM$(decimal)
+template <int P, int S>
+inline std::string Qnum(const Decimal<P, S>& Number)
+	{ return (Number.Negative() ? "" : " ") + str(Number) + " "; }
+}
+
+#endif
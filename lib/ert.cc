@@ -6,335 +6,371 @@
 //
 //	This is based on RSTS/E error numbers.
 //
+//	The messages are a constant table, so looking one up
+//	doesn't allocate anything.
 //
-#include <cstring>
-#include <cstdlib>
-#include "bstring.h"
+#include <string>
+#include "basicerror.h"
+
+//! A message in the table (the length is worked out at compile time)
+#define Message(x) basic::string_view(x, sizeof(x) - 1)
 
 //
 // The database
 //
 //! Database of error messages
-static const char* BasicErrorMessage[] =
+static constexpr basic::string_view BasicErrorMessage[] =
 {
-	"Unused",					// 0
-	"?Bad directory for device",			// 1
-	"?Illegal file name",				// 2
-	"?Account or device in use",			// 3
-	"?No room for user on device",			// 4
-	"?Can't find file or account",			// 5
-	"?Not a valid device",				// 6
-	"?I/O channel already open",			// 7
-	"?Device not available",			// 8
-	"?I/O channel not open",			// 9
-	"?Protection violation",			// 10
-	"?End of file on device",			// 11
-	"?Fatal system I/O failure",			// 12
-	"?User data error on device",			// 13
-	"?Device hung or write locked",			// 14
-	"?Wait exhausted",				// 15
-	"?Name or account now exists",			// 16
-	"?Too many open files on unit",			// 17
-	"?Illegal SYS() usage",				// 18
-	"?Disk block is interlocked",			// 19
-	"?Pack IDs don't match",			// 20
-	"?Disk pack is not mounted",			// 21
-	"?Disk pack is locked out",			// 22
-	"?Illegal cluster size",			// 23
-	"?Disk pack is private",			// 24
-	"?Disk pack needs 'CLEANing'",			// 25
-	"?Fatal disk pack mount error",			// 26
-	"?I/O to detached keyboard",			// 27
-	"?Programmable ^C trap",			// 28
-	"?Corrupted file structure",			// 29
-	"?Device not file-structured",			// 30
-	"?Illegal byte count for I/O",			// 31
-	"?No buffer space available",			// 32
-	"?Odd address trap",				// 33
-	"?Reserved instruction trap",			// 34
-	"?Memory management violation",			// 35
-	"?SP stack Overflow",				// 36
-	"?Disk error during swap",			// 37
-	"?Memory parity (or ECC) failure",		// 38
-	"?Magtape select error",			// 39
-	"?Magtape record length error",			// 40
-	"?Non-res run-time system",			// 41
-	"?Virtual buffer too large",			// 42
-	"?Virtual array not on disk",			// 43
-	"?Matrix or array too big",			// 44
-	"?Virtual array not yet open",			// 45
-	"?Illegal I/O channel",				// 46
-	"?Line too long",				// 47
-	"?Floating point error or overflow",		// 48
-	"?Argument too large in EXP",			// 49
-	"%Data format error",				// 50
-	"?Integer error or overflow",			// 51
-	"?Illegal number",				// 52
-	"?Illegal argument in LOG",			// 53
-	"?Imaginary square roots",			// 54
-	"?Subscript out of range",			// 55
-	"?Can't invert matrix",				// 56
-	"?Out of data",					// 57
-	"?ON statement out of range",			// 58
-	"?Not enough data in record",			// 59
-	"?Integer overflow, FOR loop",			// 60
-	"?Division by 0",				// 61
-	"?No run-time system",				// 62
-	"?FIELD overflows buffer",			// 63
-	"?Not a random access device",			// 64
-	"?Illegal MAGTAPE() usage",			// 65
-	"?Missing special feature",			// 66
-	"?Illegal switch usage",			// 67
-	"?Unused",					// 68
-	"?Unused",					// 69
-	"?Unused",					// 70
-	"?Statement not found",				// 71
-	"?RETURN without GOSUB",			// 72
-	"?FNEND without function call",			// 73
-	"?Undefined function called",			// 74
-	"?Illegal symbol",				// 75
-	"?Illegal verb",				// 76
-	"?Illegal expression",				// 77
-	"?Illegal mode mixing",				// 78
-	"?Illegal IF statement",			// 79
-	"?Illegal conditional clause",			// 80
-	"?Illegal function name",			// 81
-	"?Illegal dummy variable",			// 82
-	"?Illegal FN redefinition",			// 83
-	"?Illegal line number(s)",			// 84
-	"?Modifier error",				// 85
-	"?Can't compile statement",			// 86
-	"?Expression too complicated",			// 87
-	"?Arguments don't match",			// 88
-	"?Too many arguments",				// 89
-	"%Inconsistent function usage",			// 90
-	"?Illegal DEF nesting",				// 91
-	"?FOR without NEXT",				// 92
-	"?NEXT without FOR",				// 93
-	"?DEF without FNEND",				// 94
-	"?FNEND without DEF",				// 95
-	"?Literal string needed",			// 96
-	"?Too few arguments",				// 97
-	"?Syntax error",				// 98
-	"?String is needed",				// 99
-	"?Number is needed",				// 100
-	"?Data type error",				// 101
-	"?One or two dimensions only",			// 102
-	"?Internal error in Run-Time Library.",		// 103
-	"?RESUME and no error",				// 104
-	"?Redimensioned array",				// 105
-	"%Inconsistent subscript use",			// 106
-	"?ON statement needs GOTO",			// 107
-	"?End of statement not seen",			// 108
-	" What?",					// 109
-	"?Bad line number pair",			// 110
-	"?Not enough available memory",			// 111
-	"?Execute only file",				// 112
-	"?Please use the RUN command",			// 113
-	"?Can't CONTinue",				// 114
-	"?File exists-RENAME/REPLACE",			// 115
-	"?PRINT-USING format error",			// 116
-	"?Matrix or array without DIM",			// 117
-	"?Bad number in PRINT-USING",			// 118
-	"?Illegal in immediate mode",			// 119
-	"?PRINT-USING buffer overflow",			// 120
-	"?Illegal statement",				// 121
-	"?Illegal FIELD variable",			// 122
-	" Stop",					// 123
-	"?Matrix dimension error",			// 124
-	"?Wrong math package",				// 125
-	"?Maximum memory exceeded",			// 126
-	"?SCALE factor interlock",			// 127
-	"?Tape records not ANSI",			// 128
-	"?Tape BOT detected",				// 129
-	"?Key not changeable",				// 130
-	"?No current record",				// 131
-	"?Record has been deleted",			// 132
-	"?Illegal usage for device",			// 133
-	"?Duplicate key detected",			// 134
-	"?Illegal usage",				// 135
-	"?Illegal or illogical access",			// 136
-	"?Illegal key attributes",			// 137
-	"?File is locked",				// 138
-	"?Invalid file options",			// 139
-	"?Index not initialized",			// 140
-	"?Illegal operation",				// 141
-	"?Illegal record on file",			// 142
-	"?Bad record identifier",			// 143
-	"?Invalid key of reference",			// 144
-	"?Key size too large",				// 145
-	"?Tape not ANSI labelled",			// 146
-	"?RECORD number exceeds maximum",		// 147
-	"?Bad RECORDSIZE value on OPEN",		// 148
-	"?Not at end of file",				// 149
-	"?No primary key specified",			// 150
-	"?Key field beyond end of record",		// 151
-	"?Illogical record accessing",			// 152
-	"?Record already exists",			// 153
-	"?Record/bucket locked",			// 154
-	"?Record not found",				// 155
-	"?Size of record invalid",			// 156
-	"?Record on file too big",			// 157
-	"?Primary key out of sequence",			// 158
-	"?Key larger than record",			// 159
-	"?File attributes not matched",			// 160
-	"?Move overflows buffer",			// 161
-	"?Cannot open file",				// 162
-	"?No file name",				// 163
-	"?Terminal format file required",		// 164
-	"?Cannot position to EOF",			// 165
-	"?Negative fill or string length",		// 166
-	"?Illegal record format",			// 167
-	"?Illegal ALLOW clause",			// 168
-	"?Unused",					// 169
-	"?Index not fully optimized",			// 170
-	"?RRV not fully updated",			// 171
-	"?Record lock failed",				// 172
-	"?Invalid RFA field",				// 173
-	"?File expiration date not yet reached",	// 174
-	"?Node name error",				// 175
-	"%Negative or zero TAB",			// 176
-	"%Too much data in record",			// 177
-	"?System memory for file sharing exhausted",	// 178
-	"?Unexpired file date",				// 179
-	"?No support for operation in task",		// 180
-	"?Decimal error or overflow",			// 181
-	"?Network operation rejected",			// 182
-	"?REMAP overflows buffer",			// 183
-	"?Unaligned REMAP variable",			// 184
-	"?RECORDSIZE overflows MAP buffer",		// 185
-	"?Improper error handling",			// 186
-	"?Illegal record locking clause",		// 187
-	"?UNLOCK EXPLICIT requires RECORDSIZE 512",	// 188
-	"%Too little data in record",			// 189
-	"?Illegal network operation",			// 190
-	"?Illegal terminal-format file operation",	// 191
-	"?Illegal wait value",				// 192
-	"?Detected deadlock while waiting for GET or FIND",// 193
-	"?Not a BASIC error",				// 194
-	"?Dimension number out of range",		// 195
-	"?REMAP string is not static",			// 196
-	"?Array too small",				// 197
-	"?Unused",					// 198
-	"?Unused",					// 199
-	"?Unused",					// 200
-	"?Unused",					// 201
-	"?Unused",					// 202
-	"?Unused",					// 203
-	"?Unused",					// 204
-	"?Unused",					// 205
-	"?Unused",					// 206
-	"?Unused",					// 207
-	"?Unused",					// 208
-	"?Unused",					// 209
-	"?Unused",					// 210
-	"?Unused",					// 211
-	"?Unused",					// 212
-	"?Unused",					// 213
-	"?Unused",					// 214
-	"?Unused",					// 215
-	"?Unused",					// 216
-	"?Unused",					// 217
-	"?Unused",					// 218
-	"?Unused",					// 219
-	"?Unused",					// 220
-	"?Unused",					// 221
-	"?Unused",					// 222
-	"?Unused",					// 223
-	"?Unused",					// 224
-	"?Unused",					// 225
-	"?VAX GKS is not installed",			// 226
-	"?String too long",				// 227
-	"?Record attributes not matched",		// 228
-	"?Differing use of LONG/WORD or SINGLE/DOUBLE qualifiers",// 229
-	"?No fields in image",				// 230
-	"?Illegal string image",			// 231
-	"?Null image",					// 232
-	"?Illegal numeric image",			// 233
-	"?Numeric image for string",			// 234
-	"?String image for numeric",			// 235
-	"?TIME limit exceeded",				// 236
-	"?First arg to SEG$ greater than second",	// 237
-	"?Arrays must be same dimension",		// 238
-	"?Arrays must be square",			// 239
-	"?Cannot change array dimensions",		// 240
-	"?Floating overflow",				// 241
-	"?Floating underflow",				// 242
-	"?CHAIN to non-existent line number",		// 243
-	"?Exponentiation error",			// 244
-	"?Illegal exit from DEF*",			// 245
-	"?ERROR trap needs RESUME",			// 246
-	"?Illegal RESUME to subroutine",		// 247
-	"?Illegal return from subroutine",		// 248
-	"?Argument out of bounds",			// 249
-	"?Not implemented",				// 250
-	"?Recursive subroutine call",			// 251
-	"?FILE ACP failure",				// 252
-	"?Directive error",				// 253
-	"?Unused",					// 254
-	"?Unused",					// 255
-	"?Prompt/echo type not supported",		// 256
-	"?Illegal transformation number",		// 257
-	"?Illegal picture operation",			// 258
-	"?Clipping must be set to \"ON\" or \"OFF\"",	// 259
-	"?Transformation numbers are not different",	// 260
-	"?Color indices are not contiguous",		// 261
-	"?Illegal area style",				// 262
-	"?Illegal text justification",			// 263
-	"?Illegal text precision",			// 264
-	"?Illegal text path",				// 265
-	"?Illegal device identification number",	// 266
-	"?Device type is not supported",		// 267
-	"?Device is not open",				// 268
-	"?Device is an output metafile",		// 269
-	"?Device is an input metafile",			// 270
-	"?Unused",					// 271
-	"?Device and operation are incompatible",	// 272
-	"?Coordinates are not within NDC space",	// 273
-	"?Illegal line style",				// 274
-	"?Illegal line size",				// 275
-	"?Illegal point style",				// 276
-	"?Illegal text width to height ratio",		// 277
-	"?Illegal text height",				// 278
-	"?Illegal area style index",			// 279
-	"?Illegal color index",				// 280
-	"?Number of coordinates is insufficient",	// 281
-	"?Unit number is not defined for the device",	// 282
-	"?Illegal echo area",				// 283
-	"?Illegal initial value",			// 284
-	"?Entered points not within a transformation",	// 285
-	"?Unknown GKS error",				// 286
-	"?Invalid character in string",			// 287
-	"?String length is zero",			// 288
-	"?Data overflow",				// 289
-	"?Illegal count clause",			// 290
-	"?Illegal color mix",				// 291
-	"?Illegal device name in OPEN",			// 292
-	"?User aborted input.  Locate point cancelled",	// 293
-	"?Unused",					// 294
-	"?Unused",					// 295
-	"?Unused",					// 296
-	"?Unused",					// 297
-	"?Unused",					// 298
-	"?Unused",					// 299
-	"?Unused"					// 300
+	Message("Unused"),					// 0
+	Message("?Bad directory for device"),			// 1
+	Message("?Illegal file name"),				// 2
+	Message("?Account or device in use"),			// 3
+	Message("?No room for user on device"),			// 4
+	Message("?Can't find file or account"),			// 5
+	Message("?Not a valid device"),				// 6
+	Message("?I/O channel already open"),			// 7
+	Message("?Device not available"),			// 8
+	Message("?I/O channel not open"),			// 9
+	Message("?Protection violation"),			// 10
+	Message("?End of file on device"),			// 11
+	Message("?Fatal system I/O failure"),			// 12
+	Message("?User data error on device"),			// 13
+	Message("?Device hung or write locked"),		// 14
+	Message("?Wait exhausted"),				// 15
+	Message("?Name or account now exists"),			// 16
+	Message("?Too many open files on unit"),		// 17
+	Message("?Illegal SYS() usage"),			// 18
+	Message("?Disk block is interlocked"),			// 19
+	Message("?Pack IDs don't match"),			// 20
+	Message("?Disk pack is not mounted"),			// 21
+	Message("?Disk pack is locked out"),			// 22
+	Message("?Illegal cluster size"),			// 23
+	Message("?Disk pack is private"),			// 24
+	Message("?Disk pack needs 'CLEANing'"),			// 25
+	Message("?Fatal disk pack mount error"),		// 26
+	Message("?I/O to detached keyboard"),			// 27
+	Message("?Programmable ^C trap"),			// 28
+	Message("?Corrupted file structure"),			// 29
+	Message("?Device not file-structured"),			// 30
+	Message("?Illegal byte count for I/O"),			// 31
+	Message("?No buffer space available"),			// 32
+	Message("?Odd address trap"),				// 33
+	Message("?Reserved instruction trap"),			// 34
+	Message("?Memory management violation"),		// 35
+	Message("?SP stack Overflow"),				// 36
+	Message("?Disk error during swap"),			// 37
+	Message("?Memory parity (or ECC) failure"),		// 38
+	Message("?Magtape select error"),			// 39
+	Message("?Magtape record length error"),		// 40
+	Message("?Non-res run-time system"),			// 41
+	Message("?Virtual buffer too large"),			// 42
+	Message("?Virtual array not on disk"),			// 43
+	Message("?Matrix or array too big"),			// 44
+	Message("?Virtual array not yet open"),			// 45
+	Message("?Illegal I/O channel"),			// 46
+	Message("?Line too long"),				// 47
+	Message("?Floating point error or overflow"),		// 48
+	Message("?Argument too large in EXP"),			// 49
+	Message("%Data format error"),				// 50
+	Message("?Integer error or overflow"),			// 51
+	Message("?Illegal number"),				// 52
+	Message("?Illegal argument in LOG"),			// 53
+	Message("?Imaginary square roots"),			// 54
+	Message("?Subscript out of range"),			// 55
+	Message("?Can't invert matrix"),			// 56
+	Message("?Out of data"),				// 57
+	Message("?ON statement out of range"),			// 58
+	Message("?Not enough data in record"),			// 59
+	Message("?Integer overflow, FOR loop"),			// 60
+	Message("?Division by 0"),				// 61
+	Message("?No run-time system"),				// 62
+	Message("?FIELD overflows buffer"),			// 63
+	Message("?Not a random access device"),			// 64
+	Message("?Illegal MAGTAPE() usage"),			// 65
+	Message("?Missing special feature"),			// 66
+	Message("?Illegal switch usage"),			// 67
+	Message("?Unused"),					// 68
+	Message("?Unused"),					// 69
+	Message("?Unused"),					// 70
+	Message("?Statement not found"),			// 71
+	Message("?RETURN without GOSUB"),			// 72
+	Message("?FNEND without function call"),		// 73
+	Message("?Undefined function called"),			// 74
+	Message("?Illegal symbol"),				// 75
+	Message("?Illegal verb"),				// 76
+	Message("?Illegal expression"),				// 77
+	Message("?Illegal mode mixing"),			// 78
+	Message("?Illegal IF statement"),			// 79
+	Message("?Illegal conditional clause"),			// 80
+	Message("?Illegal function name"),			// 81
+	Message("?Illegal dummy variable"),			// 82
+	Message("?Illegal FN redefinition"),			// 83
+	Message("?Illegal line number(s)"),			// 84
+	Message("?Modifier error"),				// 85
+	Message("?Can't compile statement"),			// 86
+	Message("?Expression too complicated"),			// 87
+	Message("?Arguments don't match"),			// 88
+	Message("?Too many arguments"),				// 89
+	Message("%Inconsistent function usage"),		// 90
+	Message("?Illegal DEF nesting"),			// 91
+	Message("?FOR without NEXT"),				// 92
+	Message("?NEXT without FOR"),				// 93
+	Message("?DEF without FNEND"),				// 94
+	Message("?FNEND without DEF"),				// 95
+	Message("?Literal string needed"),			// 96
+	Message("?Too few arguments"),				// 97
+	Message("?Syntax error"),				// 98
+	Message("?String is needed"),				// 99
+	Message("?Number is needed"),				// 100
+	Message("?Data type error"),				// 101
+	Message("?One or two dimensions only"),			// 102
+	Message("?Internal error in Run-Time Library."),	// 103
+	Message("?RESUME and no error"),			// 104
+	Message("?Redimensioned array"),			// 105
+	Message("%Inconsistent subscript use"),			// 106
+	Message("?ON statement needs GOTO"),			// 107
+	Message("?End of statement not seen"),			// 108
+	Message(" What?"),					// 109
+	Message("?Bad line number pair"),			// 110
+	Message("?Not enough available memory"),		// 111
+	Message("?Execute only file"),				// 112
+	Message("?Please use the RUN command"),			// 113
+	Message("?Can't CONTinue"),				// 114
+	Message("?File exists-RENAME/REPLACE"),			// 115
+	Message("?PRINT-USING format error"),			// 116
+	Message("?Matrix or array without DIM"),		// 117
+	Message("?Bad number in PRINT-USING"),			// 118
+	Message("?Illegal in immediate mode"),			// 119
+	Message("?PRINT-USING buffer overflow"),		// 120
+	Message("?Illegal statement"),				// 121
+	Message("?Illegal FIELD variable"),			// 122
+	Message(" Stop"),					// 123
+	Message("?Matrix dimension error"),			// 124
+	Message("?Wrong math package"),				// 125
+	Message("?Maximum memory exceeded"),			// 126
+	Message("?SCALE factor interlock"),			// 127
+	Message("?Tape records not ANSI"),			// 128
+	Message("?Tape BOT detected"),				// 129
+	Message("?Key not changeable"),				// 130
+	Message("?No current record"),				// 131
+	Message("?Record has been deleted"),			// 132
+	Message("?Illegal usage for device"),			// 133
+	Message("?Duplicate key detected"),			// 134
+	Message("?Illegal usage"),				// 135
+	Message("?Illegal or illogical access"),		// 136
+	Message("?Illegal key attributes"),			// 137
+	Message("?File is locked"),				// 138
+	Message("?Invalid file options"),			// 139
+	Message("?Index not initialized"),			// 140
+	Message("?Illegal operation"),				// 141
+	Message("?Illegal record on file"),			// 142
+	Message("?Bad record identifier"),			// 143
+	Message("?Invalid key of reference"),			// 144
+	Message("?Key size too large"),				// 145
+	Message("?Tape not ANSI labelled"),			// 146
+	Message("?RECORD number exceeds maximum"),		// 147
+	Message("?Bad RECORDSIZE value on OPEN"),		// 148
+	Message("?Not at end of file"),				// 149
+	Message("?No primary key specified"),			// 150
+	Message("?Key field beyond end of record"),		// 151
+	Message("?Illogical record accessing"),			// 152
+	Message("?Record already exists"),			// 153
+	Message("?Record/bucket locked"),			// 154
+	Message("?Record not found"),				// 155
+	Message("?Size of record invalid"),			// 156
+	Message("?Record on file too big"),			// 157
+	Message("?Primary key out of sequence"),		// 158
+	Message("?Key larger than record"),			// 159
+	Message("?File attributes not matched"),		// 160
+	Message("?Move overflows buffer"),			// 161
+	Message("?Cannot open file"),				// 162
+	Message("?No file name"),				// 163
+	Message("?Terminal format file required"),		// 164
+	Message("?Cannot position to EOF"),			// 165
+	Message("?Negative fill or string length"),		// 166
+	Message("?Illegal record format"),			// 167
+	Message("?Illegal ALLOW clause"),			// 168
+	Message("?Unused"),					// 169
+	Message("?Index not fully optimized"),			// 170
+	Message("?RRV not fully updated"),			// 171
+	Message("?Record lock failed"),				// 172
+	Message("?Invalid RFA field"),				// 173
+	Message("?File expiration date not yet reached"),	// 174
+	Message("?Node name error"),				// 175
+	Message("%Negative or zero TAB"),			// 176
+	Message("%Too much data in record"),			// 177
+	Message("?System memory for file sharing exhausted"),	// 178
+	Message("?Unexpired file date"),			// 179
+	Message("?No support for operation in task"),		// 180
+	Message("?Decimal error or overflow"),			// 181
+	Message("?Network operation rejected"),			// 182
+	Message("?REMAP overflows buffer"),			// 183
+	Message("?Unaligned REMAP variable"),			// 184
+	Message("?RECORDSIZE overflows MAP buffer"),		// 185
+	Message("?Improper error handling"),			// 186
+	Message("?Illegal record locking clause"),		// 187
+	Message("?UNLOCK EXPLICIT requires RECORDSIZE 512"),	// 188
+	Message("%Too little data in record"),			// 189
+	Message("?Illegal network operation"),			// 190
+	Message("?Illegal terminal-format file operation"),	// 191
+	Message("?Illegal wait value"),				// 192
+	Message("?Detected deadlock while waiting for GET or FIND"),// 193
+	Message("?Not a BASIC error"),				// 194
+	Message("?Dimension number out of range"),		// 195
+	Message("?REMAP string is not static"),			// 196
+	Message("?Array too small"),				// 197
+	Message("?Unused"),					// 198
+	Message("?Unused"),					// 199
+	Message("?Unused"),					// 200
+	Message("?Unused"),					// 201
+	Message("?Unused"),					// 202
+	Message("?Unused"),					// 203
+	Message("?Unused"),					// 204
+	Message("?Unused"),					// 205
+	Message("?Unused"),					// 206
+	Message("?Unused"),					// 207
+	Message("?Unused"),					// 208
+	Message("?Unused"),					// 209
+	Message("?Unused"),					// 210
+	Message("?Unused"),					// 211
+	Message("?Unused"),					// 212
+	Message("?Unused"),					// 213
+	Message("?Unused"),					// 214
+	Message("?Unused"),					// 215
+	Message("?Unused"),					// 216
+	Message("?Unused"),					// 217
+	Message("?Unused"),					// 218
+	Message("?Unused"),					// 219
+	Message("?Unused"),					// 220
+	Message("?Unused"),					// 221
+	Message("?Unused"),					// 222
+	Message("?Unused"),					// 223
+	Message("?Unused"),					// 224
+	Message("?Unused"),					// 225
+	Message("?VAX GKS is not installed"),			// 226
+	Message("?String too long"),				// 227
+	Message("?Record attributes not matched"),		// 228
+	Message("?Differing use of LONG/WORD or SINGLE/DOUBLE qualifiers"),// 229
+	Message("?No fields in image"),				// 230
+	Message("?Illegal string image"),			// 231
+	Message("?Null image"),					// 232
+	Message("?Illegal numeric image"),			// 233
+	Message("?Numeric image for string"),			// 234
+	Message("?String image for numeric"),			// 235
+	Message("?TIME limit exceeded"),			// 236
+	Message("?First arg to SEG$ greater than second"),	// 237
+	Message("?Arrays must be same dimension"),		// 238
+	Message("?Arrays must be square"),			// 239
+	Message("?Cannot change array dimensions"),		// 240
+	Message("?Floating overflow"),				// 241
+	Message("?Floating underflow"),				// 242
+	Message("?CHAIN to non-existent line number"),		// 243
+	Message("?Exponentiation error"),			// 244
+	Message("?Illegal exit from DEF*"),			// 245
+	Message("?ERROR trap needs RESUME"),			// 246
+	Message("?Illegal RESUME to subroutine"),		// 247
+	Message("?Illegal return from subroutine"),		// 248
+	Message("?Argument out of bounds"),			// 249
+	Message("?Not implemented"),				// 250
+	Message("?Recursive subroutine call"),			// 251
+	Message("?FILE ACP failure"),				// 252
+	Message("?Directive error"),				// 253
+	Message("?Unused"),					// 254
+	Message("?Unused"),					// 255
+	Message("?Prompt/echo type not supported"),		// 256
+	Message("?Illegal transformation number"),		// 257
+	Message("?Illegal picture operation"),			// 258
+	Message("?Clipping must be set to \"ON\" or \"OFF\""),	// 259
+	Message("?Transformation numbers are not different"),	// 260
+	Message("?Color indices are not contiguous"),		// 261
+	Message("?Illegal area style"),				// 262
+	Message("?Illegal text justification"),			// 263
+	Message("?Illegal text precision"),			// 264
+	Message("?Illegal text path"),				// 265
+	Message("?Illegal device identification number"),	// 266
+	Message("?Device type is not supported"),		// 267
+	Message("?Device is not open"),				// 268
+	Message("?Device is an output metafile"),		// 269
+	Message("?Device is an input metafile"),		// 270
+	Message("?Unused"),					// 271
+	Message("?Device and operation are incompatible"),	// 272
+	Message("?Coordinates are not within NDC space"),	// 273
+	Message("?Illegal line style"),				// 274
+	Message("?Illegal line size"),				// 275
+	Message("?Illegal point style"),			// 276
+	Message("?Illegal text width to height ratio"),		// 277
+	Message("?Illegal text height"),			// 278
+	Message("?Illegal area style index"),			// 279
+	Message("?Illegal color index"),			// 280
+	Message("?Number of coordinates is insufficient"),	// 281
+	Message("?Unit number is not defined for the device"),	// 282
+	Message("?Illegal echo area"),				// 283
+	Message("?Illegal initial value"),			// 284
+	Message("?Entered points not within a transformation"),	// 285
+	Message("?Unknown GKS error"),				// 286
+	Message("?Invalid character in string"),		// 287
+	Message("?String length is zero"),			// 288
+	Message("?Data overflow"),				// 289
+	Message("?Illegal count clause"),			// 290
+	Message("?Illegal color mix"),				// 291
+	Message("?Illegal device name in OPEN"),		// 292
+	Message("?User aborted input.  Locate point cancelled"),	// 293
+	Message("?Unused"),					// 294
+	Message("?Unused"),					// 295
+	Message("?Unused"),					// 296
+	Message("?Unused"),					// 297
+	Message("?Unused"),					// 298
+	Message("?Unused"),					// 299
+	Message("?Unused")					// 300
 };
 
+static_assert(sizeof(BasicErrorMessage) / sizeof(BasicErrorMessage[0]) ==
+	basic::ErrMaximum + 1, "An error message is missing");
+
 /*! Return error message
 
 	Returns the text of an error message when given the error number
+	\return Text of the error message
+*/
+basic::string_view basic::ErrorText(
+	long error	//!< Error number
+)
+{
+	if ((error >= 0) && (error <= ErrMaximum))
+	{
+		return BasicErrorMessage[error];
+	}
+	return BasicErrorMessage[ErrMaximum];
+}
+
+/*! ERT$
+
+	Returns the text of an error message when given the error number.
+	The strings are built the first time ERT$ is used, and shared
+	after that.
 	\return String containing error message
 */
-std::string& basic::ert(
+const std::string& basic::ert(
 	long error	//!< Error number
 )
 {
-	const char* Text = "?Unused";
+	struct MessageStrings
+	{
+		std::string Text[ErrMaximum + 1];
+
+		MessageStrings()
+		{
+			for (int loop = 0; loop <= ErrMaximum; loop++)
+			{
+				Text[loop] = BasicErrorMessage[loop].to_string();
+			}
+		}
+	};
+	static const MessageStrings Strings;
 
-	if ((error >= 0) && (error <= 300))
+	if ((error >= 0) && (error <= ErrMaximum))
 	{
-		Text = BasicErrorMessage[error];
+		return Strings.Text[error];
 	}
-	std::string* Result = new std::string(Text);
-	return *Result;
+	return Strings.Text[ErrMaximum];
 }
@@ -0,0 +1,384 @@
+/** \file keyboard.cc
+ * \brief Single key input from the terminal
+ */
+
+//
+// Include files
+//
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <poll.h>
+#include <unistd.h>
+
+#include "keyboard.h"
+
+/**
+ * \brief How long to wait for the rest of an escape sequence
+ *
+ *	A terminal sends a whole sequence at once, so if nothing
+ *	follows an ESC in this many milliseconds, it was the
+ *	escape key by itself.
+ */
+static const int EscapeWait = 50;
+
+/**
+ * \brief Raw mode, while a key is being read
+ *
+ *	The terminal is put back the way it was afterwards, so
+ *	INPUT and LINPUT still see a normal line mode terminal.
+ *	Carriage return and line feed are passed through as they
+ *	are, rather than turned into each other. Changes are
+ *	made with TCSANOW rather than TCSAFLUSH, which would
+ *	throw away anything typed ahead.
+ */
+class RawMode
+{
+private:
+	int Fd;			/**< \brief Terminal */
+	int Changed;		/**< \brief Was it changed */
+	struct termios Saved;	/**< \brief Original settings */
+
+public:
+	/**
+	 * \brief Switch to raw mode (if it is a terminal)
+	 */
+	explicit RawMode(
+		int NewFd		/**< Terminal */
+	)
+	{
+		Fd = NewFd;
+		Changed = 0;
+		if (isatty(Fd) && (tcgetattr(Fd, &Saved) == 0))
+		{
+			struct termios Raw = Saved;
+
+			Raw.c_lflag &= ~(ICANON | ECHO);
+			Raw.c_iflag &= ~(ICRNL | INLCR);	// Return reads as 13
+			Raw.c_cc[VMIN] = 1;
+			Raw.c_cc[VTIME] = 0;
+			Changed = (tcsetattr(Fd, TCSANOW, &Raw) == 0);
+		}
+	}
+
+	/**
+	 * \brief Put the terminal back
+	 */
+	~RawMode()
+	{
+		if (Changed)
+		{
+			tcsetattr(Fd, TCSANOW, &Saved);
+		}
+	}
+};
+
+/**
+ * \brief Read whatever has been typed into the type-ahead buffer
+ *
+ * \return 1 if something was read, 0 on a timeout, -1 at end
+ *	of file (or an error).
+ */
+int basic::Keyboard::Fill(
+	int Timeout		/**< Milliseconds to wait, -1 for ever */
+)
+{
+	if (Head == Tail)
+	{
+		Head = Tail = 0;
+	}
+	else if (Tail == sizeof(Buffer))
+	{
+		memmove(Buffer, Buffer + Head, Tail - Head);
+		Tail -= Head;
+		Head = 0;
+	}
+
+	std::chrono::steady_clock::time_point Deadline =
+		std::chrono::steady_clock::now() +
+		std::chrono::milliseconds(Timeout);
+	struct pollfd Wait;
+
+	Wait.fd = Fd;
+	Wait.events = POLLIN;
+
+	while (true)
+	{
+		int Left = Timeout;
+
+		if (Timeout > 0)
+		{
+			Left = std::chrono::duration_cast<std::chrono::milliseconds>(
+				Deadline - std::chrono::steady_clock::now()).count();
+			if (Left < 0)
+			{
+				Left = 0;
+			}
+		}
+
+		int Ready = poll(&Wait, 1, Left);
+
+		if (Ready == 0)
+		{
+			return 0;
+		}
+		if (Ready < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return -1;
+		}
+
+		ssize_t Count = read(Fd, Buffer + Tail, sizeof(Buffer) - Tail);
+
+		if (Count > 0)
+		{
+			Tail += Count;
+			return 1;
+		}
+		if ((Count < 0) && ((errno == EINTR) || (errno == EAGAIN)))
+		{
+			continue;
+		}
+		return -1;
+	}
+}
+
+/**
+ * \brief Wait (briefly) for the next byte of a sequence
+ *
+ * \return Non-zero if there is one
+ */
+int basic::Keyboard::Pending(
+	int Timeout		/**< Milliseconds to wait */
+)
+{
+	return (Head < Tail) || (Fill(Timeout) > 0);
+}
+
+/**
+ * \brief Decode what follows an ESC
+ *
+ *	Handles the VT100/VT220 sequences (and xterm's versions of
+ *	them) for the arrow, keypad, editing and function keys.
+ *	Anything else after an ESC is left to be read as keys
+ *	of its own.
+ */
+int basic::Keyboard::Escape()
+{
+	if (!Pending(EscapeWait) ||
+		((Buffer[Head] != '[') && (Buffer[Head] != 'O')))
+	{
+		return KeyEscape;
+	}
+
+	unsigned char Introducer = Buffer[Head++];
+
+	if (Introducer == 'O')
+	{
+		//
+		// SS3: keypad in application mode, and PF1-PF4
+		//
+		if (!Pending(EscapeWait))
+		{
+			return KeyUnknown;
+		}
+
+		unsigned char Final = Buffer[Head++];
+
+		switch (Final)
+		{
+		case 'A':	return KeyUp;
+		case 'B':	return KeyDown;
+		case 'C':	return KeyRight;
+		case 'D':	return KeyLeft;
+		case 'M':	return KeyEnter;
+		case 'l':	return KeyComma;
+		case 'm':	return KeyMinus;
+		case 'n':	return KeyPeriod;
+		}
+		if ((Final >= 'P') && (Final <= 'S'))
+		{
+			return KeyPF1 + (Final - 'P');
+		}
+		if ((Final >= 'p') && (Final <= 'y'))
+		{
+			return KeyKP0 + (Final - 'p');
+		}
+		return KeyUnknown;
+	}
+
+	//
+	// CSI: a number (possibly followed by ;modifiers) and a
+	// final character
+	//
+	int Number = 0;
+	int InNumber = 1;
+
+	while (true)
+	{
+		if (!Pending(EscapeWait))
+		{
+			return KeyUnknown;
+		}
+
+		unsigned char Final = Buffer[Head++];
+
+		if ((Final >= '0') && (Final <= '9'))
+		{
+			if (InNumber && (Number < 1000))
+			{
+				Number = Number * 10 + (Final - '0');
+			}
+			continue;
+		}
+		if (Final == ';')
+		{
+			InNumber = 0;
+			continue;
+		}
+
+		switch (Final)
+		{
+		case 'A':	return KeyUp;
+		case 'B':	return KeyDown;
+		case 'C':	return KeyRight;
+		case 'D':	return KeyLeft;
+		case 'P':	return KeyPF1;
+		case 'Q':	return KeyPF1 + 1;
+		case 'R':	return KeyPF1 + 2;
+		case 'S':	return KeyPF1 + 3;
+		case '~':	break;
+		default:	return KeyUnknown;
+		}
+
+		//
+		// ESC [ n ~
+		//
+		if ((Number >= 1) && (Number <= 6))
+		{
+			return KeyFind + (Number - 1);
+		}
+		if ((Number >= 11) && (Number <= 14))
+		{
+			return KeyPF1 + (Number - 11);
+		}
+		if ((Number >= 17) && (Number <= 21))
+		{
+			return KeyF6 + (Number - 17);
+		}
+		if ((Number >= 23) && (Number <= 26))
+		{
+			return KeyF6 + 5 + (Number - 23);
+		}
+		if (Number == 28)
+		{
+			return KeyHelp;
+		}
+		if (Number == 29)
+		{
+			return KeyDo;
+		}
+		if ((Number >= 31) && (Number <= 34))
+		{
+			return KeyF17 + (Number - 31);
+		}
+		return KeyUnknown;
+	}
+}
+
+/**
+ * \brief Take the next key from the type-ahead buffer
+ */
+int basic::Keyboard::Next()
+{
+	unsigned char Key = Buffer[Head++];
+
+	if (Key == 27)
+	{
+		return Escape();
+	}
+	return Key;
+}
+
+/**
+ * \brief Read one key
+ *
+ * \return The character typed, one of the KeyCode values for
+ *	other keys, KeyTimeout if nothing was typed in time,
+ *	or KeyCancelled at end of file.
+ */
+int basic::Keyboard::Read(
+	int Timeout		/**< Milliseconds to wait, -1 for ever */
+)
+{
+	RawMode Raw(Fd);
+
+	if (Head == Tail)
+	{
+		switch (Fill(Timeout))
+		{
+		case 0:
+			return KeyTimeout;
+		case -1:
+			return KeyCancelled;
+		}
+	}
+	return Next();
+}
+
+/**
+ * \brief Keyboard for the job's terminal
+ */
+basic::Keyboard& basic::TerminalKeyboard()
+{
+	static Keyboard Terminal(0);
+	return Terminal;
+}
+
+/**
+ * \brief Name of a key, as returned by INKEY$
+ *
+ *	An ordinary key is the character itself, and the others are
+ *	the name of the key (the SMG$K_TRM_ name without the prefix).
+ */
+std::string basic::KeyName(
+	int Code		/**< Key code */
+)
+{
+	static const char* const Names[] =
+	{
+		"PF1", "PF2", "PF3", "PF4",				// 256
+		"KP0", "KP1", "KP2", "KP3", "KP4",			// 260
+		"KP5", "KP6", "KP7", "KP8", "KP9",			// 265
+		"ENTER", "MINUS", "COMMA", "PERIOD",			// 270
+		"UP", "DOWN", "LEFT", "RIGHT",				// 274
+		"", "", "", "", "",					// 278
+		"", "", "", "F6", "F7", "F8", "F9", "F10",		// 283
+		"F11", "F12", "F13", "F14", "HELP", "DO",		// 291
+		"F17", "F18", "F19", "F20"				// 297
+	};
+
+	if ((Code >= 0) && (Code < 256))
+	{
+		return std::string(1, (char)Code);
+	}
+	if ((Code >= KeyPF1) && (Code <= KeyF17 + 3))
+	{
+		return Names[Code - KeyPF1];
+	}
+
+	switch (Code)
+	{
+	case KeyFind:		return "FIND";
+	case KeyInsertHere:	return "INSERT_HERE";
+	case KeyRemove:		return "REMOVE";
+	case KeySelect:		return "SELECT";
+	case KeyPrevScreen:	return "PREV_SCREEN";
+	case KeyNextScreen:	return "NEXT_SCREEN";
+	}
+	return "UNKNOWN";
+}
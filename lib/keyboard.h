@@ -0,0 +1,102 @@
+/**\file keyboard.h
+ * \brief Single key input from the terminal
+ *
+ *	Used by INKEY$ and smg$read_keystroke. Keys are read with the
+ *	terminal in raw mode, one at a time, waiting in poll() so an
+ *	idle program sleeps instead of spinning. Escape sequences
+ *	from the cursor, keypad and function keys are turned into
+ *	key codes.
+ */
+#ifndef _KEYBOARD_H_
+#define _KEYBOARD_H_
+
+//
+// include files
+//
+#include <string>
+#include <termios.h>
+
+namespace basic
+{
+/**
+ * \brief Codes for keys that aren't a single character
+ *
+ *	The same values as the SMG$K_TRM_ codes in smgdef.h.
+ *	Ordinary keys are their character code.
+ */
+enum KeyCode
+{
+	KeyEscape = 27,			/**< \brief Escape on its own */
+	KeyPF1 = 256,			/**< \brief PF1 (F1 on a PC) */
+	KeyKP0 = 260,			/**< \brief Keypad 0 (to 269 for 9) */
+	KeyEnter = 270,			/**< \brief Keypad ENTER */
+	KeyMinus = 271,			/**< \brief Keypad - */
+	KeyComma = 272,			/**< \brief Keypad , */
+	KeyPeriod = 273,		/**< \brief Keypad . */
+	KeyUp = 274,			/**< \brief Up arrow */
+	KeyDown = 275,			/**< \brief Down arrow */
+	KeyLeft = 276,			/**< \brief Left arrow */
+	KeyRight = 277,			/**< \brief Right arrow */
+	KeyF6 = 286,			/**< \brief F6 (to F14 at 294) */
+	KeyHelp = 295,			/**< \brief HELP (F15) */
+	KeyDo = 296,			/**< \brief DO (F16) */
+	KeyF17 = 297,			/**< \brief F17 (to F20 at 300) */
+	KeyFind = 311,			/**< \brief FIND (E1) */
+	KeyInsertHere = 312,		/**< \brief INSERT HERE (E2) */
+	KeyRemove = 313,		/**< \brief REMOVE (E3) */
+	KeySelect = 314,		/**< \brief SELECT (E4) */
+	KeyPrevScreen = 315,		/**< \brief PREV SCREEN (E5) */
+	KeyNextScreen = 316,		/**< \brief NEXT SCREEN (E6) */
+	KeyCancelled = 508,		/**< \brief End of file on the terminal */
+	KeyTimeout = 509,		/**< \brief Nothing typed in time */
+	KeyUnknown = 511		/**< \brief Sequence not recognized */
+};
+
+/**
+ * \brief A terminal to read keys from
+ *
+ *	Whatever has been typed is read into a type-ahead buffer
+ *	in one go, and keys are taken from there, so fast typing
+ *	(or a pasted block) isn't lost and doesn't cost a system
+ *	call per key.
+ */
+class Keyboard
+{
+private:
+	int Fd;				/**< \brief File descriptor */
+	unsigned char Buffer[256];	/**< \brief Type-ahead */
+	size_t Head;			/**< \brief Next key in Buffer */
+	size_t Tail;			/**< \brief End of keys in Buffer */
+
+	int Fill(int Timeout);
+	int Next();
+	int Escape();
+	int Pending(int Timeout);
+
+public:
+	/**
+	 * \brief Constructor
+	 */
+	explicit Keyboard(
+		int NewFd = 0		/**< Terminal to read */
+	)
+	{
+		Fd = NewFd;
+		Head = Tail = 0;
+	}
+
+	int Read(int Timeout = -1);
+
+private:
+	//
+	// The type-ahead would be lost
+	//
+	Keyboard(const Keyboard&);
+	Keyboard& operator=(const Keyboard&);
+};
+
+Keyboard& TerminalKeyboard();
+std::string KeyName(int Code);
+}
+
+#endif
@@ -5,8 +5,13 @@
 
 
 #include <ctype.h>
-#include <glob.h>
+#include <dirent.h>
 #include <libgen.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <mutex>
 #include <vector>
 #include <unistd.h>
 
@@ -32,12 +37,426 @@ long lib$delete_file(
 	return 1;
 }
 
-static std::vector<std::string> files;	/**< list of files scanned */
+//
+// lib$find_file
+//
+// Each scan reads its directory one entry at a time as
+// matches are asked for, so a scan of a large directory
+// starts straight away and doesn't hold a list of every
+// name. Scans are kept in a table, and the caller's context
+// is an index into it, so several can be going at once.
+//
+
+/** \brief Match a name against a VMS style wildcard
+ *
+ * '*' matches any number of characters, '%' (or '?') any
+ * one character. Case is ignored, as it is on VMS.
+ *
+ * \return non-zero if it matches
+ */
+static int WildMatch(
+	const char *pattern,	//!< Wildcard
+	const char *name)	//!< Name to check
+{
+	const char *star = 0;		// Last '*' seen
+	const char *retry = 0;		// Where that '*' matches up to
+
+	while (*name != '\0')
+	{
+		if (*pattern == '*')
+		{
+			star = pattern++;
+			retry = name;
+		}
+		else if ((*pattern == '%' || *pattern == '?') ||
+			(*pattern != '\0' &&
+			tolower((unsigned char)*pattern) == tolower((unsigned char)*name)))
+		{
+			pattern++;
+			name++;
+		}
+		else if (star != 0)
+		{
+			//
+			// Let the last '*' take one more character
+			//
+			pattern = star + 1;
+			name = ++retry;
+		}
+		else
+		{
+			return 0;
+		}
+	}
+	while (*pattern == '*')
+	{
+		pattern++;
+	}
+	return *pattern == '\0';
+}
+
+/** \brief Does a string contain wildcards
+ */
+static int HasWild(
+	const std::string &text)	//!< String to check
+{
+	return text.find_first_of("*%?") != std::string::npos;
+}
+
+/** \brief A directory being read by a lib$find_file scan
+ */
+struct ScanLevel
+{
+	std::string path;		//!< Directory, ending in '/' ("" for current)
+	size_t depth;			//!< Wildcarded directories matched so far
+	DIR *dir;			//!< Open directory (0 until it is read)
+};
+
+/** \brief One lib$find_file scan
+ */
+struct FileScan
+{
+	std::string directory;		//!< Directory up to the first wildcard
+	std::vector<std::string> wilddirs;	//!< Directories from the first wildcard on
+	std::string name;		//!< Name pattern, without version
+	std::string version;		//!< Version pattern ("" for any)
+	std::vector<ScanLevel> levels;	//!< Directories being read, innermost last
+	int started;			//!< First match has been asked for
+
+	FileScan()
+	{
+		started = 0;
+	}
+	~FileScan()
+	{
+		for (size_t loop = 0; loop < levels.size(); loop++)
+		{
+			if (levels[loop].dir != 0)
+			{
+				closedir(levels[loop].dir);
+			}
+		}
+	}
+};
+
+static std::vector<FileScan*> scans;	//!< Scans, by context - 1
+static std::mutex scan_lock;		//!< Guards scans
+
+/** \brief Set up a scan
+ *
+ * The file name and any of the directories can be wildcarded.
+ * A ";version" on the end matches files that were copied over
+ * with their VMS versions still on the name (";*", ";" or ";0"
+ * for any version, including none). Without one, a name with
+ * no wildcards finds the file as named, or failing that its
+ * highest version, as VMS would; a wildcarded spec matches
+ * files with or without a version. A name with no type picks
+ * up the type from the default file spec, and a name without
+ * a directory picks up the default's directory.
+ */
+static FileScan *StartScan(
+	const std::string &filespec,	//!< File spec
+	const std::string &deflt)	//!< Default file spec
+{
+	FileScan *scan = new FileScan;
+	std::string spec = filespec;
+
+	if (spec.compare(0, 2, "~/") == 0 && getenv("HOME") != 0)
+	{
+		spec = std::string(getenv("HOME")) + spec.substr(1);
+	}
+
+	std::string::size_type slash = spec.rfind('/');
+	std::string::size_type dslash = deflt.rfind('/');
+	if (slash != std::string::npos)
+	{
+		scan->directory = spec.substr(0, slash + 1);
+		spec.erase(0, slash + 1);
+	}
+	else if (dslash != std::string::npos)
+	{
+		scan->directory = deflt.substr(0, dslash + 1);
+	}
+
+	//
+	// Split off the directories from the first wildcarded one,
+	// which have to be searched for.
+	//
+	std::string::size_type wild = scan->directory.find_first_of("*%?");
+	if (wild != std::string::npos)
+	{
+		std::string::size_type start = scan->directory.rfind('/', wild);
+		start = (start == std::string::npos) ? 0 : start + 1;
+
+		while (start < scan->directory.size())
+		{
+			std::string::size_type end = scan->directory.find('/', start);
+			if (end > start)
+			{
+				scan->wilddirs.push_back(
+					scan->directory.substr(start, end - start));
+			}
+			start = end + 1;
+		}
+		scan->directory.erase(scan->directory.rfind('/', wild) + 1);
+	}
+
+	std::string::size_type semi = spec.find(';');
+	if (semi != std::string::npos)
+	{
+		scan->version = spec.substr(semi + 1);
+		spec.erase(semi);
+		if (scan->version == "" || scan->version == "0")
+		{
+			scan->version = "*";
+		}
+	}
+
+	if (spec.find('.') == std::string::npos)
+	{
+		std::string dname = deflt.substr(
+			dslash == std::string::npos ? 0 : dslash + 1);
+		std::string::size_type dot = dname.find('.');
+
+		if (dot != std::string::npos)
+		{
+			spec += dname.substr(dot, dname.find(';', dot) - dot);
+		}
+	}
+	scan->name = spec;
+
+	return scan;
+}
+
+/** \brief Does a directory entry match a scan
+ */
+static int ScanMatch(
+	const FileScan *scan,	//!< Scan
+	const char *entry)	//!< Directory entry
+{
+	const char *semi = strrchr(entry, ';');
+
+	if (semi != 0)
+	{
+		//
+		// Looks like it has a VMS version number
+		//
+		std::string name(entry, semi - entry);
+
+		if (WildMatch(scan->name.c_str(), name.c_str()) &&
+			(scan->version.empty() ||
+			WildMatch(scan->version.c_str(), semi + 1)))
+		{
+			return 1;
+		}
+	}
+	return (scan->version.empty() || scan->version == "*") &&
+		WildMatch(scan->name.c_str(), entry);
+}
+
+/** \brief Is a directory entry a directory
+ */
+static int IsDirectory(
+	const struct dirent *entry,	//!< Directory entry
+	const std::string &path)	//!< Its full name
+{
+	struct stat status;
+
+	if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK)
+	{
+		return stat(path.c_str(), &status) == 0 &&
+			S_ISDIR(status.st_mode);
+	}
+	return entry->d_type == DT_DIR;
+}
+
+/** \brief Queue a directory to be read
+ *
+ * Directories in the spec that aren't wildcarded are added
+ * straight on to the path, rather than searched for.
+ */
+static void PushLevel(
+	FileScan *scan,		//!< Scan
+	std::string path,	//!< Directory, ending in '/'
+	size_t depth)		//!< Wildcarded directories matched so far
+{
+	while (depth < scan->wilddirs.size() && !HasWild(scan->wilddirs[depth]))
+	{
+		path += scan->wilddirs[depth++] + '/';
+	}
+
+	ScanLevel level;
+	level.path = path;
+	level.depth = depth;
+	level.dir = 0;
+	scan->levels.push_back(level);
+}
+
+/** \brief Look up a file name with no wildcards
+ *
+ * Finds the file as named, or failing that the highest of
+ * its VMS versions.
+ *
+ * \return non-zero if it was found
+ */
+static int FindOne(
+	FileScan *scan,		//!< Scan
+	std::string &result)	//!< Returned file name
+{
+	struct stat status;
+
+	result = scan->directory + scan->name;
+	if (stat(result.c_str(), &status) == 0)
+	{
+		if (S_ISDIR(status.st_mode))
+		{
+			result += '/';
+		}
+		return 1;
+	}
+
+	DIR *dir = opendir(scan->directory.empty() ?
+		"." : scan->directory.c_str());
+	if (dir == 0)
+	{
+		return 0;
+	}
+
+	long best = -1;
+	while (struct dirent *entry = readdir(dir))
+	{
+		const char *semi = strrchr(entry->d_name, ';');
+		char *end;
+
+		if (semi == 0 || semi[1] == '\0')
+		{
+			continue;
+		}
+		long version = strtol(semi + 1, &end, 10);
+		if (*end != '\0' || version <= best)
+		{
+			continue;
+		}
+
+		std::string name(entry->d_name, semi - entry->d_name);
+		if (WildMatch(scan->name.c_str(), name.c_str()))
+		{
+			best = version;
+			result = scan->directory + entry->d_name;
+		}
+	}
+	closedir(dir);
+
+	return best >= 0;
+}
+
+/** \brief Find the next match in a scan
+ *
+ * Directories are read one entry at a time. When a wildcarded
+ * directory matches, it is read before going on with the one
+ * it is in.
+ *
+ * \return non-zero if one was found
+ */
+static int ScanNext(
+	FileScan *scan,		//!< Scan
+	std::string &result)	//!< Returned file name
+{
+	if (!scan->started)
+	{
+		scan->started = 1;
+
+		//
+		// Without wildcards, there's no need to read the
+		// directory, just see if the file is there.
+		//
+		if (!HasWild(scan->name) && scan->version.empty() &&
+			scan->wilddirs.empty())
+		{
+			return FindOne(scan, result);
+		}
+		PushLevel(scan, scan->directory, 0);
+	}
+
+	while (!scan->levels.empty())
+	{
+		ScanLevel &level = scan->levels.back();
+
+		if (level.dir == 0)
+		{
+			level.dir = opendir(level.path.empty() ?
+				"." : level.path.c_str());
+			if (level.dir == 0)
+			{
+				scan->levels.pop_back();
+				continue;
+			}
+		}
+
+		struct dirent *entry = readdir(level.dir);
+		if (entry == 0)
+		{
+			closedir(level.dir);
+			scan->levels.pop_back();
+			continue;
+		}
+
+		//
+		// Still looking for directories
+		//
+		if (level.depth < scan->wilddirs.size())
+		{
+			const std::string &pattern = scan->wilddirs[level.depth];
+
+			if (strcmp(entry->d_name, ".") == 0 ||
+				strcmp(entry->d_name, "..") == 0 ||
+				(entry->d_name[0] == '.' && pattern[0] != '.') ||
+				!WildMatch(pattern.c_str(), entry->d_name))
+			{
+				continue;
+			}
+			std::string path = level.path + entry->d_name;
+			if (IsDirectory(entry, path))
+			{
+				PushLevel(scan, path + '/', level.depth + 1);
+			}
+			continue;
+		}
+
+		//
+		// Like glob, '*' doesn't match hidden files
+		//
+		if (entry->d_name[0] == '.' && scan->name[0] != '.')
+		{
+			continue;
+		}
+		if (!ScanMatch(scan, entry->d_name))
+		{
+			continue;
+		}
+
+		result = level.path + entry->d_name;
+		if (IsDirectory(entry, result))
+		{
+			result += '/';
+		}
+		return 1;
+	}
+
+	return 0;
+}
 
 /** \brief look up file names
  *
  * Linux version of a VMS function for conversion purposes.
  * Only enough emulated to make it work in specific contexts.
+ *
+ * Start with context zero. Each call returns the next match
+ * and leaves context set for the next call. When there are
+ * no more, it returns 0 and sets context back to zero.
+ *
+ * Names come back in the order they are in the directory,
+ * not sorted. Directories have a '/' added.
  */
 long lib$find_file(
 	const std::string &filespec,
@@ -47,58 +466,67 @@ long lib$find_file(
 	const std::string related,
 	long flags)
 {
-	glob_t pglob;
-	char *name_buffer;
+	FileScan *scan;
 
-	if (context == 0)
 	{
-		/*
-		 * Look up files until we run out of files, or run out of
-		 * array elements.
-		 */
-		glob(filespec.c_str(),
-			GLOB_MARK | GLOB_TILDE,
-			0 /* errfunc */,
-			&pglob);
+		std::lock_guard<std::mutex> hold(scan_lock);
 
-		for (int loop = 0; loop < pglob.gl_pathc; loop++)
+		if (context > 0 && context <= (long)scans.size() &&
+			scans[context - 1] != 0)
 		{
-			name_buffer = pglob.gl_pathv[loop];
-			files.push_back(name_buffer);
+			scan = scans[context - 1];
+		}
+		else
+		{
+			//
+			// Start a new scan in the first free slot
+			//
+			scan = StartScan(filespec, deflt);
+			std::vector<FileScan*>::iterator slot =
+				std::find(scans.begin(), scans.end(), (FileScan*)0);
+			if (slot == scans.end())
+			{
+				slot = scans.insert(scans.end(), 0);
+			}
+			*slot = scan;
+			context = slot - scans.begin() + 1;
 		}
-
-		/*
-		 * Finish up directory call
-		 */
-		globfree(&pglob);
-
-		context = 1;
 	}
 
-	if (context < files.size())
+	if (ScanNext(scan, result))
 	{
-		result = files[context++];
 		return 1;
 	}
-	else
-	{
-		result = "";
-		return 0;
-	}
+
+	result = "";
+	lib$find_file_end(context);
+	return 0;
 }
 
-/** \brief free up context for lib_find_file
+/** \brief free up context for lib$find_file
  *
- * Frees up resources allocated by lib_find_file
+ * Frees up resources allocated by lib$find_file
  */
-long lib_find_file_end(
+long lib$find_file_end(
 	long &context)
 {
-	if (context)
+	std::lock_guard<std::mutex> hold(scan_lock);
+
+	if (context > 0 && context <= (long)scans.size())
 	{
-		files.clear();
-		context = 0;
+		delete scans[context - 1];
+		scans[context - 1] = 0;
 	}
+	context = 0;
 	return 1;
 }
 
+/** \brief free up context for lib$find_file
+ *
+ * Old name for lib$find_file_end.
+ */
+long lib_find_file_end(
+	long &context)
+{
+	return lib$find_file_end(context);
+}
@@ -26,6 +26,8 @@ long lib$find_file(
 	const std::string &deflt = "",
 	const std::string related = "",
 	long flags = 0);
+long lib$find_file_end(
+	long &context);
 
 
 
@@ -576,26 +576,136 @@ std::string basic::PUsing::Output(
 	double Param		/**< Number to format */
 )
 {
-	int Digits = 0;		// Number of digit positions
-	int Decimals = 0;	// Number of decimal positions
-	int Point = 0;		// Decimal point seen?
-	int Comma = 0;		// Output comma's?
-	int Stars = 0;		// Leading stars?
-	int Minus = 0;		// Minus (0 = none specified,
-				//  2 = trailing, 3 = <CD>
-	int Dollar = 0;		// Floating '$' sign.
-	int ZeroFill = 0;	// Fill with leading 0's
-	int Percent = 0;	// Pergentage format
-	int Exponent = 0;	// Scientific notation
+	NumberFormat Form;
 
-	int KeepLooping = 1;	// Loop till quit
+	//
+	// Create a buffer
+	//
+	Outdata = new char[BaseLength + 64];
+	OutdataPtr = Outdata;
+
+	ScanNumber(Form);
+	PutDouble(Form, Param);
+
+	//
+	// Send out the result
+	//
+	*OutdataPtr = '\0';
+	std::string Result(Outdata);
+	delete[] Outdata;
+	return Result;
+}
+
+/**
+ * \brief Format a DECIMAL number according to given specification
+ *
+ *	Works from the exact digits of the number, so the value
+ *	printed is the value stored, rounded (half away from zero)
+ *	to the places in the format.
+ *
+ * \return Formatted string.
+ */
+std::string basic::PUsing::OutputDecimal(
+	int Negative,			/**< Is the number negative */
+	const std::string& Digits,	/**< Digits of its absolute value */
+	int Scale			/**< How many of them are places */
+)
+{
+	NumberFormat Form;
 
 	//
 	// Create a buffer
 	//
-	Outdata = new char[BaseLength + 10];
+	Outdata = new char[BaseLength + 64];
 	OutdataPtr = Outdata;
 
+	ScanNumber(Form);
+
+	if (Form.Exponent)
+	{
+		//
+		// Scientific notation isn't exact anyway
+		//
+		double Value = atof(Digits.c_str()) / pow(10.0, Scale);
+		PutDouble(Form, Negative ? -Value : Value);
+	}
+	else
+	{
+		//
+		// Line the digits up on the format's decimal point
+		//
+		std::string Work = Digits;
+		int Round = 0;
+
+		if (Scale > Form.Decimals)
+		{
+			Round = Work[Work.size() - Scale + Form.Decimals] >= '5';
+			Work.erase(Work.size() - Scale + Form.Decimals);
+		}
+		else
+		{
+			Work.append(Form.Decimals - Scale, '0');
+		}
+
+		for (size_t loop = Work.size(); Round && (loop-- > 0); )
+		{
+			Round = (Work[loop] == '9');
+			Work[loop] = Round ? '0' : Work[loop] + 1;
+		}
+		if (Round)
+		{
+			Work.insert(0, 1, '1');
+		}
+
+		std::string Whole = Work.substr(0, Work.size() - Form.Decimals);
+		std::string Fraction = Work.substr(Work.size() - Form.Decimals);
+
+		Whole.erase(0, Whole.find_first_not_of('0'));
+		if (Whole.empty())
+		{
+			Whole = "0";
+		}
+
+		if ((Form.Percent != 0) &&
+			(Work.find_first_not_of('0') == std::string::npos))
+		{
+			PutBlank(Form);
+		}
+		else
+		{
+			PutDigits(Form, Negative, Whole, Fraction, 0);
+		}
+	}
+
+	//
+	// Send out the result
+	//
+	*OutdataPtr = '\0';
+	std::string Result(Outdata);
+	delete[] Outdata;
+	return Result;
+}
+
+/**
+ * \brief Scan the next numeric field in the format
+ */
+void basic::PUsing::ScanNumber(
+	NumberFormat& Form	/**< Returned layout of the field */
+)
+{
+	Form.Digits = 0;
+	Form.Decimals = 0;
+	Form.Point = 0;
+	Form.Comma = 0;
+	Form.Stars = 0;
+	Form.Minus = 0;
+	Form.Dollar = 0;
+	Form.ZeroFill = 0;
+	Form.Percent = 0;
+	Form.Exponent = 0;
+
+	int KeepLooping = 1;	// Loop till quit
+
 	//
 	// Skip over intro stuff
 	//
@@ -615,48 +725,48 @@ std::string basic::PUsing::Output(
 			//
 			// Leading stars
 			//
-			if ((Stars == 0) &&
+			if ((Form.Stars == 0) &&
 				(strncmp(BaseFormat + BasePtr, "**", 2) == 0))
 			{
-				Digits += 2;
+				Form.Digits += 2;
 				BasePtr += 2;
-				Stars = 1;
+				Form.Stars = 1;
 				continue;
 			}
 
 			//
 			// Floating '$' sign
 			//
-			if ((Dollar == 0) &&
+			if ((Form.Dollar == 0) &&
 				(strncmp(BaseFormat + BasePtr, "$$", 2) == 0))
 			{
-				Digits += 1;
+				Form.Digits += 1;
 				BasePtr += 2;
-				Dollar = 1;
+				Form.Dollar = 1;
 				continue;
 			}
 
 			//
 			// Fill with 0's
 			//
-			if ((ZeroFill == 0) &&
+			if ((Form.ZeroFill == 0) &&
 				(strncmp(BaseFormat + BasePtr, "<0>", 3) == 0))
 			{
-				Digits += 1;
+				Form.Digits += 1;
 				BasePtr += 3;
-				ZeroFill = 1;
+				Form.ZeroFill = 1;
 				continue;
 			}
 
 			//
 			// Percentage
 			//
-			if ((Percent == 0) &&
+			if ((Form.Percent == 0) &&
 				(strncmp(BaseFormat + BasePtr, "<%>", 3) == 0))
 			{
-				Digits += 1;
+				Form.Digits += 1;
 				BasePtr += 3;
-				Percent = 1;
+				Form.Percent = 1;
 				continue;
 			}
 
@@ -674,42 +784,42 @@ std::string basic::PUsing::Output(
 			//
 			if (BaseFormat[BasePtr] == '#')
 			{
-				if (Point == 0)
+				if (Form.Point == 0)
 				{
-					Digits++;
+					Form.Digits++;
 				}
 				else
 				{
-					Decimals++;
+					Form.Decimals++;
 				}
 				BasePtr++;
 				continue;
 			}
 
 			//
-			// Comma
+			// Form.Comma
 			//
 			if (BaseFormat[BasePtr] == ',')
 			{
-				if (Point == 0)
+				if (Form.Point == 0)
 				{
-					Digits++;
+					Form.Digits++;
 				}
 				else
 				{
-					Decimals++;
+					Form.Decimals++;
 				}
 				BasePtr++;
-				Comma = 1;
+				Form.Comma = 1;
 				continue;
 			}
 
 			//
 			// Decimal point
 			//
-			if ((Point == 0) && (BaseFormat[BasePtr] == '.'))
+			if ((Form.Point == 0) && (BaseFormat[BasePtr] == '.'))
 			{
-				Point = 1;
+				Form.Point = 1;
 				BasePtr++;
 				continue;
 			}
@@ -725,28 +835,28 @@ std::string basic::PUsing::Output(
 			//
 			// <CD>
 			//
-			if ((Minus == 0) &&
+			if ((Form.Minus == 0) &&
 				(strncmp(BaseFormat + BasePtr, "<CD>", 4) == 0))
 			{
 				BasePtr += 4;
-				Minus = 3;
+				Form.Minus = 3;
 				continue;
 			}
 
-			if ((Exponent == 0) &&
+			if ((Form.Exponent == 0) &&
 				(strncmp(BaseFormat + BasePtr, "^^^^", 4) == 0))
 			{
 				BasePtr += 4;
-				Exponent = 4;
+				Form.Exponent = 4;
 				continue;
 			}
 
 			//
 			// Trailing sign
 			//
-			if ((Minus == 0) && (BaseFormat[BasePtr] == '-'))
+			if ((Form.Minus == 0) && (BaseFormat[BasePtr] == '-'))
 			{
-				Minus = 2;
+				Form.Minus = 2;
 				BasePtr++;
 				continue;
 			}
@@ -754,247 +864,256 @@ std::string basic::PUsing::Output(
 		}
 
 	}
+}
 
-//cout << "Digits " << Digits << " Decimals " << Decimals << " Point " << Point <<
-//	" Comma " << Comma << " Stars " << Stars << " Minus " << Minus <<
-//	" Dollar " << Dollar << " ZeroFill " << ZeroFill <<
-//	" Percent " << Percent << " Exponent " << Exponent << std::endl;
+/**
+ * \brief Blank out a numeric field ('<%>' format of zero)
+ */
+void basic::PUsing::PutBlank(
+	const NumberFormat& Form	/**< Layout of the field */
+)
+{
+	long PDigits;		// Digit portion of number
 
-	//***********************************************************
-	// Now that we've scanned the format, we need to generate
-	// the output
-	//***********************************************************
+	//
+	// Calculate size of output
+	//
+	PDigits = Form.Dollar + Form.Digits + Form.Point + Form.Decimals +
+		Form.Exponent;
+	switch(Form.Minus)
+	{
+	case 2:
+		PDigits++;
+		break;
+	case 3:
+		PDigits += 2;
+		break;
+	}
 
-	if ((Percent != 0) && (Param == 0.0))
+	//
+	// Output appropiate number of spaces
+	//
+	while(PDigits)
 	{
-		long PDigits;		// Digit portion of number
+		*OutdataPtr++ = ' ';
+		PDigits--;
+	}
+}
 
-		//
-		// Calculate size of output
-		//
-		PDigits = Dollar + Digits + Point + Decimals + Exponent;
-		switch(Minus)
-		{
-		case 2:
-			PDigits++;
-			break;
-		case 3:
-			PDigits += 2;
-			break;
-		}
+/**
+ * \brief Output a floating point number into a numeric field
+ */
+void basic::PUsing::PutDouble(
+	const NumberFormat& Form,	/**< Layout of the field */
+	double Param			/**< Number to format */
+)
+{
+	if ((Form.Percent != 0) && (Param == 0.0))
+	{
+		PutBlank(Form);
+		return;
+	}
 
-		//
-		// Output appropiate number of spaces
-		//
-		while(PDigits)
-		{
-			*OutdataPtr++ = ' ';
-			PDigits--;
-		}
+	int PSign;		// Sign of result
+	long PExp = 0;		// Exponent
+	double PAbs;		// Absolute value of number
+
+	if (Param < 0)
+	{
+		PSign = 1;
+		PAbs = -Param;
 	}
 	else
 	{
-		int PSign;		// Sign of result
-		long PDigits;		// Digit portion of number
-		long PExp = 0;		// Exponent
-		double PAbs;		// Absolute value of number
-		char Work[64];		// Working buffer
-		int WorkPtr = 0;	// Pointer into working buffer
-
-		if (Param < 0)
-		{
-			PSign = 1;
-			PAbs = -Param;
-		}
-		else
-		{
-			PSign = 0;
-			PAbs = Param;
-		}
+		PSign = 0;
+		PAbs = Param;
+	}
 
-		//
-		// If we are using scientific notation, normalize the
-		// number
-		//
-		if (Exponent)
-		{
-			PExp = (int)floor(log10(PAbs));
-			PAbs = PAbs / pow(10.0, PExp * 1.0);
-		}
+	//
+	// If we are using scientific notation, normalize the
+	// number
+	//
+	if (Form.Exponent && (PAbs != 0.0))
+	{
+		PExp = (int)floor(log10(PAbs));
+		PAbs = PAbs / pow(10.0, PExp * 1.0);
+	}
 
-		//
-		// handle the decimal portion first
-		//
-		//	Generates it in a work string in reverse order, which
-		//	will be reversed back before appending to the output.
-		//
-		//	NOTE: The conversion to a long may not be the best thing
-		//	to do, but this is just version 1 anyway.
-		//
-		//	Also, I don't check for overflow of the work buffer
-		//
-		WorkPtr = 0;
-		PDigits = (long)floor(PAbs);
-		if (PDigits == 0)
-		{
-			Work[WorkPtr++] = '0';
-		}
-		else
-		while (PDigits)
-		{
-			//
-			// Place a comma every 4th character
-			//
-			if ((Comma != 0) && ((WorkPtr + 1) % 4) == 0)
-			{
-				Work[WorkPtr++] = ',';
-			}
+	//
+	// NOTE: The conversion to a long may not be the best thing
+	// to do, but this is just version 1 anyway.
+	//
+	std::string Whole = std::to_string((long)floor(PAbs));
 
-			//
-			// Place one digit (This is why I'm using an integer)
-			//
-			Work[WorkPtr++] = (PDigits % 10) + '0';
+	//
+	// Decimal digits
+	//
+	//	We drop off the digit part, then add in a rounding
+	//	amout to help hide any (.99999) type problems.
+	//
+	std::string Fraction;
+	PAbs = PAbs - floor(PAbs) + pow(10.0, -(Form.Decimals + 1));
+	for (int loop = 0; loop < Form.Decimals; loop++)
+	{
+		PAbs *= 10;
+		long PDigits = (long)floor(PAbs);
+		PAbs -= PDigits;
+		Fraction += (char)((PDigits % 10) + '0');
+	}
 
-			//
-			// Drop the digit just added
-			//
-			PDigits /= 10;
-		}
+	PutDigits(Form, PSign, Whole, Fraction, PExp);
+}
 
-		//
-		// Handle any dollar sign
-		//
-		if (Dollar != 0)
-		{
-			Work[WorkPtr++] = '$';
-		}
+/**
+ * \brief Output the digits of a number into a numeric field
+ */
+void basic::PUsing::PutDigits(
+	const NumberFormat& Form,	/**< Layout of the field */
+	int PSign,			/**< Is the number negative */
+	const std::string& Whole,	/**< Digits in front of the point */
+	const std::string& Fraction,	/**< Digits after the point */
+	long PExp			/**< Exponent (if '^^^^') */
+)
+{
+	std::string Work;	// Working buffer (reversed)
 
+	//
+	// handle the integer portion first
+	//
+	//	Generates it in a work string in reverse order, which
+	//	will be reversed back before appending to the output.
+	//
+	for (size_t loop = Whole.size(); loop-- > 0; )
+	{
 		//
-		// Minus sign?
+		// Place a comma every 4th character
 		//
-		if ((Minus == 0) && (PSign != 0))
+		if ((Form.Comma != 0) && ((Work.size() + 1) % 4) == 0)
 		{
-			Work[WorkPtr++] = '-';
+			Work += ',';
 		}
+		Work += Whole[loop];
+	}
 
-		//
-		// Fill to final length
-		//
-		char FillChar;
-		if (Stars != 0)
+	//
+	// Handle any dollar sign
+	//
+	if (Form.Dollar != 0)
+	{
+		Work += '$';
+	}
+
+	//
+	// Minus sign?
+	//
+	if ((Form.Minus == 0) && (PSign != 0))
+	{
+		Work += '-';
+	}
+
+	//
+	// Fill to final length
+	//
+	char FillChar;
+	if (Form.Stars != 0)
+	{
+		FillChar = '*';
+	}
+	else
+	{
+		if (Form.ZeroFill != 0)
 		{
-			FillChar = '*';
+			FillChar = '0';
 		}
 		else
 		{
-			if (ZeroFill != 0)
-			{
-				FillChar = '0';
-			}
-			else
-			{
-				FillChar = ' ';
-			}
-		}
-		while (WorkPtr < Digits + Dollar)
-		{
-			Work[WorkPtr++] = FillChar;
+			FillChar = ' ';
 		}
+	}
+	while (Work.size() < (size_t)(Form.Digits + Form.Dollar))
+	{
+		Work += FillChar;
+	}
+
+	//
+	// Write out this portion to the output
+	//
+	for (size_t loop = Work.size(); loop-- > 0; )
+	{
+		*OutdataPtr++ = Work[loop];
+	}
+
+	//
+	// Decimal point?
+	//
+	if (Form.Point)
+	{
+		*OutdataPtr++ = '.';
+	}
 
+	//
+	// Decimal digits
+	//
+	int WorkPtr = 1;
+	size_t Next = 0;
+	while (WorkPtr <= Form.Decimals)
+	{
 		//
-		// Write out this portion to the output
+		// Place a comma every 4th character
 		//
-		while (WorkPtr)
+		if ((Form.Comma != 0) && (WorkPtr % 4) == 0)
 		{
-			*OutdataPtr++ = Work[--WorkPtr];
+			*OutdataPtr++ = ',';
+			WorkPtr++;
 		}
 
 		//
-		// Decimal point?
+		// Place one decimal
 		//
-		if (Point)
+		*OutdataPtr++ = (Next < Fraction.size()) ? Fraction[Next++] : '0';
+		WorkPtr++;
+	}
+
+	//
+	// Trailing sign
+	//
+	switch(Form.Minus)
+	{
+	case 2:
+		if (PSign)
 		{
-			*OutdataPtr++ = '.';
+			*OutdataPtr++ = '-';
 		}
-
-		//
-		// Decimal digits
-		//
-		//	We drop off the digit part, then add in a rounding
-		//	amout to help hide any (.99999) type problems.
-		//
-		PAbs = PAbs - floor(PAbs) + pow(10.0, -(Decimals + 1));
-		WorkPtr = 1;
-		while (WorkPtr <= Decimals)
+		else
 		{
-			//
-			// Place a comma every 4th character
-			//
-			if ((Comma != 0) && (WorkPtr % 4) == 0)
-			{
-				*OutdataPtr++ = ',';
-				WorkPtr++;
-			}
-
-			//
-			// Place one decimal
-			//
-			PAbs *= 10;
-			PDigits = (long)floor(PAbs);
-			PAbs -= PDigits;
-
-			*OutdataPtr++ = (PDigits % 10) + '0';
-			WorkPtr++;
+			*OutdataPtr++ = ' ';
 		}
+		break;
 
-		//
-		// Trailing sign
-		//
-		switch(Minus)
+	case 3:
+		if (PSign)
 		{
-		case 2:
-			if (PSign)
-			{
-				*OutdataPtr++ = '-';
-			}
-			else
-			{
-				*OutdataPtr++ = ' ';
-			}
-			break;
-
-		case 3:
-			if (PSign)
-			{
-				*OutdataPtr++ = 'C';
-				*OutdataPtr++ = 'R';
-			}
-			else
-			{
-				*OutdataPtr++ = 'D';
-				*OutdataPtr++ = 'R';
-			}
-			break;
+			*OutdataPtr++ = 'C';
+			*OutdataPtr++ = 'R';
 		}
-
-		//
-		// If we are using scientific notation, output it now
-		//
-		if (Exponent)
+		else
 		{
-			sprintf(Work, "E%-3ld", PExp);
-			strcpy(OutdataPtr, Work);
-			OutdataPtr += strlen(Work);
+			*OutdataPtr++ = 'D';
+			*OutdataPtr++ = 'R';
 		}
+		break;
 	}
 
 	//
-	// Send out the result
+	// If we are using scientific notation, output it now
 	//
-	*OutdataPtr = '\0';
-	std::string Result(Outdata);
-	delete[] Outdata;
-	return Result;
+	if (Form.Exponent)
+	{
+		char Exp[32];
+		sprintf(Exp, "E%-3ld", PExp);
+		strcpy(OutdataPtr, Exp);
+		OutdataPtr += strlen(Exp);
+	}
 }
 
 /**
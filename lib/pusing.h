@@ -9,6 +9,8 @@
 
 namespace basic
 {
+template <int P, int S> class Decimal;
+
 /**
  * \brief Print using class
  *
@@ -56,11 +58,37 @@ public:
 	std::string Output(const double Value);
 	std::string Output(const int Value);
 	std::string Output(const long Value);
+	template <int P, int S>
+	std::string Output(const Decimal<P, S>& Value);
+	std::string OutputDecimal(int Negative, const std::string& Digits,
+		int Scale);
 
 	std::string Finish();		// Final characters in format string
 
 private:
+	/**
+	 * \brief Layout of a numeric field in the format
+	 */
+	struct NumberFormat
+	{
+		int Digits;	//!< Digits in front of the point
+		int Decimals;	//!< Digits after the point
+		int Point;	//!< Is there a decimal point
+		int Comma;	//!< Commas every three digits
+		int Stars;	//!< Leading '**'
+		int Minus;	//!< Sign (0=leading, 2=trailing, 3=CR/DR)
+		int Dollar;	//!< Floating '$$'
+		int ZeroFill;	//!< Leading zeros '<0>'
+		int Percent;	//!< Blank if zero '<%>'
+		int Exponent;	//!< Width of '^^^^' exponent
+	};
+
 	int SkipFront();
+	void ScanNumber(NumberFormat& Form);
+	void PutBlank(const NumberFormat& Form);
+	void PutDouble(const NumberFormat& Form, double Param);
+	void PutDigits(const NumberFormat& Form, int PSign,
+		const std::string& Whole, const std::string& Fraction, long PExp);
 	void ScanStringFormat(int &FWidth, int &FSide);
 	void FormatString(const char* ParmPtr, int ParmLength,
 		int Length, int Side);
@@ -2,23 +2,410 @@
 
 
 #include <string>
+#include <vector>
+#include <fstream>
+#include <cstdlib>
+#include <algorithm>
 #include <panel.h>
 
+#include "keyboard.h"
 #include "smgdef.h"
 #include "smgmsg.h"
 
 #include "smgroutines.h"
 
+//
+// Headless pasteboard
+//
+// Instead of a terminal, the displays can be kept as grids of
+// characters and attributes in memory, and the screen put
+// together from them whenever it would have been output. Each
+// of those screens (a frame) can be written to a file, so a
+// program's screens can be compared from run to run, and
+// drawing can be timed without a terminal.
+//
+// Selected by an output device of "NL:" in smg$create_pasteboard,
+// or by setting SMG_HEADLESS in the environment. If SMG_HEADLESS
+// has a value, frames are written to that file.
+//
+
+//! \brief One virtual display, when headless
+struct smg_grid
+{
+	int rows;			//!< Rows (including border)
+	int columns;			//!< Columns (including border)
+	std::string text;		//!< Characters, row by row
+	std::string attr;		//!< SMG$M_ attributes of each character
+	int row;			//!< Cursor row
+	int column;			//!< Cursor column
+};
+
+static int Headless = 0;		//!< Using the headless pasteboard
+static int ScreenRows = 24;		//!< Headless screen height
+static int ScreenColumns = 80;		//!< Headless screen width
+static std::string ScreenText;		//!< Last frame, characters
+static std::string ScreenAttr;		//!< Last frame, attributes
+static std::vector<ncurses_struct*> Pasted;
+					//!< Pasted displays, bottom first
+static long Frames = 0;			//!< Frames output
+static long CellsChanged = 0;		//!< Cells changed over all frames
+static std::ofstream FrameFile;		//!< Where to write frames
+
+/** \brief Put together what the screen shows
+ */
+static void Composite(
+	std::string &Text,		//!< Returned characters
+	std::string &Attr)		//!< Returned attributes
+{
+	Text.assign(ScreenRows * ScreenColumns, ' ');
+	Attr.assign(ScreenRows * ScreenColumns, 0);
+
+	for (size_t loop = 0; loop < Pasted.size(); loop++)
+	{
+		ncurses_struct *display = Pasted[loop];
+		smg_grid *grid = (display->shown_grid != 0) ?
+			display->shown_grid : display->grid;
+
+		for (int row = 0; row < grid->rows; row++)
+		{
+			int srow = display->vpos + row;
+
+			if (srow < 0 || srow >= ScreenRows)
+			{
+				continue;
+			}
+			for (int column = 0; column < grid->columns; column++)
+			{
+				int scolumn = display->hpos + column;
+
+				if (scolumn >= 0 && scolumn < ScreenColumns)
+				{
+					Text[srow * ScreenColumns + scolumn] =
+						grid->text[row * grid->columns + column];
+					Attr[srow * ScreenColumns + scolumn] =
+						grid->attr[row * grid->columns + column];
+				}
+			}
+		}
+	}
+}
+
+/** \brief Format a frame as text
+ *
+ * Each screen row is written between '|'s. A row with any
+ * attributes set is followed by a line starting with ':'
+ * giving the attributes of each character as a hex digit.
+ */
+static std::string FrameText(
+	const std::string &Text,	//!< Characters
+	const std::string &Attr)	//!< Attributes
+{
+	static const char Hex[] = "0123456789abcdef";
+	std::string Result;
+
+	for (int row = 0; row < ScreenRows; row++)
+	{
+		size_t start = row * ScreenColumns;
+
+		Result += '|';
+		Result.append(Text, start, ScreenColumns);
+		Result += "|\n";
+
+		if (Attr.find_first_not_of('\0', start) < start + ScreenColumns)
+		{
+			Result += ':';
+			for (int column = 0; column < ScreenColumns; column++)
+			{
+				char a = Attr[start + column];
+				Result += (a == 0) ? ' ' : Hex[a & 15];
+			}
+			Result += ":\n";
+		}
+	}
+	return Result;
+}
+
+/** \brief Output a headless frame, if anything changed
+ */
+static void HeadlessUpdate()
+{
+	std::string text;
+	std::string attr;
+	long changed = 0;
+
+	Composite(text, attr);
+	for (size_t loop = 0; loop < text.size(); loop++)
+	{
+		if (text[loop] != ScreenText[loop] || attr[loop] != ScreenAttr[loop])
+		{
+			changed++;
+		}
+	}
+	if (changed == 0)
+	{
+		return;
+	}
+
+	Frames++;
+	CellsChanged += changed;
+	ScreenText.swap(text);
+	ScreenAttr.swap(attr);
+
+	if (FrameFile.is_open())
+	{
+		FrameFile << "Frame " << Frames << " (" << changed <<
+			" changed)\n" << FrameText(ScreenText, ScreenAttr);
+		FrameFile.flush();
+	}
+}
+
+//
+// Drawing on a display
+//
+// Coordinates are within the display's window, border included.
+//
+
+/** \brief Write text on a display
+ */
+static void DisplayPut(
+	ncurses_struct *display,	//!< Display
+	int row,			//!< Row
+	int column,			//!< Column
+	const std::string &str,		//!< Text
+	int attr)			//!< SMG$M_ attributes
+{
+	if (display->grid == 0)
+	{
+		if (attr & SMG$M_BOLD)
+		{
+			wattron(display->win, A_STANDOUT);
+		}
+		if (attr & SMG$M_REVERSE)
+		{
+			wattron(display->win, A_REVERSE);
+		}
+		mvwaddstr(display->win, row, column, str.c_str());
+		wattrset(display->win, 0);
+		return;
+	}
+
+	smg_grid *grid = display->grid;
+	if (row < 0 || row >= grid->rows || column < 0)
+	{
+		return;
+	}
+	for (size_t loop = 0;
+		loop < str.size() && column < grid->columns; loop++, column++)
+	{
+		grid->text[row * grid->columns + column] = str[loop];
+		grid->attr[row * grid->columns + column] = attr;
+	}
+	grid->row = row;
+	grid->column = column;
+}
+
+/** \brief Draw a horizontal or vertical line on a display
+ */
+static void DisplayLine(
+	ncurses_struct *display,	//!< Display
+	int row,			//!< Starting row
+	int column,			//!< Starting column
+	int length,			//!< Length of line
+	int vertical)			//!< Going down instead of across
+{
+	if (display->grid == 0)
+	{
+		if (vertical)
+		{
+			mvwvline(display->win, row, column, 0, length);
+		}
+		else
+		{
+			mvwhline(display->win, row, column, 0, length);
+		}
+		return;
+	}
+
+	for (int loop = 0; loop < length; loop++)
+	{
+		DisplayPut(display, row, column, vertical ? "|" : "-", 0);
+		if (vertical)
+		{
+			row++;
+		}
+		else
+		{
+			column++;
+		}
+	}
+}
+
+/** \brief Erase from a position to the end of the line
+ */
+static void DisplayEraseLine(
+	ncurses_struct *display,	//!< Display
+	int row,			//!< Row
+	int column)			//!< Column
+{
+	if (display->grid == 0)
+	{
+		wmove(display->win, row, column);
+		wclrtoeol(display->win);
+		return;
+	}
+
+	smg_grid *grid = display->grid;
+	if (row >= 0 && row < grid->rows && column >= 0 && column < grid->columns)
+	{
+		grid->text.replace(row * grid->columns + column,
+			grid->columns - column, grid->columns - column, ' ');
+		grid->attr.replace(row * grid->columns + column,
+			grid->columns - column, grid->columns - column, '\0');
+	}
+}
+
+/** \brief Erase a whole display
+ */
+static void DisplayErase(
+	ncurses_struct *display)	//!< Display
+{
+	if (display->grid == 0)
+	{
+		werase(display->win);
+		return;
+	}
+
+	std::fill(display->grid->text.begin(), display->grid->text.end(), ' ');
+	std::fill(display->grid->attr.begin(), display->grid->attr.end(), 0);
+}
+
+//
+// Screen updates
+//
+// Drawing only changes the virtual displays (curses windows).
+// The terminal is brought up to date afterwards, unless the
+// program is in the middle of a begin/end update, in which case
+// it is left until the outermost end. curses then only sends
+// the cells that changed.
+//
+// A pasteboard update holds back the whole screen. A display
+// update holds back only that display: the screen is given a
+// copy of it as it was when the update began, and the changes
+// made to it are shown at the end, while other displays are
+// still output as they change.
+//
+static int PasteboardUpdates = 0;	//!< Nested pasteboard updates
+
+/** \brief Bring the terminal up to date
+ */
+static void UpdateScreen()
+{
+	if (Headless)
+	{
+		HeadlessUpdate();
+		return;
+	}
+	update_panels();
+	doupdate();
+}
+
+/** \brief The screen has changed
+ *
+ * Updates the terminal, unless a pasteboard update is in progress.
+ */
+static void ScreenChanged()
+{
+	if (PasteboardUpdates == 0)
+	{
+		UpdateScreen();
+	}
+}
+
+/** \brief A display has changed
+ *
+ * Updates the terminal, unless an update of this display
+ * (or the pasteboard) is in progress.
+ */
+static void DisplayChanged(
+	ncurses_struct *display)	//!< Display
+{
+	if (display->updates != 0)
+	{
+		display->pending = 1;
+		return;
+	}
+	ScreenChanged();
+}
+
+/** \brief Stop showing what is drawn on a display
+ *
+ * The screen is given a copy of the display, so what is
+ * drawn on the display itself isn't seen until ShowDisplay.
+ */
+static void HoldDisplay(
+	ncurses_struct *display)	//!< Display
+{
+	if (display->grid != 0)
+	{
+		display->shown_grid = new smg_grid(*display->grid);
+	}
+	else
+	{
+		display->shown = dupwin(display->win);
+		replace_panel(display->pan, display->shown);
+	}
+	display->pending = 0;
+}
+
+/** \brief Go back to showing the display itself
+ */
+static void ShowDisplay(
+	ncurses_struct *display)	//!< Display
+{
+	if (display->grid != 0)
+	{
+		delete display->shown_grid;
+		display->shown_grid = 0;
+	}
+	else
+	{
+		//
+		// The copy is what was moved if the display was
+		// pasted during the update.
+		//
+		mvwin(display->win, getbegy(display->shown),
+			getbegx(display->shown));
+		replace_panel(display->pan, display->win);
+		delwin(display->shown);
+		display->shown = 0;
+	}
+}
+
+/** \brief Start a batch of changes to a display
+ *
+ * Calls may be nested; nothing drawn on the display is
+ * output until the matching smg$end_display_update.
+ */
 int smg$begin_display_update(
 	struct ncurses_struct **display_id)
 {
-	return 1;
+	if ((*display_id)->updates++ == 0)
+	{
+		HoldDisplay(*display_id);
+	}
+	return SMG$_NORMAL;
 }
 
+/** \brief Start a batch of changes to the whole screen
+ *
+ * Calls may be nested; nothing is output until the
+ * matching smg$end_pasteboard_update.
+ */
 int smg$begin_pasteboard_update(
 	long *pasteboard_id)
 {
-	return 0;
+	PasteboardUpdates++;
+	return SMG$_NORMAL;
 }
 
 long smg$change_pbd_characteristics(
@@ -33,15 +420,22 @@ long smg$change_pbd_characteristics(
 {
 	if (width != 0)
 	{
-		*width  = COLS;
+		*width  = Headless ? ScreenColumns : COLS;
 	}
 	if (height != 0)
 	{
-		*height = LINES;
+		*height = Headless ? ScreenRows : LINES;
 	}
 	return SMG$_NORMAL;
 }
 
+/** \brief Create the pasteboard
+ *
+ * An output device of "NL:", or SMG_HEADLESS in the environment,
+ * gives a headless pasteboard instead of the terminal. Its size
+ * is taken from LINES and COLUMNS in the environment if they
+ * are set, otherwise it is 24 by 80.
+ */
 long smg$create_pasteboard(
 	long *pasteboard_id,
 	const std::string *output_device,
@@ -51,18 +445,43 @@ long smg$create_pasteboard(
 	long *type_of_terminal,
 	std::string *device_name)
 {
-	initscr();	// Initialize curses
-	cbreak();	// single character input mode
-	noecho();	// don't echo characters as they are typed
+	const char *frames = getenv("SMG_HEADLESS");
+
+	if (frames != 0 ||
+		(output_device != 0 &&
+		(*output_device == "NL:" || *output_device == "NLA0:")))
+	{
+		Headless = 1;
+		if (getenv("LINES") != 0 && atoi(getenv("LINES")) > 0)
+		{
+			ScreenRows = atoi(getenv("LINES"));
+		}
+		if (getenv("COLUMNS") != 0 && atoi(getenv("COLUMNS")) > 0)
+		{
+			ScreenColumns = atoi(getenv("COLUMNS"));
+		}
+		ScreenText.assign(ScreenRows * ScreenColumns, ' ');
+		ScreenAttr.assign(ScreenRows * ScreenColumns, 0);
+		if (frames != 0 && *frames != '\0')
+		{
+			FrameFile.open(frames);
+		}
+	}
+	else
+	{
+		initscr();	// Initialize curses
+		cbreak();	// single character input mode
+		noecho();	// don't echo characters as they are typed
+	}
 
 	*pasteboard_id = 1234;	// Just to make it non-zero
 	if (number_of_pasteboard_rows != 0)
 	{
-		*number_of_pasteboard_rows = COLS ;
+		*number_of_pasteboard_rows = Headless ? ScreenRows : LINES;
 	}
 	if (number_of_pasteboard_columns != 0)
 	{
-		*number_of_pasteboard_columns = LINES;
+		*number_of_pasteboard_columns = Headless ? ScreenColumns : COLS;
 	}
 
 	return SMG$_NORMAL;
@@ -83,6 +502,13 @@ long smg$create_virtual_display(
 	dwin->border = 0;
 	dwin->hpos = 0;
 	dwin->vpos = 0;
+	dwin->updates = 0;
+	dwin->pending = 0;
+	dwin->win = 0;
+	dwin->shown = 0;
+	dwin->pan = 0;
+	dwin->grid = 0;
+	dwin->shown_grid = 0;
 
 	if (display_attributes != 0 && display_attributes & SMG$M_BORDER)
 	{
@@ -92,12 +518,30 @@ long smg$create_virtual_display(
 	{
 		dwin->border = 0;
 	}
-	//
-	// Initilally created at (0,0)
-	//
-	dwin->win = newwin(dwin->height + dwin->border * 2,
-		dwin->width + dwin->border * 2, 0, 0);
-	dwin->pan = new_panel(dwin->win);
+
+	if (Headless)
+	{
+		smg_grid *grid = new smg_grid;
+
+		grid->rows = dwin->height + dwin->border * 2;
+		grid->columns = dwin->width + dwin->border * 2;
+		grid->text.assign(grid->rows * grid->columns, ' ');
+		grid->attr.assign(grid->rows * grid->columns, 0);
+		grid->row = 0;
+		grid->column = 0;
+		dwin->grid = grid;
+	}
+	else
+	{
+		//
+		// Initilally created at (0,0), and not visible until
+		// it is pasted.
+		//
+		dwin->win = newwin(dwin->height + dwin->border * 2,
+			dwin->width + dwin->border * 2, 0, 0);
+		dwin->pan = new_panel(dwin->win);
+		hide_panel(dwin->pan);
+	}
 
 	*display_id = dwin;
 
@@ -114,12 +558,35 @@ long smg$create_virtual_keyboard(
 	return SMG$_NORMAL;
 }
 
+/** \brief Throw away a display
+ */
+static void DeleteDisplay(
+	struct ncurses_struct **display_id)
+{
+	if ((*display_id)->updates != 0)
+	{
+		ShowDisplay(*display_id);
+	}
+	if ((*display_id)->grid != 0)
+	{
+		Pasted.erase(std::remove(Pasted.begin(), Pasted.end(), *display_id),
+			Pasted.end());
+		delete (*display_id)->grid;
+	}
+	else
+	{
+		del_panel((*display_id)->pan);
+		delwin((*display_id)->win);
+	}
+	delete *display_id;
+	*display_id = 0;
+	ScreenChanged();
+}
+
 long smg$delete_virtual_display(
 	struct ncurses_struct **display_id)
 {
-	del_panel((*display_id)->pan);
-	delwin((*display_id)->win);
-	update_panels();
+	DeleteDisplay(display_id);
 	return 1;
 }
 
@@ -134,26 +601,48 @@ int smg$draw_line(
 {
 	if (srow == erow)
 	{
-		mvwhline((*display_id)->win, srow, scolumn, 0, ecolumn - scolumn + 1);
+		DisplayLine(*display_id, srow, scolumn, ecolumn - scolumn + 1, 0);
 	}
 	else
 	{
-		mvwvline((*display_id)->win, srow, scolumn, 0, erow - srow + 1);
+		DisplayLine(*display_id, srow, scolumn, erow - srow + 1, 1);
 	}
+	DisplayChanged(*display_id);
 	return 0;
 }
 
-int smg$bend_display_update(
+/** \brief Finish a batch of changes to a display
+ *
+ * The screen is updated when the outermost batch finishes,
+ * if anything was drawn on the display during it.
+ */
+int smg$end_display_update(
 	struct ncurses_struct **display_id)
 {
-	wrefresh((*display_id)->win);
-	return 1;
+	if ((*display_id)->updates > 0 && --(*display_id)->updates == 0)
+	{
+		ShowDisplay(*display_id);
+		if ((*display_id)->pending)
+		{
+			(*display_id)->pending = 0;
+			ScreenChanged();
+		}
+	}
+	return SMG$_NORMAL;
 }
 
+/** \brief Finish a batch of changes to the whole screen
+ *
+ * The screen is updated when the outermost batch finishes.
+ */
 int smg$end_pasteboard_update(
 	long *pasteboard_id)
 {
-	return 0;
+	if (PasteboardUpdates > 0 && --PasteboardUpdates == 0)
+	{
+		ScreenChanged();
+	}
+	return SMG$_NORMAL;
 }
 
 long smg$erase_display(
@@ -167,14 +656,14 @@ long smg$erase_display(
 	 * If they gave us the easy way
 	 * No border, clear full window
 	 */
-	if ((*display_id)->border == 0 &
+	if ((*display_id)->border == 0 &&
 		start_row == 0 && end_row == 0 &&
 		start_column == 0 && end_column == 0)
 	{
 		/*
 		 * Wipe everything
 		 */
-		werase((*display_id)->win);
+		DisplayErase(*display_id);
 	}
 	else
 	{
@@ -183,14 +672,15 @@ long smg$erase_display(
 		 */
 		for (long row = start_row; row <= end_row; row++)
 		{
-			for (long column = start_column; row <= end_column; column++)
+			for (long column = start_column; column <= end_column; column++)
 			{
-				mvwaddch((*display_id)->win,
+				DisplayPut(*display_id,
 					row - 1 + (*display_id)->border,
-					column - 1 + (*display_id)->border, ' ');
+					column - 1 + (*display_id)->border, " ", 0);
 			}
 		}
 	}
+	DisplayChanged(*display_id);
 	return 1;
 }
 
@@ -199,16 +689,17 @@ int smg$erase_line(
 	int vpos,
 	int hpos)
 {
-	wmove((*display_id)->win, vpos, hpos);
-	wclrtoeol((*display_id)->win);
+	DisplayEraseLine(*display_id, vpos, hpos);
+	DisplayChanged(*display_id);
 	return 0;
 }
 
+/** \brief Output everything now, even during an update
+ */
 long smg$flush_buffer(
 	long *pasteboard_id)
 {
-	update_panels();
-	refresh();
+	UpdateScreen();
 	return 1;
 }
 
@@ -246,7 +737,21 @@ long smg$paste_virtual_display(
 {
 	(*display_id)->hpos = pasteboard_column - 1;
 	(*display_id)->vpos = pasteboard_row - 1;
-	mvwin((*display_id)->win, (*display_id)->vpos, (*display_id)->hpos);
+	if ((*display_id)->grid != 0)
+	{
+		//
+		// Pasting (again) puts it on top
+		//
+		Pasted.erase(std::remove(Pasted.begin(), Pasted.end(), *display_id),
+			Pasted.end());
+		Pasted.push_back(*display_id);
+	}
+	else
+	{
+		move_panel((*display_id)->pan, (*display_id)->vpos, (*display_id)->hpos);
+		show_panel((*display_id)->pan);
+	}
+	ScreenChanged();
 
 	return SMG$_NORMAL;
 }
@@ -255,9 +760,7 @@ long smg$pop_virtual_display(
 	struct ncurses_struct **display_id,
 	const long *pasteboard_id)
 {
-	del_panel((*display_id)->pan);
-	delwin((*display_id)->win);
-	update_panels();
+	DeleteDisplay(display_id);
 	return 1;
 }
 
@@ -273,18 +776,48 @@ int smg$put_chars(
 	int flag,			/**< Flag value? */
 	int attr)			/**< Attributes */
 {
-	if (attr & SMG$M_BOLD)
+	DisplayPut(*display_id, y + (*display_id)->border,
+		x + (*display_id)->border, str, attr);
+	DisplayChanged(*display_id);
+	return 1;
+}
+
+/** \brief Read a single key
+ *
+ * The terminator code is the character typed, or one of the
+ * SMG$K_TRM_ codes for other keys, SMG$K_TRM_TIMEOUT if a
+ * timeout (in seconds) was given and nothing was typed in
+ * that time.
+ */
+long smg$read_keystroke(
+	long *keyboard_id,
+	long *terminator_code,
+	const std::string *prompt,
+	const long *timeout,
+	struct ncurses_struct **display_id)
+{
+	if (prompt != 0 && display_id != 0 && *display_id != 0)
 	{
-		wattron((*display_id)->win, A_STANDOUT);
+		if ((*display_id)->grid != 0)
+		{
+			DisplayPut(*display_id, (*display_id)->grid->row,
+				(*display_id)->grid->column, *prompt, 0);
+		}
+		else
+		{
+			waddstr((*display_id)->win, prompt->c_str());
+		}
 	}
-	if (attr & SMG$M_REVERSE)
+	UpdateScreen();
+
+	long key = basic::TerminalKeyboard().Read(
+		(timeout != 0 && *timeout > 0) ? *timeout * 1000 : -1);
+
+	if (terminator_code != 0)
 	{
-		wattron((*display_id)->win, A_REVERSE);
+		*terminator_code = key;
 	}
-
-	mvwaddstr((*display_id)->win, y + (*display_id)->border, x + (*display_id)->border, str.c_str());
-	wattrset((*display_id)->win, 0);
-	return 1;
+	return (key == SMG$K_TRM_CANCELLED) ? SMG$_EOF : SMG$_NORMAL;
 }
 
 long smg$set_cursor_abs(
@@ -292,7 +825,15 @@ long smg$set_cursor_abs(
 	long x,
 	long y)
 {
-	wmove((*display_id)->win, x, y);
+	if ((*display_id)->grid != 0)
+	{
+		(*display_id)->grid->row = x;
+		(*display_id)->grid->column = y;
+	}
+	else
+	{
+		wmove((*display_id)->win, x, y);
+	}
 	return 1;
 }
 
@@ -303,3 +844,36 @@ long smg$set_cursor_mode(
 	return SMG$_NORMAL;
 }
 
+/** \brief What the headless pasteboard shows
+ *
+ * Not part of SMG. Returns the last frame output, in the same
+ * form it is written to the SMG_HEADLESS file, or an empty
+ * string when using a terminal.
+ */
+std::string smg_headless_frame()
+{
+	if (!Headless)
+	{
+		return "";
+	}
+	return FrameText(ScreenText, ScreenAttr);
+}
+
+/** \brief Number of frames the headless pasteboard has output
+ *
+ * Not part of SMG.
+ */
+long smg_headless_frames()
+{
+	return Frames;
+}
+
+/** \brief Number of cells changed over all headless frames
+ *
+ * Not part of SMG. This is roughly what a terminal would
+ * have had sent to it.
+ */
+long smg_headless_cells()
+{
+	return CellsChanged;
+}
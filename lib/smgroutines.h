@@ -14,6 +14,8 @@
 #include <string>
 #include "smgdef.h"
 
+struct smg_grid;
+
 //! \brief Special structure used by this implementation
 //!
 //! This structure is pointed to by the DISPLAY_ID variable.
@@ -28,13 +30,18 @@ struct ncurses_struct
 	long height;			//!< Height to create at
 	long hpos;			//!< Horozontal position for window
 	long vpos;			//!< Vertical position of window
+	int updates;			//!< Nested display updates
+	int pending;			//!< Changed during the update
+	WINDOW *shown;			//!< What the screen shows during an update
+	smg_grid *grid;			//!< Contents, on a headless pasteboard
+	smg_grid *shown_grid;		//!< What the screen shows during an update
 };
 
 //
 // Function prototypes
 //
 int smg$begin_display_update(
-	struct ncurses_struct *display_id);
+	struct ncurses_struct **display_id);
 
 int smg$begin_pasteboard_update(
 	long *pasteboard_id);
@@ -76,14 +83,14 @@ long smg$delete_virtual_display(
 	struct ncurses_struct **display_id);
 
 int smg$draw_line(
-	struct ncurses_struct *display_id,
+	struct ncurses_struct **display_id,
 	int srow,
 	int scolumn,
 	int erow,
 	int ecolumn);
 
 int smg$end_display_update(
-	struct ncurses_struct *display_id);
+	struct ncurses_struct **display_id);
 
 int smg$end_pasteboard_update(
 	long *pasteboard_id);
@@ -131,6 +138,13 @@ int smg$put_chars(
 	int flag = 0,			/**< Flag value? */
 	int attr = 0);			/**< Attributes */
 
+long smg$read_keystroke(
+	long *keyboard_id,
+	long *terminator_code,
+	const std::string *prompt = 0,
+	const long *timeout = 0,
+	struct ncurses_struct **display_id = 0);
+
 long smg$set_cursor_abs(
 	struct ncurses_struct **display_id,
 	long x,
@@ -140,4 +154,11 @@ long smg$set_cursor_mode(
 	long *pasteboard_id,
 	long flags);
 
+//
+// Headless pasteboard (not part of SMG)
+//
+std::string smg_headless_frame();
+long smg_headless_frames();
+long smg_headless_cells();
+
 #endif
@@ -0,0 +1,282 @@
+/** \file strsearch.cc
+ * \brief Substring searches for INSTR and POS
+ *
+ *	The method depends on the length of the search string:
+ *	- One character uses memchr.
+ *	- Short strings look for the first and last characters
+ *	  together, 16 positions at a time (SSE2), and only compare
+ *	  the whole string where both match.
+ *	- Long strings use Horspool, which can skip ahead by up to
+ *	  the length of the search string.
+ */
+
+//
+// Include files
+//
+#include <cstring>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "bstring.h"
+
+/**
+ * \brief Longest search string handled by the short string search
+ */
+static const size_t ShortPattern = 32;
+
+/**
+ * \brief Search for a single character
+ */
+static size_t FindChar(
+	const char* Text,	/**< Text to search */
+	size_t Length,		/**< Length of text */
+	char Pattern,		/**< Character to look for */
+	size_t Start		/**< Where to start looking */
+)
+{
+	const void* Found = memchr(Text + Start, Pattern, Length - Start);
+
+	return Found ? (const char*)Found - Text : std::string::npos;
+}
+
+/**
+ * \brief Search for a short string (first and last character filter)
+ */
+static size_t FindShort(
+	const char* Text,	/**< Text to search */
+	size_t Length,		/**< Length of text */
+	const char* Pattern,	/**< String to look for */
+	size_t PatLength,	/**< Length of the string (2 or more) */
+	size_t Start		/**< Where to start looking */
+)
+{
+	size_t Last = PatLength - 1;
+	size_t Position = Start;
+
+#if defined(__SSE2__)
+	const __m128i First = _mm_set1_epi8(Pattern[0]);
+	const __m128i Final = _mm_set1_epi8(Pattern[Last]);
+
+	for (; Position + Last + 16 <= Length; Position += 16)
+	{
+		__m128i Front = _mm_loadu_si128(
+			(const __m128i*)(Text + Position));
+		__m128i Back = _mm_loadu_si128(
+			(const __m128i*)(Text + Position + Last));
+		unsigned Mask = _mm_movemask_epi8(_mm_and_si128(
+			_mm_cmpeq_epi8(Front, First), _mm_cmpeq_epi8(Back, Final)));
+
+		while (Mask != 0)
+		{
+			size_t Offset = Position + __builtin_ctz(Mask);
+
+			if (memcmp(Text + Offset + 1, Pattern + 1, Last - 1) == 0)
+			{
+				return Offset;
+			}
+			Mask &= Mask - 1;
+		}
+	}
+#endif
+
+	//
+	// What is left (or everything, without SSE2)
+	//
+	while (Position + Last < Length)
+	{
+		const char* Found = (const char*)memchr(Text + Position,
+			Pattern[0], Length - Last - Position);
+
+		if (Found == 0)
+		{
+			break;
+		}
+		Position = Found - Text;
+		if ((Text[Position + Last] == Pattern[Last]) &&
+			(memcmp(Text + Position + 1, Pattern + 1, Last - 1) == 0))
+		{
+			return Position;
+		}
+		Position++;
+	}
+
+	return std::string::npos;
+}
+
+/**
+ * \brief Build the Horspool shift table
+ */
+static void HorspoolTable(
+	const char* Pattern,	/**< String to look for */
+	size_t PatLength,	/**< Length of the string */
+	size_t* Skip		/**< Returned shifts (256) */
+)
+{
+	for (int loop = 0; loop < 256; loop++)
+	{
+		Skip[loop] = PatLength;
+	}
+	for (size_t loop = 0; loop + 1 < PatLength; loop++)
+	{
+		Skip[(unsigned char)Pattern[loop]] = PatLength - 1 - loop;
+	}
+}
+
+/**
+ * \brief Search for a long string (Horspool)
+ */
+static size_t FindLong(
+	const char* Text,	/**< Text to search */
+	size_t Length,		/**< Length of text */
+	const char* Pattern,	/**< String to look for */
+	size_t PatLength,	/**< Length of the string */
+	size_t Start,		/**< Where to start looking */
+	const size_t* Skip	/**< Shift table */
+)
+{
+	size_t Last = PatLength - 1;
+	char Final = Pattern[Last];
+
+	for (size_t Position = Start; Position + Last < Length; )
+	{
+		char Check = Text[Position + Last];
+
+		if ((Check == Final) &&
+			(memcmp(Text + Position, Pattern, Last) == 0))
+		{
+			return Position;
+		}
+		Position += Skip[(unsigned char)Check];
+	}
+
+	return std::string::npos;
+}
+
+/**
+ * \brief Find a string in some text
+ *
+ * \return Offset of the first match at or after Start,
+ *	or std::string::npos if there isn't one.
+ */
+size_t basic::Find(
+	string_view Text,	/**< Text to search */
+	string_view Pattern,	/**< String to look for */
+	size_t Start		/**< Offset to start looking at */
+)
+{
+	if ((Start > Text.size()) || (Pattern.size() > Text.size() - Start))
+	{
+		return std::string::npos;
+	}
+
+	switch (Pattern.size())
+	{
+	case 0:
+		return Start;
+
+	case 1:
+		return FindChar(Text.data(), Text.size(), Pattern[0], Start);
+	}
+
+	if (Pattern.size() <= ShortPattern)
+	{
+		return FindShort(Text.data(), Text.size(),
+			Pattern.data(), Pattern.size(), Start);
+	}
+
+	size_t Skip[256];
+	HorspoolTable(Pattern.data(), Pattern.size(), Skip);
+	return FindLong(Text.data(), Text.size(),
+		Pattern.data(), Pattern.size(), Start, Skip);
+}
+
+/**
+ * \brief Prepare a search string
+ */
+basic::Needle::Needle(
+	string_view NewPattern	/**< String to look for */
+) : Pattern(NewPattern.data(), NewPattern.size())
+{
+	if (Pattern.size() > ShortPattern)
+	{
+		HorspoolTable(Pattern.data(), Pattern.size(), Skip);
+	}
+}
+
+/**
+ * \brief Find the prepared string in some text
+ *
+ * \return Offset of the first match at or after Start,
+ *	or std::string::npos if there isn't one.
+ */
+size_t basic::Needle::Find(
+	string_view Text,	/**< Text to search */
+	size_t Start		/**< Offset to start looking at */
+) const
+{
+	if (Pattern.size() <= ShortPattern)
+	{
+		return basic::Find(Text, Pattern, Start);
+	}
+
+	if ((Start > Text.size()) || (Pattern.size() > Text.size() - Start))
+	{
+		return std::string::npos;
+	}
+	return FindLong(Text.data(), Text.size(),
+		Pattern.data(), Pattern.size(), Start, Skip);
+}
+
+/**
+ * \brief INSTR()
+ *
+ *	A starting position less than 1 is taken as 1.
+ *
+ * \return Position (from 1) of the search string in the base
+ *	string, or 0 if it isn't there.
+ */
+int basic::instr(
+	long Start,			/**< Position to start looking */
+	string_view BaseString,		/**< String to search */
+	string_view SearchString	/**< String to look for */
+)
+{
+	size_t Found = Find(BaseString, SearchString, (Start < 1) ? 0 : Start - 1);
+
+	return (Found == std::string::npos) ? 0 : Found + 1;
+}
+
+/**
+ * \brief INSTR() with a prepared search string
+ *
+ * \return Position (from 1) of the search string in the base
+ *	string, or 0 if it isn't there.
+ */
+int basic::instr(
+	long Start,			/**< Position to start looking */
+	string_view BaseString,		/**< String to search */
+	const Needle& SearchString	/**< String to look for */
+)
+{
+	size_t Found = SearchString.Find(BaseString, (Start < 1) ? 0 : Start - 1);
+
+	return (Found == std::string::npos) ? 0 : Found + 1;
+}
+
+/**
+ * \brief INSTR() on C strings
+ *
+ * \return Position (from 1) of the search string in the base
+ *	string, or 0 if it isn't there.
+ */
+int basic::instr(
+	long Start,		/**< Position to start looking */
+	char* Base,		/**< String to search */
+	char* Search		/**< String to look for */
+)
+{
+	return instr(Start, string_view(Base), string_view(Search));
+}
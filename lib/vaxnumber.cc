@@ -0,0 +1,255 @@
+/** \file vaxnumber.cc
+ * \brief VAX numeric storage formats
+ *
+ *	Conversions of whole arrays, for converting a file full of
+ *	records in one pass. The floating point loops only call
+ *	the branch free inline routines in vaxnumber.h, so the
+ *	compiler can vectorize them. The packed decimal loops
+ *	can't be: each value is its own loop over a run time
+ *	number of digits.
+ */
+
+//
+// Include files
+//
+#include "vaxnumber.h"
+#include "basiccontext.h"
+
+/**
+ * \brief Convert an array of stored F_floating values
+ */
+void basic::FfloatToIeee(
+	const char* Source,	/**< Stored values */
+	float* Dest,		/**< Converted values */
+	size_t Count		/**< Number of values */
+)
+{
+	for (size_t loop = 0; loop < Count; loop++)
+	{
+		uint32_t Raw;
+		memcpy(&Raw, Source + loop * 4, sizeof(Raw));
+		Dest[loop] = FfloatToIeee(Raw);
+	}
+}
+
+/**
+ * \brief Convert an array of floats to F_floating
+ *
+ * Throws "Floating point error or overflow" if any value
+ * is too large (after converting all of them).
+ */
+void basic::IeeeToFfloat(
+	const float* Source,	/**< Values to convert */
+	char* Dest,		/**< Stored values */
+	size_t Count		/**< Number of values */
+)
+{
+	int Bad = 0;
+
+	for (size_t loop = 0; loop < Count; loop++)
+	{
+		uint32_t Raw = IeeeToFfloat(Source[loop], Bad);
+		memcpy(Dest + loop * 4, &Raw, sizeof(Raw));
+	}
+
+	if (Bad)
+	{
+		throw BasicError(ErrFloatOverflow);
+	}
+}
+
+/**
+ * \brief Convert an array of stored D_floating values
+ */
+void basic::DfloatToIeee(
+	const char* Source,	/**< Stored values */
+	double* Dest,		/**< Converted values */
+	size_t Count		/**< Number of values */
+)
+{
+	for (size_t loop = 0; loop < Count; loop++)
+	{
+		uint64_t Raw;
+		memcpy(&Raw, Source + loop * 8, sizeof(Raw));
+		Dest[loop] = DfloatToIeee(Raw);
+	}
+}
+
+/**
+ * \brief Convert an array of doubles to D_floating
+ *
+ * Throws "Floating point error or overflow" if any value
+ * is too large (after converting all of them).
+ */
+void basic::IeeeToDfloat(
+	const double* Source,	/**< Values to convert */
+	char* Dest,		/**< Stored values */
+	size_t Count		/**< Number of values */
+)
+{
+	int Bad = 0;
+
+	for (size_t loop = 0; loop < Count; loop++)
+	{
+		uint64_t Raw = IeeeToDfloat(Source[loop], Bad);
+		memcpy(Dest + loop * 8, &Raw, sizeof(Raw));
+	}
+
+	if (Bad)
+	{
+		throw BasicError(ErrFloatOverflow);
+	}
+}
+
+/**
+ * \brief Convert an array of stored G_floating values
+ */
+void basic::GfloatToIeee(
+	const char* Source,	/**< Stored values */
+	double* Dest,		/**< Converted values */
+	size_t Count		/**< Number of values */
+)
+{
+	for (size_t loop = 0; loop < Count; loop++)
+	{
+		uint64_t Raw;
+		memcpy(&Raw, Source + loop * 8, sizeof(Raw));
+		Dest[loop] = GfloatToIeee(Raw);
+	}
+}
+
+/**
+ * \brief Convert an array of doubles to G_floating
+ *
+ * Throws "Floating point error or overflow" if any value
+ * is too large (after converting all of them).
+ */
+void basic::IeeeToGfloat(
+	const double* Source,	/**< Values to convert */
+	char* Dest,		/**< Stored values */
+	size_t Count		/**< Number of values */
+)
+{
+	int Bad = 0;
+
+	for (size_t loop = 0; loop < Count; loop++)
+	{
+		uint64_t Raw = IeeeToGfloat(Source[loop], Bad);
+		memcpy(Dest + loop * 8, &Raw, sizeof(Raw));
+	}
+
+	if (Bad)
+	{
+		throw BasicError(ErrFloatOverflow);
+	}
+}
+
+/**
+ * \brief Convert an array of packed decimal numbers
+ *
+ * Throws "Data format error" if any of them has a bad
+ * digit or sign (after converting all of them).
+ */
+void basic::PackedToInteger(
+	const char* Source,	/**< Packed numbers */
+	int Digits,		/**< Digits in each (up to 18) */
+	int64_t* Dest,		/**< Converted values */
+	size_t Count		/**< Number of values */
+)
+{
+	size_t Bytes = PackedBytes(Digits);
+	int Bad = 0;
+
+	for (size_t loop = 0; loop < Count; loop++)
+	{
+		Dest[loop] = PackedToInteger<int64_t>(Source + loop * Bytes,
+			Digits, Bad);
+	}
+
+	if (Bad)
+	{
+		throw BasicError(ErrDataFormat);
+	}
+}
+
+/**
+ * \brief Convert an array of integers to packed decimal
+ *
+ * Throws "Decimal error or overflow" if any of them has too
+ * many digits (after converting all of them).
+ */
+void basic::IntegerToPacked(
+	const int64_t* Source,	/**< Values to convert */
+	int Digits,		/**< Digits in each (up to 18) */
+	char* Dest,		/**< Packed numbers */
+	size_t Count		/**< Number of values */
+)
+{
+	size_t Bytes = PackedBytes(Digits);
+	int Bad = 0;
+
+	for (size_t loop = 0; loop < Count; loop++)
+	{
+		IntegerToPacked<int64_t>(Source[loop], Dest + loop * Bytes,
+			Digits, Bad);
+	}
+
+	if (Bad)
+	{
+		throw BasicError(ErrDecimalOverflow);
+	}
+}
+
+/**
+ * \brief Store a MAP member as F_floating
+ */
+void basic::FfloatStorage::Put(
+	char* Data,		/**< Where to store it */
+	float Value		/**< Value to store */
+)
+{
+	int Bad = 0;
+	uint32_t Raw = IeeeToFfloat(Value, Bad);
+
+	if (Bad)
+	{
+		throw BasicError(ErrFloatOverflow);
+	}
+	memcpy(Data, &Raw, sizeof(Raw));
+}
+
+/**
+ * \brief Store a MAP member as D_floating
+ */
+void basic::DfloatStorage::Put(
+	char* Data,		/**< Where to store it */
+	double Value		/**< Value to store */
+)
+{
+	int Bad = 0;
+	uint64_t Raw = IeeeToDfloat(Value, Bad);
+
+	if (Bad)
+	{
+		throw BasicError(ErrFloatOverflow);
+	}
+	memcpy(Data, &Raw, sizeof(Raw));
+}
+
+/**
+ * \brief Store a MAP member as G_floating
+ */
+void basic::GfloatStorage::Put(
+	char* Data,		/**< Where to store it */
+	double Value		/**< Value to store */
+)
+{
+	int Bad = 0;
+	uint64_t Raw = IeeeToGfloat(Value, Bad);
+
+	if (Bad)
+	{
+		throw BasicError(ErrFloatOverflow);
+	}
+	memcpy(Data, &Raw, sizeof(Raw));
+}
@@ -0,0 +1,413 @@
+/**\file vaxnumber.h
+ * \brief VAX numeric storage formats
+ *
+ *	Data files written by VAX BASIC hold numbers in the VAX
+ *	formats: F_floating (SINGLE), D_floating (DOUBLE),
+ *	G_floating (GFLOAT) and packed decimal (DECIMAL). These
+ *	routines convert between those and the native formats.
+ *
+ *	The VAX floating formats are stored as 16 bit words, least
+ *	significant word first, each word little endian, with the
+ *	sign, exponent and top of the fraction in the first word.
+ *	The value is 0.1fff... times 2 to the (exponent - bias).
+ *	An exponent of zero is zero (a set sign bit there would be
+ *	a reserved operand on the VAX, and is also taken as zero).
+ *
+ *	Packed decimal is one digit per nibble, most significant
+ *	first, with the sign in the last nibble (0x0C positive,
+ *	0x0D negative). It takes (digits / 2 + 1) bytes.
+ *
+ *	The per value routines here are inline and branch free, so
+ *	that the loops converting whole arrays of floating point
+ *	values in vaxnumber.cc can be vectorized by the compiler.
+ *	Selections are done with masks rather than ?:, which GCC
+ *	won't always if-convert. Errors are collected in a flag
+ *	instead of being thrown from the middle of the loop.
+ *
+ * \bug Assumes a little endian host.
+ */
+#ifndef _VAXNUMBER_H_
+#define _VAXNUMBER_H_
+
+//
+// include files
+//
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+namespace basic
+{
+//
+// Word order
+//
+
+/**
+ * \brief Swap the 16 bit words of a 32 bit VAX value
+ *
+ * Turns the stored form into one with the sign in the top bit,
+ * and back again.
+ */
+inline uint32_t VaxSwap32(uint32_t Bits)
+{
+	return (Bits << 16) | (Bits >> 16);
+}
+
+/**
+ * \brief Reverse the 16 bit words of a 64 bit VAX value
+ */
+inline uint64_t VaxSwap64(uint64_t Bits)
+{
+	return ((Bits & 0xffff) << 48) |
+		((Bits & 0xffff0000) << 16) |
+		((Bits >> 16) & 0xffff0000) |
+		(Bits >> 48);
+}
+
+/**
+ * \brief 2 to the power N, as a double (-1022 <= N <= 1023)
+ */
+inline double VaxPower2(int N)
+{
+	uint64_t Bits = (uint64_t)(1023 + N) << 52;
+	double Value;
+
+	memcpy(&Value, &Bits, sizeof(Value));
+	return Value;
+}
+
+//
+// F_floating: 1 sign, 8 exponent (bias 128), 23 fraction
+// D_floating: 1 sign, 8 exponent (bias 128), 55 fraction
+// G_floating: 1 sign, 11 exponent (bias 1024), 52 fraction
+//
+// Relative to IEEE, the VAX exponent is 2 higher for the same
+// value. F and D are both widened to an IEEE double, which
+// has the range to hold every F and D value.
+//
+
+/**
+ * \brief Convert a stored F_floating to a float
+ */
+inline float FfloatToIeee(
+	uint32_t Raw		/**< Value as stored */
+)
+{
+	uint32_t Bits = VaxSwap32(Raw);
+	uint64_t Exponent = (Bits >> 23) & 0xff;
+	uint64_t Wide = ((uint64_t)(Bits & 0x80000000) << 32) |
+		((Exponent + 1023 - 129) << 52) |
+		((uint64_t)(Bits & 0x007fffff) << 29);
+	double Value;
+
+	Wide &= -(uint64_t)(Exponent != 0);
+	memcpy(&Value, &Wide, sizeof(Value));
+	return (float)Value;
+}
+
+/**
+ * \brief Convert a float to a stored F_floating
+ *
+ * Values too small for F_floating become zero.
+ */
+inline uint32_t IeeeToFfloat(
+	float Value,		/**< Value to convert */
+	int &Bad		/**< Set on overflow or NaN */
+)
+{
+	double Wide = Value;
+	uint64_t Bits;
+
+	memcpy(&Bits, &Wide, sizeof(Bits));
+	int64_t Exponent = (int64_t)((Bits >> 52) & 0x7ff) - (1023 - 129);
+	uint32_t Result = (uint32_t)((Bits >> 32) & 0x80000000) |
+		((uint32_t)Exponent << 23) |
+		(uint32_t)((Bits >> 29) & 0x007fffff);
+
+	Bad |= (Exponent > 255);
+	Result = (Exponent > 0) ? Result : 0;
+	return VaxSwap32(Result);
+}
+
+/**
+ * \brief Convert a stored D_floating to a double
+ *
+ * The 55 bit fraction is rounded (to even) to 52 bits.
+ */
+inline double DfloatToIeee(
+	uint64_t Raw		/**< Value as stored */
+)
+{
+	uint64_t Bits = VaxSwap64(Raw);
+	uint64_t Exponent = (Bits >> 55) & 0xff;
+	uint64_t Fraction = Bits & 0x007fffffffffffffULL;
+	uint64_t Rounded = (Fraction + 3 + ((Fraction >> 3) & 1)) >> 3;
+	uint64_t Wide = ((Bits & 0x8000000000000000ULL) |
+		((Exponent + 1023 - 129) << 52)) + Rounded;
+	double Value;
+
+	Wide = (Exponent != 0) ? Wide : 0;
+	memcpy(&Value, &Wide, sizeof(Value));
+	return Value;
+}
+
+/**
+ * \brief Convert a double to a stored D_floating
+ *
+ * Values too small for D_floating become zero.
+ */
+inline uint64_t IeeeToDfloat(
+	double Value,		/**< Value to convert */
+	int &Bad		/**< Set on overflow or NaN */
+)
+{
+	uint64_t Bits;
+
+	memcpy(&Bits, &Value, sizeof(Bits));
+	int64_t Exponent = (int64_t)((Bits >> 52) & 0x7ff) - (1023 - 129);
+	uint64_t Result = (Bits & 0x8000000000000000ULL) |
+		((uint64_t)Exponent << 55) |
+		((Bits & 0x000fffffffffffffULL) << 3);
+
+	Bad |= (Exponent > 255);
+	Result = (Exponent > 0) ? Result : 0;
+	return VaxSwap64(Result);
+}
+
+/**
+ * \brief Convert a stored G_floating to a double
+ *
+ * The smallest G_floating values are IEEE denormals.
+ */
+inline double GfloatToIeee(
+	uint64_t Raw		/**< Value as stored */
+)
+{
+	uint64_t Bits = VaxSwap64(Raw);
+	uint64_t Exponent = (Bits >> 52) & 0x7ff;
+	uint64_t Normal = Bits - (2ULL << 52);
+	uint64_t Scaled = (Bits & 0x800fffffffffffffULL) | ((Exponent + 1000) << 52);
+	double Tiny;
+
+	memcpy(&Tiny, &Scaled, sizeof(Tiny));
+	Tiny *= VaxPower2(-1002);
+	memcpy(&Scaled, &Tiny, sizeof(Scaled));
+
+	//
+	// Pick with masks rather than ?:, so the loops over
+	// arrays of these still vectorize.
+	//
+	uint64_t IsNormal = -(uint64_t)(Exponent > 2);
+	uint64_t Wide = ((Normal & IsNormal) | (Scaled & ~IsNormal)) &
+		-(uint64_t)(Exponent != 0);
+	double Value;
+
+	memcpy(&Value, &Wide, sizeof(Value));
+	return Value;
+}
+
+/**
+ * \brief Convert a double to a stored G_floating
+ */
+inline uint64_t IeeeToGfloat(
+	double Value,		/**< Value to convert */
+	int &Bad		/**< Set on overflow or NaN */
+)
+{
+	uint64_t Bits;
+
+	memcpy(&Bits, &Value, sizeof(Bits));
+	int Denormal = ((Bits >> 52) & 0x7ff) == 0;
+	double Scaled = Value * VaxPower2(64 * Denormal);
+
+	memcpy(&Bits, &Scaled, sizeof(Bits));
+	int64_t Exponent = (int64_t)((Bits >> 52) & 0x7ff) + 2 -
+		64 * Denormal;
+	uint64_t Result = (Bits & 0x800fffffffffffffULL) |
+		((uint64_t)Exponent << 52);
+
+	Bad |= (Exponent > 2047);
+	Result &= -(uint64_t)(Exponent > 0);
+	return VaxSwap64(Result);
+}
+
+//
+// Packed decimal
+//
+
+/**
+ * \brief Bytes used by a packed decimal number
+ */
+inline size_t PackedBytes(
+	int Digits		/**< Number of digits */
+)
+{
+	return Digits / 2 + 1;
+}
+
+/**
+ * \brief Convert a packed decimal number to an integer
+ *
+ * I must be wide enough for the number of digits (18 for
+ * int64_t).
+ */
+template <class I>
+inline I PackedToInteger(
+	const char* Source,	/**< Packed number */
+	int Digits,		/**< Number of digits */
+	int &Bad		/**< Set on a bad digit or sign */
+)
+{
+	const unsigned char* Byte = (const unsigned char*)Source;
+	size_t Last = Digits / 2;
+	I Value = 0;
+
+	for (size_t loop = 0; loop < Last; loop++)
+	{
+		unsigned int High = Byte[loop] >> 4;
+		unsigned int Low = Byte[loop] & 0x0f;
+
+		Bad |= (High > 9) | (Low > 9);
+		Value = Value * 100 + (High * 10 + Low);
+	}
+
+	unsigned int High = Byte[Last] >> 4;
+	unsigned int Sign = Byte[Last] & 0x0f;
+
+	Bad |= (High > 9) | (Sign < 10);
+	Value = Value * 10 + High;
+
+	return ((Sign == 0x0b) || (Sign == 0x0d)) ? -Value : Value;
+}
+
+/**
+ * \brief Convert an integer to a packed decimal number
+ */
+template <class I>
+inline void IntegerToPacked(
+	I Value,		/**< Value to convert */
+	char* Dest,		/**< Where to put it */
+	int Digits,		/**< Number of digits */
+	int &Bad		/**< Set if it doesn't fit */
+)
+{
+	unsigned char* Byte = (unsigned char*)Dest;
+	size_t Last = Digits / 2;
+	unsigned char Sign = (Value < 0) ? 0x0d : 0x0c;
+	I Magnitude = (Value < 0) ? -Value : Value;
+
+	Byte[Last] = (unsigned char)((Magnitude % 10) << 4) | Sign;
+	Magnitude /= 10;
+
+	for (size_t loop = Last; loop-- > 0; )
+	{
+		unsigned int Pair = (unsigned int)(Magnitude % 100);
+		Byte[loop] = (unsigned char)(((Pair / 10) << 4) | (Pair % 10));
+		Magnitude /= 100;
+	}
+
+	//
+	// An even number of digits leaves the top nibble unused,
+	// and it must be zero.
+	//
+	if ((Digits & 1) == 0)
+	{
+		Bad |= (Byte[0] >> 4) != 0;
+		Byte[0] &= 0x0f;
+	}
+	Bad |= (Magnitude != 0);
+}
+
+//
+// Whole arrays (vaxnumber.cc)
+//
+void FfloatToIeee(const char* Source, float* Dest, size_t Count);
+void IeeeToFfloat(const float* Source, char* Dest, size_t Count);
+void DfloatToIeee(const char* Source, double* Dest, size_t Count);
+void IeeeToDfloat(const double* Source, char* Dest, size_t Count);
+void GfloatToIeee(const char* Source, double* Dest, size_t Count);
+void IeeeToGfloat(const double* Source, char* Dest, size_t Count);
+void PackedToInteger(const char* Source, int Digits,
+	int64_t* Dest, size_t Count);
+void IntegerToPacked(const int64_t* Source, int Digits,
+	char* Dest, size_t Count);
+
+//
+// Storage formats for MAP members (see basicmap.h)
+//
+
+/**
+ * \brief Stored in the native format
+ */
+template <class T>
+struct NativeStorage
+{
+	static const size_t Size = sizeof(T);	/**< \brief Bytes used */
+
+	//! Fetch value
+	static T Get(const char* Data)
+	{
+		T Value;
+		memcpy(&Value, Data, sizeof(T));
+		return Value;
+	}
+	//! Store value
+	static void Put(char* Data, T Value)
+	{
+		memcpy(Data, &Value, sizeof(T));
+	}
+};
+
+/**
+ * \brief Stored as F_floating (SINGLE)
+ */
+struct FfloatStorage
+{
+	static const size_t Size = 4;	/**< \brief Bytes used */
+
+	//! Fetch value
+	static float Get(const char* Data)
+	{
+		uint32_t Raw;
+		memcpy(&Raw, Data, sizeof(Raw));
+		return FfloatToIeee(Raw);
+	}
+	static void Put(char* Data, float Value);
+};
+
+/**
+ * \brief Stored as D_floating (DOUBLE)
+ */
+struct DfloatStorage
+{
+	static const size_t Size = 8;	/**< \brief Bytes used */
+
+	//! Fetch value
+	static double Get(const char* Data)
+	{
+		uint64_t Raw;
+		memcpy(&Raw, Data, sizeof(Raw));
+		return DfloatToIeee(Raw);
+	}
+	static void Put(char* Data, double Value);
+};
+
+/**
+ * \brief Stored as G_floating (GFLOAT)
+ */
+struct GfloatStorage
+{
+	static const size_t Size = 8;	/**< \brief Bytes used */
+
+	//! Fetch value
+	static double Get(const char* Data)
+	{
+		uint64_t Raw;
+		memcpy(&Raw, Data, sizeof(Raw));
+		return GfloatToIeee(Raw);
+	}
+	static void Put(char* Data, double Value);
+};
+}
+
+#endif
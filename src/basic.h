@@ -21,7 +21,11 @@
 #include <fstream>
 #include <string>
 #include <map>
+#include <set>
 #include <list>
+#include <vector>
+
+#include "translate.h"
 
 //
 // These functions are refered to by the local include files
@@ -49,7 +53,7 @@ extern int yydebug;		/**< \brief Debug flag */
 extern std::list<std::string> include;	/**< \brief List of paths to search for include files */
 
 //
-// External stuff in main.c
+// External stuff in translate.cc
 //
 extern VariableList *Variables;	/**< \brief Variable table */
 extern std::map<std::string, int> node_type;	//!< \brief ?? Node types ??
@@ -79,10 +83,23 @@ extern int DebugDump;		/**< \brief Dump out debugging information */
 extern int DebugDumpOne;	/**< \brief Dump out additional debugging information */
 extern int VariableDump;	/**< \brief Dump variable tables out */
 extern int PositionDump;	/**< \brief Dump out names of stages as they start */
+extern int NarrowFlag;		/**< \brief Narrow integral REAL variables to LONG */
+extern int NarrowReport;	/**< \brief Report variables that were narrowed */
+extern int ProfileFlag;		/**< \brief Count hits and time for each BASIC line */
+extern int LineDirectives;	/**< \brief Write #line directives for the BASIC source */
+extern std::string ChainName;	/**< \brief Register main program for CHAIN under this name */
+extern std::map<std::string, long> MapSizes;	/**< \brief Size of each byte exact MAP/COMMON, by name */
+extern std::set<std::string> MapMembers;	/**< \brief Names of the members of byte exact MAP/COMMONs */
 
 extern std::ostream* OutFile;	/**< \brief Output C++ channel */
+extern std::ostream* ErrorFile;	/**< \brief Channel for messages */
+extern std::string OutName;	/**< \brief Name of the C++ output, for #line directives */
+extern long OutLines;		/**< \brief Lines written to OutFile so far */
 
 void DoProgram(Node *Program);	/* Main interface for parse/lex stages */
+int TimedParse();		/* Parse (and translate) the program */
+void initialize_node_type();	/* Fill in node_type */
+void WriteHeader(std::ostream& os, const char* Name);	/* Title at top of output */
 
 //
 // Parsing stuff
@@ -90,11 +107,17 @@ void DoProgram(Node *Program);	/* Main interface for parse/lex stages */
 extern int include_stack_pointer;	/**< \brief Current nesting level for include fies */
 extern Node* CommentList;		/**< \brief Stash of comments from inside of a statement being processed */
 extern char* include_name[];		/**< \brief Stack of include files */
+extern std::vector<std::string> source_name;	/**< \brief Main source [0] and each file it included */
+extern int source_index;		/**< \brief Entry in source_name being read */
+extern std::string erl;			/**< \brief Last numeric line number seen (for ERL) */
+extern IncludeResolver IncludeHook;	/**< \brief Finds %INCLUDE files instead of the file system, if set */
 
 int yyparse();			// Hook into bison parser
 int yyerror(char *s);		// Hook into bison error routines
 int yylex( void );		// Hook into flex lexer
 void flex_indata();		// Switch flex into DATA reading mode
+void flex_scan_source(const std::string& Source);	// Lex from memory instead of yyin
+void flex_end_source();		// Done lexing from memory
 
 #ifdef __MSDOS__
 extern "C"
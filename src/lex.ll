@@ -16,6 +16,8 @@
 %{
 #include <stdio.h>
 #include <string>
+#include <vector>
+#include <stdexcept>
 #include <assert.h>
 #include <ctype.h>
 #include "vartype.h"
@@ -33,7 +35,12 @@ static const int MAX_INCLUDE_DEPTH = 10;
 YY_BUFFER_STATE include_stack[MAX_INCLUDE_DEPTH];
 static int include_line[MAX_INCLUDE_DEPTH];
 char* include_name[MAX_INCLUDE_DEPTH] = {(char*)NULL};
+static int include_source[MAX_INCLUDE_DEPTH];
+std::vector<std::string> source_name;
+int source_index = 0;
+IncludeResolver IncludeHook;
 static void StartInclude(char* filename);
+static FILE* OpenInclude(const char* UseName, std::string& OpenedName);
 static char *mangle_string(char *Text, int *type);
 static void my_fatal_error(const char* msg);
 
@@ -46,7 +53,7 @@ static void my_fatal_error(const char* msg);
 
 static inline int SetReturn(int x)
 {
-	yylval = new Node(x, yytext, include_stack_pointer, xline);
+	yylval = new Node(x, yytext, source_index, xline);
 	return(x);
 }
 
@@ -55,20 +62,20 @@ static inline int SetStringReturn(int x)
 	int type;
 //std::std::cerr << "Test1: Mangle '" << yytext << "'" << std::endl;
 	char* MangleValue = mangle_string(yytext, &type);
-	yylval = new Node(x, MangleValue, include_stack_pointer, xline);
+	yylval = new Node(x, MangleValue, source_index, xline);
 	delete[] MangleValue;
 	return(type);
 }
 
 static inline int SetNullReturn(int x)
 {
-	yylval = new Node(x, "", include_stack_pointer, xline);
+	yylval = new Node(x, "", source_index, xline);
 	return(x);
 }
 
 static inline void SetComment(int x)
 {
-	yylval = new Node(x, yytext, include_stack_pointer, xline);
+	yylval = new Node(x, yytext, source_index, xline);
 
 	if (CommentList == NULL)
 	{
@@ -196,13 +203,13 @@ static inline void CountLine()
 <incl>"%FROM"		{ BEGIN(INITIAL); return SetReturn(BAS_P_FROM); }
 <incl>"\""([^\"]*)"\""	{ char* MangleValue = mangle_string(yytext, 0);
 				yylval = new Node(BAS_V_TEXTSTRING,
-				MangleValue, include_stack_pointer);
+				MangleValue, source_index);
 				StartInclude(yytext); BEGIN(INITIAL);
 				delete[] MangleValue;
 				return BAS_V_TEXTSTRING; }
 <incl>"'"([^']*)"'"	{ char* MangleValue = mangle_string(yytext, 0);
 				yylval = new Node(BAS_V_TEXTSTRING,
-				MangleValue, include_stack_pointer);
+				MangleValue, source_index);
 				StartInclude(yytext); BEGIN(INITIAL);
 				delete[] MangleValue;
 				return BAS_V_TEXTSTRING; }
@@ -235,12 +242,15 @@ static inline void CountLine()
 <<EOF>>		{ if (--include_stack_pointer < 0)
 			{ include_stack_pointer = 0; yyterminate(); }
 			else
-			{ yy_switch_to_buffer(
+			{ if (yyin != 0) { fclose(yyin); }
+			yy_delete_buffer(YY_CURRENT_BUFFER);
+			yy_switch_to_buffer(
 			include_stack[include_stack_pointer]);
 			xline = include_line[include_stack_pointer];
+			source_index = include_source[include_stack_pointer];
 			if (PositionDump){ std::cerr << "Leaving Include " <<
 			include_name[include_stack_pointer] << std::endl; }
-			delete include_name[include_stack_pointer];
+			delete[] include_name[include_stack_pointer];
 			}
 		}
 
@@ -248,31 +258,92 @@ static inline void CountLine()
 
 static void StartInclude(char* FileName)
 {
-	char UseName[64];	// File name to actually use
-	FILE* NewChannel;	// File Open Info
+	std::string UseName;	// File name to actually use
+	std::string OpenedName;	// Name it was opened as
+	std::string Text;	// Text from IncludeHook
+	FILE* NewChannel = 0;	// File Open Info
 
 	//
 	// Strip off quotes (We KNOW that we have them)
 	//
 	assert(FileName[0] != 0);
 	assert(FileName[1] != 0);
-	strcpy(UseName, FileName + 1);
-	UseName[strlen(UseName) - 1] = '\0';
+	UseName.assign(FileName + 1, strlen(FileName) - 2);
 
 	//
 	// Can we handle the include?
 	//
 	if (include_stack_pointer >= MAX_INCLUDE_DEPTH)
 	{
-		std::cerr << "Includes Nested Too Deep (" << UseName << ")" << std::endl;
+		*ErrorFile << "Includes Nested Too Deep (" << UseName << ")" << std::endl;
 		return;
 	}
 
 	//
-	// Try to open up the file
+	// Ask for the file, or look for it
+	//
+	if (IncludeHook)
+	{
+		OpenedName = UseName;
+		if (!IncludeHook(UseName, Text, OpenedName))
+		{
+			*ErrorFile << "Unable to open (" << UseName << ")" << std::endl;
+			return;
+		}
+	}
+	else
+	{
+		NewChannel = OpenInclude(UseName.c_str(), OpenedName);
+		if (NewChannel == 0)
+		{
+			*ErrorFile << "Unable to open (" << UseName << ")" << std::endl;
+			return;
+		}
+	}
+
+	//
+	// Switch over to new buffer
+	//
+	include_stack[include_stack_pointer] = YY_CURRENT_BUFFER;
+	include_line[include_stack_pointer] = xline;
+	include_name[include_stack_pointer] = new char[UseName.size() + 1];
+	strcpy(include_name[include_stack_pointer], UseName.c_str());
+	include_source[include_stack_pointer] = source_index;
+	xline = 1;
+	include_stack_pointer++;
+
+	//
+	// Nodes remember which file they came from by its index
+	// in source_name
 	//
+	source_index = source_name.size();
+	source_name.push_back(OpenedName);
+
+	if (IncludeHook)
+	{
+		yy_scan_bytes(Text.data(), Text.size());
+	}
+	else
+	{
+		yy_switch_to_buffer(yy_create_buffer(NewChannel, YY_BUF_SIZE));
+	}
+	if (PositionDump) { std::cerr << "Including (" << UseName << ")" << std::endl;};
+}
+
+//
+// Look for an include file in the file system
+//
+//	Tries the name as given, then without any VMS device and
+//	directory (in lower case), then that in each of the
+//	include directories.
+//
+static FILE* OpenInclude(const char* UseName, std::string& OpenedName)
+{
+	FILE* NewChannel;	// File Open Info
+
 //std::cerr << "Try: " << UseName << std::endl;
 	NewChannel = fopen(UseName, "r");
+	OpenedName = UseName;
 	if (NewChannel == 0)
 	{
 		//
@@ -283,28 +354,27 @@ static void StartInclude(char* FileName)
 		//	This assumes that file names are of the
 		//	format 'host::disk:[directory]name.ext'
 		//
-		char* cindex = strchr(UseName, ':');
+		const char* cindex = strchr(UseName, ':');
 		if (cindex != 0)
 		{
-			char newname[512];
-			int loop;
+			std::string newname;
 			while (*cindex)
 			{
 				switch(*cindex)
 				{
 				case ']':
 				case ':':
-					loop = 0;
+					newname.clear();
 					break;
 				default:
-					newname[loop++] = tolower(*cindex);
+					newname += tolower(*cindex);
 					break;
 				}
 				cindex++;
 			}
-			newname[loop++] = '\0';
 //std::cerr << "Try: " << newname << std::endl;
-			NewChannel = fopen(newname, "r");
+			NewChannel = fopen(newname.c_str(), "r");
+			OpenedName = newname;
 
 			if (NewChannel == 0)
 			{
@@ -312,37 +382,17 @@ static void StartInclude(char* FileName)
 					inclist != include.end() && NewChannel == 0;
 					inclist++)
 				{
-					char tryname[512];
-					strcpy(tryname, (*inclist).c_str());
-					strcat(tryname, "/");
-					strcat(tryname, newname);
+					std::string tryname = *inclist + "/" + newname;
 
 //std::cerr << "Try: " << tryname << std::endl;
-					NewChannel = fopen(tryname, "r");
+					NewChannel = fopen(tryname.c_str(), "r");
+					OpenedName = tryname;
 				}
 			}
 		}
 	}
 
-	if (NewChannel == 0)
-	{
-		std::cerr << "Unable to open (" << UseName << ")" << std::endl;
-		return;
-	}
-
-
-	//
-	// Switch over to new buffer
-	//
-	include_stack[include_stack_pointer] = YY_CURRENT_BUFFER;
-	include_line[include_stack_pointer] = xline;
-	include_name[include_stack_pointer] = new char[strlen(UseName)+1];
-	strcpy(include_name[include_stack_pointer], UseName);
-	xline = 1;
-	include_stack_pointer++;
-
-	yy_switch_to_buffer(yy_create_buffer(NewChannel, YY_BUF_SIZE));
-	if (PositionDump) { std::cerr << "Including (" << UseName << ")" << std::endl;};
+	return NewChannel;
 }
 
 /*******************************************************************************
@@ -626,18 +676,48 @@ static char *mangle_string(char *Text, int *type)
 //	you can just remove all references to it and let flex use the
 //	default error handler.
 //
+//	Throws instead of exiting, so a program using the translator
+//	as a library keeps running. TimedParse() catches it.
+//
 static void my_fatal_error(const char* msg)
 {
-	std::cerr << msg << " at line " << xline;
+	*ErrorFile << msg << " at line " << xline;
 	if (include_stack_pointer > 0)
 	{
-		std::cerr << " in " << include_name[include_stack_pointer - 1];
+		*ErrorFile << " in " << include_name[include_stack_pointer - 1];
 	}
-	std::cerr << std::endl;
-	exit(YY_EXIT_FAILURE);
+	*ErrorFile << std::endl;
+	throw std::runtime_error(msg);
 }
 
 void flex_indata()
 {
 	BEGIN(indata);
 }
+
+//
+// Lex a program held in memory, instead of reading yyin
+//
+void flex_scan_source(const std::string& Source)
+{
+	BEGIN(INITIAL);
+	yy_scan_bytes(Source.data(), Source.size());
+}
+
+//
+// Done with a program from flex_scan_source(). Throws away its
+// buffer, and those of any include files a parse error left
+// open, so the next program starts clean.
+//
+void flex_end_source()
+{
+	while (include_stack_pointer > 0)
+	{
+		include_stack_pointer--;
+		yy_delete_buffer(YY_CURRENT_BUFFER);
+		yy_switch_to_buffer(include_stack[include_stack_pointer]);
+		delete[] include_name[include_stack_pointer];
+	}
+	yy_delete_buffer(YY_CURRENT_BUFFER);
+	BEGIN(INITIAL);
+}
@@ -0,0 +1,542 @@
+/**
+ * \file narrow.cc
+ * \brief Narrow implicitly typed variables to integers.
+ *
+ *	When the default variable type is REAL, every variable without
+ *	a type suffix becomes a double, including loop counters and
+ *	array subscripts. This pass looks at every store into the
+ *	implicitly typed variables of one block level, and when it can
+ *	show that a variable only ever receives integral values that fit
+ *	in a LONG, changes its type to VARTYPE_LONG before the
+ *	definitions are written out.
+ *
+ *	A variable is left alone if
+ *	* any store into it is not known to be integral,
+ *	* it is used as an operand of a division (integer division
+ *	  in C++ would give different results),
+ *	* it is passed to something that may modify it (CALL, user
+ *	  functions, INPUT, READ, MAT, CHANGE, FIELD, ...).
+ *
+ * \bug Like the -i option, arithmetic on narrowed variables is assumed
+ *	not to overflow a long.
+ */
+
+//
+// System Include Files
+//
+#include <iostream>
+#include <cstdlib>
+#include <cerrno>
+#include <string>
+#include <set>
+#include <vector>
+#include <utility>
+
+//
+// Project Include Files
+//
+#include "vartype.h"
+#include "basic.h"
+#include "variable.h"
+#include "varlist.h"
+#include "nodes.h"
+#include "parse.hh"
+
+//
+// Local Definitions
+//
+
+/**
+ * \brief How a variable reference is being used.
+ */
+enum NARROWUSE
+{
+	NARROW_READ,		/**< Value is only read */
+	NARROW_REF,		/**< May be modified, or needs exact type */
+	NARROW_DIVIDE		/**< Operand of a division */
+};
+
+//
+// Module Function Prototypes
+//
+static void NarrowWalk(Node *ThisNode, NARROWUSE Usage);
+static void NarrowWalkOne(Node *ThisNode, NARROWUSE Usage);
+static void NarrowStore(Node *Target, Node *Value);
+static int NarrowIntegral(Node *ThisNode);
+static int NarrowRuntime(const VariableStruct *ThisVar);
+static int NarrowLiteral(const std::string &Text);
+static int NarrowIntegerType(VARTYPE Type);
+
+//
+// Module Variables
+//
+static std::set<VariableStruct*> Candidates;	//!< Variables that may be narrowed
+static std::vector<std::pair<VariableStruct*, Node*> > Stores;	//!< Values stored into candidates
+
+/**
+ * \brief Narrow implicit REAL variables at the current block level.
+ *
+ *	Must be called after the variable scan of a block, and before
+ *	the definitions for that block are output.
+ */
+void NarrowVariables(
+	Node *Body,			/**< Code for this block */
+	Node *Defs,			/**< DEF* functions attached to this block */
+	const std::string &Where	/**< Name of the block (for the report) */
+)
+{
+	//
+	// Nothing to do if untyped variables are already integers
+	//
+	if ((NarrowFlag == 0) || (DefaultType != VARTYPE_REAL))
+	{
+		return;
+	}
+
+	//
+	// Everything implicitly typed in this level starts out as
+	// a possibility.
+	//
+	Candidates.clear();
+	Stores.clear();
+
+	for (ListOfVariables::iterator loop = Variables->back().begin();
+		loop != Variables->back().end(); loop++)
+	{
+		VariableStruct *ThisVar = &((*loop).second);
+
+		if ((ThisVar->Class == VARCLASS_NONE) &&
+			(ThisVar->Type == VARTYPE_REAL) &&
+			(ThisVar->Output == false) &&
+			(ThisVar->Prefix.length() == 0) &&
+			(GuessVarType(ThisVar->BasicName) == VARTYPE_REAL))
+		{
+			Candidates.insert(ThisVar);
+		}
+	}
+
+	if (Candidates.empty())
+	{
+		return;
+	}
+
+	//
+	// Knock out anything used in a way that needs a real type,
+	// and collect everything stored into the rest.
+	//
+	NarrowWalk(Body, NARROW_READ);
+	NarrowWalk(Defs, NARROW_READ);
+
+	//
+	// Drop variables that are given a non-integral value. Since
+	// one variable can be assigned from another, repeat until
+	// nothing else changes.
+	//
+	int Changed = true;
+	while (Changed)
+	{
+		Changed = false;
+		for (std::vector<std::pair<VariableStruct*, Node*> >::iterator
+			loop = Stores.begin(); loop != Stores.end(); loop++)
+		{
+			if (Candidates.count((*loop).first) &&
+				!NarrowIntegral((*loop).second))
+			{
+				Candidates.erase((*loop).first);
+				Changed = true;
+			}
+		}
+	}
+
+	//
+	// Whatever survives becomes a long
+	//
+	for (std::set<VariableStruct*>::iterator loop = Candidates.begin();
+		loop != Candidates.end(); loop++)
+	{
+		(*loop)->Type = VARTYPE_LONG;
+
+		if (NarrowReport)
+		{
+			*ErrorFile << "Narrowed " << Where << ": " <<
+				(*loop)->BasicName << " to LONG";
+			for (std::vector<std::pair<VariableStruct*, Node*> >::iterator
+				store = Stores.begin(); store != Stores.end(); store++)
+			{
+				if ((*store).first == *loop)
+				{
+					*ErrorFile << " (first set at line " <<
+						(*store).second->lineno << ")";
+					break;
+				}
+			}
+			*ErrorFile << std::endl;
+		}
+	}
+
+	Candidates.clear();
+	Stores.clear();
+}
+
+/**
+ * \brief Walk a list of statements/expressions
+ *
+ *	Follows Block[0] iteratively, like VariableScan, to avoid deep
+ *	recursion on long programs.
+ */
+static void NarrowWalk(
+	Node *ThisNode,		/**< First node in list */
+	NARROWUSE Usage		/**< How values are used */
+)
+{
+	while (ThisNode != 0)
+	{
+		NarrowWalkOne(ThisNode, Usage);
+		ThisNode = ThisNode->Block[0];
+	}
+}
+
+/**
+ * \brief Look at one node for stores and unsafe uses.
+ */
+static void NarrowWalkOne(
+	Node *ThisNode,		/**< Node to examine */
+	NARROWUSE Usage		/**< How the value is used */
+)
+{
+	VariableStruct *ThisVar;
+	NARROWUSE ArgUsage;
+	Node *Target;
+
+	switch (ThisNode->Type)
+	{
+	case BAS_V_NAME:
+	case BAS_V_FUNCTION:
+		//
+		// A plain read is always safe. Anything else knocks
+		// this variable out.
+		//
+		if (ThisNode->Type == BAS_V_FUNCTION)
+		{
+			ThisVar = Variables->Lookup(ThisNode->TextValue, ThisNode);
+		}
+		else
+		{
+			ThisVar = Variables->Lookup(ThisNode->TextValue,
+				ThisNode->Tree[0]);
+		}
+		if ((Usage != NARROW_READ) && (ThisVar != 0))
+		{
+			Candidates.erase(ThisVar);
+		}
+
+		//
+		// Array subscripts are read, function arguments are read
+		// only by the runtime library. User functions and subs
+		// may take them by reference.
+		//
+		ArgUsage = NARROW_READ;
+		if ((ThisNode->Type == BAS_V_FUNCTION) &&
+			((ThisVar == 0) ||
+			((ThisVar->Class != VARCLASS_ARRAY) &&
+			!NarrowRuntime(ThisVar))))
+		{
+			ArgUsage = NARROW_REF;
+		}
+		NarrowWalk(ThisNode->Tree[0], ArgUsage);
+		for (int loop = 1; loop < 5; loop++)
+		{
+			NarrowWalk(ThisNode->Tree[loop], NARROW_READ);
+		}
+		break;
+
+	case BAS_N_ASSIGN:
+		//
+		// Every variable in the list receives the value
+		//
+		Target = ThisNode->Tree[0];
+		while (Target != 0)
+		{
+			if (Target->Type == BAS_N_ASSIGNLIST)
+			{
+				NarrowStore(Target->Tree[0], ThisNode->Tree[1]);
+				Target = Target->Tree[1];
+			}
+			else
+			{
+				NarrowStore(Target, ThisNode->Tree[1]);
+				Target = 0;
+			}
+		}
+		NarrowWalk(ThisNode->Tree[1], NARROW_READ);
+		break;
+
+	case BAS_S_FOR:
+	case BAS_N_FORUNTIL:
+	case BAS_N_FORWHILE:
+		//
+		// The loop variable gets the start value, and is stepped.
+		// The limit doesn't matter.
+		//
+		if ((ThisNode->Tree[0] != 0) &&
+			(ThisNode->Tree[0]->Type == BAS_N_FORASSIGN))
+		{
+			Target = ThisNode->Tree[0]->Tree[0];
+			NarrowStore(Target, ThisNode->Tree[0]->Tree[1]);
+			if ((ThisNode->Type != BAS_N_FORWHILE) &&
+				(ThisNode->Tree[2] != 0))
+			{
+				NarrowStore(Target, ThisNode->Tree[2]);
+			}
+			NarrowWalk(ThisNode->Tree[0]->Tree[1], NARROW_READ);
+		}
+		else
+		{
+			NarrowWalk(ThisNode->Tree[0], NARROW_REF);
+		}
+		for (int loop = 1; loop < 5; loop++)
+		{
+			NarrowWalk(ThisNode->Tree[loop], NARROW_READ);
+		}
+		NarrowWalk(ThisNode->Block[1], NARROW_READ);
+		NarrowWalk(ThisNode->Block[2], NARROW_READ);
+		break;
+
+	case BAS_S_INPUT:
+	case BAS_S_LINPUT:
+	case BAS_S_READ:
+	case BAS_V_MATREAD:
+	case BAS_S_CALL:
+	case BAS_S_MAT:
+	case BAS_S_CHANGE:
+	case BAS_S_CHANGE1:
+	case BAS_S_CHANGE2:
+	case BAS_S_FIELD:
+	case BAS_S_MOVE:
+	case BAS_S_LSET:
+	case BAS_S_RSET:
+	case BAS_S_DEF:
+	case BAS_S_DEFSTAR:
+		//
+		// These can write into anything they mention.
+		// DEF parameters hide variables of the same name.
+		//
+		for (int loop = 0; loop < 5; loop++)
+		{
+			NarrowWalk(ThisNode->Tree[loop], NARROW_REF);
+		}
+		NarrowWalk(ThisNode->Block[1], NARROW_READ);
+		NarrowWalk(ThisNode->Block[2], NARROW_READ);
+		break;
+
+	case '/':
+		NarrowWalk(ThisNode->Tree[0], NARROW_DIVIDE);
+		NarrowWalk(ThisNode->Tree[1], NARROW_DIVIDE);
+		break;
+
+	case '+':
+	case '-':
+	case '*':
+	case '(':
+	case BAS_S_MOD:
+	case BAS_N_UMINUS:
+	case BAS_N_UPLUS:
+	case BAS_N_LIST:
+		//
+		// Arithmetic passes the usage down to its operands
+		//
+		for (int loop = 0; loop < 5; loop++)
+		{
+			NarrowWalk(ThisNode->Tree[loop], Usage);
+		}
+		break;
+
+	default:
+		for (int loop = 0; loop < 5; loop++)
+		{
+			NarrowWalk(ThisNode->Tree[loop],
+				(Usage == NARROW_REF) ? NARROW_REF : NARROW_READ);
+		}
+		NarrowWalk(ThisNode->Block[1], NARROW_READ);
+		NarrowWalk(ThisNode->Block[2], NARROW_READ);
+		break;
+	}
+}
+
+/**
+ * \brief Remember a value stored into a variable
+ */
+static void NarrowStore(
+	Node *Target,		/**< Variable being stored into */
+	Node *Value		/**< Value being stored */
+)
+{
+	if (Target == 0)
+	{
+		return;
+	}
+
+	if (Target->Type == BAS_V_NAME)
+	{
+		VariableStruct *ThisVar =
+			Variables->Lookup(Target->TextValue, Target->Tree[0]);
+		if ((ThisVar != 0) && Candidates.count(ThisVar))
+		{
+			if (Value == 0)
+			{
+				Candidates.erase(ThisVar);
+			}
+			else
+			{
+				Stores.push_back(std::make_pair(ThisVar, Value));
+			}
+		}
+
+		//
+		// Subscripts are only read
+		//
+		for (int loop = 0; loop < 5; loop++)
+		{
+			NarrowWalk(Target->Tree[loop], NARROW_READ);
+		}
+	}
+	else
+	{
+		NarrowWalk(Target, NARROW_REF);
+	}
+}
+
+/**
+ * \brief Is this expression known to give an integral LONG value?
+ *
+ *	Candidates are assumed to be integral while testing.
+ */
+static int NarrowIntegral(
+	Node *ThisNode		/**< Expression to test */
+)
+{
+	VariableStruct *ThisVar;
+
+	if (ThisNode == 0)
+	{
+		return false;
+	}
+
+	switch (ThisNode->Type)
+	{
+	case BAS_V_INTEGER:
+	case BAS_V_INT:
+		return NarrowLiteral(ThisNode->TextValue);
+
+	case BAS_V_NAME:
+		ThisVar = Variables->Lookup(ThisNode->TextValue, ThisNode->Tree[0]);
+		return (ThisVar != 0) &&
+			(Candidates.count(ThisVar) ||
+			NarrowIntegerType(ThisVar->Type));
+
+	case BAS_V_FUNCTION:
+		ThisVar = Variables->Lookup(ThisNode->TextValue, ThisNode);
+		return (ThisVar != 0) && NarrowIntegerType(ThisVar->Type);
+
+	case '+':
+	case '-':
+	case '*':
+	case BAS_S_MOD:
+		return NarrowIntegral(ThisNode->Tree[0]) &&
+			NarrowIntegral(ThisNode->Tree[1]);
+
+	case '(':
+	case BAS_N_UMINUS:
+	case BAS_N_UPLUS:
+		return NarrowIntegral(ThisNode->Tree[0]);
+
+	case '/':
+	case '^':
+		return false;
+
+	default:
+		//
+		// Comparisons and logical operators
+		//
+		return NarrowIntegerType(ThisNode->GetNodeVarType());
+	}
+}
+
+/**
+ * \brief Is this a runtime library function (passes by value)?
+ */
+static int NarrowRuntime(
+	const VariableStruct *ThisVar	/**< Function to test */
+)
+{
+	static const char* CFunctions[] =
+	{
+		"abs", "atan", "cos", "fabs", "floor", "log", "log10",
+		"sin", "sqrt", "tan", "trunc", 0
+	};
+
+	const std::string &Name = ThisVar->CName;
+
+	if ((Name.compare(0, 7, "basic::") == 0) ||
+		(Name.compare(0, 5, "std::") == 0) ||
+		(Name.compare(0, 7, "boost::") == 0))
+	{
+		return true;
+	}
+
+	for (int loop = 0; CFunctions[loop] != 0; loop++)
+	{
+		if (Name == CFunctions[loop])
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * \brief Does an integer constant fit in a LONG?
+ */
+static int NarrowLiteral(
+	const std::string &Text		/**< Constant as written in C++ */
+)
+{
+	char *End;
+
+	//
+	// Character constants are always small
+	//
+	if (Text[0] == '\'')
+	{
+		return true;
+	}
+
+	errno = 0;
+	long long Value = strtoll(Text.c_str(), &End, 0);
+	if ((End == Text.c_str()) || (errno == ERANGE))
+	{
+		return false;
+	}
+
+	return (Value >= -2147483648LL) && (Value <= 2147483647LL);
+}
+
+/**
+ * \brief Is this one of the integer types?
+ */
+static int NarrowIntegerType(
+	VARTYPE Type		/**< Type to test */
+)
+{
+	switch (Type)
+	{
+	case VARTYPE_BYTE:
+	case VARTYPE_WORD:
+	case VARTYPE_INTEGER:
+	case VARTYPE_LONG:
+		return true;
+
+	default:
+		return false;
+	}
+}
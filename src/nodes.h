@@ -35,7 +35,7 @@ public:
 	Node *Tree[5];		/**< \brief Pointers to parameters */
 	Node *Block[3];		/**< \brief Pointers to code blocks */
 	static int Level;	/**< \brief Indentation level */
-	int FromInclude;	/**< \brief Is this from an include file? */
+	int FromInclude;	/**< \brief Include file (in source_name) this came from, 0 if none */
 	int lineno;		/**< \brief Source line for error messages */
 
 public:
@@ -125,6 +125,9 @@ public:
 	std::string NoParen();
 	std::string Paren();
 	std::string ParenString();
+	std::string ViewExpression();
+	std::string ViewArgument();
+	std::string ViewArguments();
 
 	/**
 	 * \brief Change include value
@@ -169,11 +172,19 @@ public:
 	int IsString();
 	int IsLogical();
 	int IsSimpleInteger();
+	std::string CommonLayout();
+	int MapMember(std::string &CType, long &Size, long &Count);
+	long MapPacked();
+	int IsMapFill();
+	int IsConstantNumber();
 	int IsReallyString(void);
 
 	void Output(std::ostream& os);
 	void OutputCode(std::ostream& os);
+	void OutputRoutineCode(std::ostream& os);
 	void OutputCodeOne(std::ostream& os);
+	Node* SourceNode();
+	void ScanMapSizes();
 	std::string Expression();
 
 	int CountParam();
@@ -190,6 +201,8 @@ public:
 
 private:
 	void OutputBlock(std::ostream& os);
+	void OutputLine(std::ostream& os);
+	void OutputProfile(std::ostream& os);
 	void OutputPrint(std::ostream& os);
 	void OutputIPChannel(std::ostream& os, int InputFlag);
 	void OutputInput(std::ostream& os, int InputFlag);
@@ -200,10 +213,12 @@ private:
 	void OutputDataValue(std::ostream& os);
 	void OutputMap(std::ostream& os);
 	void ScanMap();
-	void ScanOneMap(VariableStruct* MapVar, int skipprefix);
+	void ScanOneMap(VariableStruct* MapVar, int skipprefix, int Packed = 0);
 	void OutputCaseLabel(std::ostream& os);
 	void OutputCaseIf(std::ostream& os, Node *Parent);
 	int CheckCaseLabel(void);
+	int CheckCaseString(void);
+	void OutputCaseHash(std::ostream& os);
 	std::string OutputVarName(Node* array, int indefine = 0);
 	std::string OutputPName(Node* array, int indefine = 0);
 	/**
@@ -241,5 +256,6 @@ private:
 
 Node *DownLink(Node* node1, Node *Node0 = 0, int Ptr = 0);
 std::string GetIPChannel( Node *IOChannel, int InputFlag);
+void NarrowVariables(Node *Body, Node *Defs, const std::string &Where);
 
 #endif
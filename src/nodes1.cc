@@ -553,6 +553,32 @@ int Node::IsSimpleInteger(void)
 	return 0;
 }
 
+/**
+ * \brief Is the node a numeric constant
+ *
+ *	Returns true for a numeric literal, possibly with a sign or
+ *	parentheses around it. These never need to be copied into
+ *	a temporary to be evaluated only once.
+ */
+int Node::IsConstantNumber(void)
+{
+	switch (Type)
+	{
+	case BAS_V_INTEGER:
+	case BAS_V_INT:
+	case BAS_V_FLOAT:
+		return 1;
+
+	case BAS_N_UMINUS:
+	case BAS_N_UPLUS:
+	case '(':
+		return (Tree[0] != 0) && Tree[0]->IsConstantNumber();
+
+	default:
+		return 0;
+	}
+}
+
 
 /**
  * \brief Count the number of parameters for a function/array
@@ -675,7 +675,7 @@ void Node::ScanVarList(
 		}
 		else
 		{
-			std::cerr << "Scanning: Type = NULL in BAS_V_DEFINEFUN" << std::endl;
+			*ErrorFile << "Scanning: Type = NULL in BAS_V_DEFINEFUN" << std::endl;
 			ThisType = VARTYPE_NONE;
 		}
 		if (Tree[0] != 0)
@@ -946,6 +946,7 @@ int Node::IsString(void)
 			{
 			case BAS_S_STRING:
 			case VARTYPE_DYNSTR:
+			case VARTYPE_FIXSTR:
 				return 1;
 
 			}
@@ -1037,6 +1038,61 @@ void Node::SmoothTypes(
 	}
 }
 
+/**
+ * \brief Size every byte exact MAP/COMMON in the program
+ *
+ *	Looks through the whole program (every routine) before any
+ *	of it is written, so MapSizes holds the largest size of each
+ *	name by the time the first MapBuffer for it is output, and
+ *	MapMembers knows which variables are views into one.
+ */
+void Node::ScanMapSizes(void)
+{
+	for (Node* Statement = this; Statement != 0;
+		Statement = Statement->Block[0])
+	{
+		if (((Statement->Type == BAS_S_MAP) ||
+			(Statement->Type == BAS_S_COMMON)) &&
+			(Statement->Tree[0] != 0))
+		{
+			long PackedSize = Statement->MapPacked();
+
+			if (PackedSize >= 0)
+			{
+				long &Size = MapSizes[Statement->Tree[0]->TextValue];
+				if (Size < PackedSize)
+				{
+					Size = PackedSize;
+				}
+
+				for (Node* Member = Statement->Tree[1]; Member != 0;
+					Member = Member->Block[0])
+				{
+					if (!Member->IsMapFill() && (Member->Tree[0] != 0))
+					{
+						MapMembers.insert(Member->Tree[0]->TextValue);
+					}
+				}
+			}
+		}
+
+		for (int loop = 0; loop < 5; loop++)
+		{
+			if (Statement->Tree[loop] != 0)
+			{
+				Statement->Tree[loop]->ScanMapSizes();
+			}
+		}
+		for (int loop = 1; loop < 3; loop++)
+		{
+			if (Statement->Block[loop] != 0)
+			{
+				Statement->Block[loop]->ScanMapSizes();
+			}
+		}
+	}
+}
+
 /** 
  * \brief Scans a map or common statement.
  *
@@ -1063,14 +1119,36 @@ void Node::ScanMap(void)
 	}
 	ThisVar.CName = tempname;
 
-	Variables->Append(ThisVar);
-	Variables->Fixup();
+	//
+	// A byte exact MAP/COMMON (see OutputMap) is sized to the
+	// largest MAP of that name, and its members are plain
+	// variables without the map name in front of them.
+	//
+	long PackedSize = MapPacked();
+
+	if (PackedSize >= 0)
+	{
+		long &Size = MapSizes[Tree[0]->TextValue];
+		if (Size < PackedSize)
+		{
+			Size = PackedSize;
+		}
+	}
+
+	if ((PackedSize < 0) ||
+		(Variables->Lookup(Tree[0]->TextValue, 0) == 0))
+	{
+		Variables->Append(ThisVar);
+		Variables->Fixup();
+	}
  
 	if (Tree[1] != 0)
 	{
 		Tree[1]->ScanOneMap(&ThisVar,
-			Tree[1]->Type == BAS_V_DEFINEVAR &&
-			Tree[1]->Block[0] == 0);
+			(PackedSize >= 0) ||
+			(Tree[1]->Type == BAS_V_DEFINEVAR &&
+			Tree[1]->Block[0] == 0),
+			PackedSize >= 0);
 	}
 }
 
@@ -1081,7 +1159,8 @@ void Node::ScanMap(void)
  */ 
  void Node::ScanOneMap(
 	VariableStruct* MapVar,	/**< Main map variable */
-	int skipprefix
+	int skipprefix,
+	int Packed		/**< Byte exact MAP (see OutputMap) */
 )
 {
 	switch (Type)
@@ -1090,11 +1169,11 @@ void Node::ScanMap(void)
  
 		if (Tree[0] != 0)
 		{
-			Tree[0]->ScanOneMap(MapVar, skipprefix);
+			Tree[0]->ScanOneMap(MapVar, skipprefix, Packed);
 		}
 		if (Tree[1] != 0)
 		{
-			Tree[1]->ScanOneMap(MapVar, skipprefix);
+			Tree[1]->ScanOneMap(MapVar, skipprefix, Packed);
 		}
 		break;                                                                   
 	case BAS_V_NAME:
@@ -1138,9 +1217,24 @@ void Node::ScanMap(void)
 // the right thing yet
 	case BAS_V_DEFINEVAR:
  
+		//
+		// Padding in a byte exact MAP doesn't get a variable,
+		// and its strings have a fixed length.
+		//
+		if (Packed && IsMapFill())
+		{
+			break;
+		}
+
 		{
 			VariableStruct NewVar(Tree[0]->TextValue,
-				VARTYPE_NONE, VARCLASS_MAP, true);
+				(Tree[1] != 0) ? Tree[1]->GetNodeVarType() :
+					GuessVarType(Tree[0]->TextValue),
+				(Tree[2] != 0) ? VARCLASS_ARRAY : VARCLASS_MAP, true);
+			if (Packed && (NewVar.Type == VARTYPE_DYNSTR))
+			{
+				NewVar.Type = VARTYPE_FIXSTR;
+			}
 			if (!skipprefix)
 			{
 				NewVar.Prefix = MapVar->CName;
@@ -1150,12 +1244,12 @@ void Node::ScanMap(void)
 		break;
  
 	default:
-		std::cerr << "Undefined type " << Type << "@" << lineno << std::endl;
+		*ErrorFile << "Undefined type " << Type << "@" << lineno << std::endl;
 		break;
 	}
  
 	if (Block[0] != 0)
 	{
-		Block[0]->ScanOneMap(MapVar, skipprefix);
+		Block[0]->ScanOneMap(MapVar, skipprefix, Packed);
 	}
 }
@@ -18,6 +18,11 @@
 #include <string>
 #include <cctype>
 #include <cstring>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <map>
+#include <sstream>
 
 //
 // Project Include Files
@@ -28,6 +33,7 @@
 #include "varlist.h"
 #include "nodes.h"
 #include "parse.hh"
+#include "passtime.h"
 
 //
 // Module Variables
@@ -40,52 +46,603 @@ static int IOChPrinted;		/**< \brief Has channel number been output */
 static Node* IOChannel;		/**< \brief IO Channel to use (NULL if default) */
 static Node* IOUsing;		/**< \brief Print using format */
 static int DataWidth;		/**< \brief Used to format DATA statements */
+static int ForCount = 0;	/**< \brief Used to name FOR loop temporaries */
+static std::string ForTemps;	/**< \brief FOR temporaries for the routine being written */
+static std::string ForTempsIndent;	/**< \brief Indentation of the routine's locals */
+static std::ostream* LineStream = 0;	/**< \brief Where the last #line went (0 if none is in effect) */
+static std::streampos LinePosition;	/**< \brief Where it ended */
+static int LineSource;		/**< \brief Source file it named */
+static int LineNumber;		/**< \brief Line it named */
+
+/**
+ * \brief Stands for a #line back to the generated C++ (-g)
+ *
+ * Output() replaces it once it knows which line it is on.
+ */
+static const char GeneratedLine[] = "#line <generated>";
 
 std::string erl = "0";		/**< Last numeric line number seen. */
 
-/** \brief add/subtract from string with optimization
+/**
+ * \brief String literals hoisted out of the generated code
  *
- * Adds or subtracts from a value, and if possible
- * optimizing it to a simple value if possible, otherwise
- * appending a '+ n' or '- n' ss necessary.
+ * Maps the C++ text of a literal to the name of the static
+ * std::string holding it, so each literal is built only once
+ * instead of every time the expression is evaluated.
+ */
+static std::map<std::string, std::string> LiteralPool;
+static std::vector<std::string> LiteralOrder;	/**< \brief Literals in order seen */
+
+/**
+ * \brief Return the name of the static string holding a literal
  */
-static std::string IncrString(const std::string &orig, long increment)
+static std::string InternLiteral(
+	const std::string &Literal	/**< C++ text of the literal */
+)
 {
-	const char *nptr = orig.c_str();
-	char *endptr = 0;
-	long value;
-	char buffer[64];
+	std::map<std::string, std::string>::iterator Find =
+		LiteralPool.find(Literal);
+
+	if (Find != LiteralPool.end())
+	{
+		return Find->second;
+	}
 
-	/*
-	 * Try to convert original string
-	 */
-	value = strtol(nptr, &endptr, 10);
+	char Buffer[32];
+	sprintf(Buffer, "StrLit%d", (int)LiteralOrder.size() + 1);
+	LiteralPool[Literal] = Buffer;
+	LiteralOrder.push_back(Literal);
+	return Buffer;
+}
 
-	/*
-	 * Did it work?
-	 */
-	if (*endptr == 0)
+/**
+ * \brief Search strings hoisted out of the generated code
+ *
+ * INSTR and POS with a literal search string use a basic::Needle
+ * built once, so the search setup isn't redone on every call.
+ */
+static std::map<std::string, std::string> NeedlePool;
+static std::vector<std::string> NeedleOrder;	/**< \brief Search strings in order seen */
+
+/**
+ * \brief Return the name of the static basic::Needle for a literal
+ */
+static std::string InternNeedle(
+	const std::string &Literal	/**< C++ text of the literal */
+)
+{
+	std::map<std::string, std::string>::iterator Find =
+		NeedlePool.find(Literal);
+
+	if (Find != NeedlePool.end())
 	{
-		sprintf(buffer, "%ld", value + increment);
-		return buffer;
+		return Find->second;
 	}
-	else
+
+	char Buffer[32];
+	sprintf(Buffer, "Needle%d", (int)NeedleOrder.size() + 1);
+	NeedlePool[Literal] = Buffer;
+	NeedleOrder.push_back(Literal);
+	return Buffer;
+}
+
+/**
+ * \brief Search string argument for INSTR/POS
+ *
+ * \return Hoisted basic::Needle for a literal, otherwise the
+ *	expression itself.
+ */
+static std::string NeedleArgument(
+	Node *Search		/**< Search string expression */
+)
+{
+	if ((Search->Type == BAS_V_TEXTSTRING) && Search->IsReallyString())
 	{
-		std::string Result = orig;
-		if (increment >= 0)
+		return InternNeedle(Search->TextValue);
+	}
+	return Search->ViewArgument();
+}
+
+/**
+ * \brief BASIC lines with a profile counter (-f)
+ *
+ * Maps a source file (its index in source_name) and line to
+ * its entry in the ProfileLines table written ahead of the code.
+ */
+static std::map<std::pair<int, int>, int> ProfilePool;
+static std::vector<std::pair<int, int> > ProfileOrder;	/**< \brief Lines in order seen */
+
+/**
+ * \brief Return the ProfileLines entry for a source line
+ */
+static int InternProfileLine(
+	int Source,		/**< Index in source_name */
+	int Line		/**< Line in that file */
+)
+{
+	std::pair<int, int> Key(Source, Line);
+	std::map<std::pair<int, int>, int>::iterator Find =
+		ProfilePool.find(Key);
+
+	if (Find != ProfilePool.end())
+	{
+		return Find->second;
+	}
+
+	int Index = ProfileOrder.size();
+	ProfilePool[Key] = Index;
+	ProfileOrder.push_back(Key);
+	return Index;
+}
+
+/**
+ * \brief Write a file name as a C++ string literal
+ */
+static std::string QuoteFileName(
+	const std::string &Name		/**< File name */
+)
+{
+	std::string Result = "\"";
+
+	for (std::string::size_type loop = 0; loop < Name.size(); loop++)
+	{
+		if ((Name[loop] == '"') || (Name[loop] == '\\'))
 		{
-			sprintf(buffer, "%ld", increment);
-			Result = Result + " + " + buffer;
+			Result += '\\';
+		}
+		Result += Name[loop];
+	}
+	return Result + "\"";
+}
+
+/**
+ * \brief Stop attributing code to the BASIC source (-g)
+ *
+ *	Called after the last statement of a routine, so the
+ *	code that closes it, and whatever follows, isn't counted
+ *	as BASIC lines past that statement.
+ */
+static void EndLineMap(
+	std::ostream& os	/**< iostream to write the C++ code to */
+)
+{
+	if (LineStream != 0)
+	{
+		os << GeneratedLine << std::endl;
+		LineStream = 0;
+	}
+}
+
+/**
+ * \brief Write the code, filling in the GeneratedLine markers (-g)
+ *
+ *	Each marker becomes a #line naming the next line of the
+ *	output file, counting the lines written to it so far.
+ */
+static void WriteGenerated(
+	std::ostream& os,		/**< Output file */
+	const std::string& Text		/**< Code to write */
+)
+{
+	std::string::size_type Start = 0;
+
+	while (Start < Text.size())
+	{
+		std::string::size_type End = Text.find('\n', Start);
+		if (End == std::string::npos)
+		{
+			End = Text.size() - 1;
+		}
+		OutLines++;
+		if (Text.compare(Start, End - Start, GeneratedLine) == 0)
+		{
+			os << "#line " << OutLines + 1 << " " <<
+				QuoteFileName(OutName) << std::endl;
 		}
 		else
 		{
-			sprintf(buffer, "%ld", -increment);
-			Result = Result + " - " + buffer;
+			os.write(Text.data() + Start, End + 1 - Start);
+		}
+		Start = End + 1;
+	}
+}
+
+/** \brief Hash a string for SELECT CASE
+ *
+ * This must give the same results as basic::SelectHash in
+ * lib/bstring.h, which is used by the generated code.
+ */
+static unsigned long SelectHash(const std::string &Text, unsigned long Seed)
+{
+	unsigned long Hash = (2166136261UL ^ Seed) & 0xffffffffUL;
+
+	for (std::string::size_type loop = 0; loop < Text.size(); loop++)
+	{
+		Hash ^= (unsigned char)Text[loop];
+		Hash = (Hash * 16777619UL) & 0xffffffffUL;
+	}
+	return Hash;
+}
+
+/** \brief Get the characters in a C++ string literal
+ *
+ * Undoes what mangle_string in lex.ll did to a quoted string,
+ * including strings that have been merged together.
+ *
+ * \return true if the literal was understood.
+ */
+static int LiteralText(const std::string &Literal, std::string &Result)
+{
+	std::string::size_type loop = 0;
+	int Quoted = 0;
+
+	Result.clear();
+	while (loop < Literal.size())
+	{
+		char ch = Literal[loop++];
+
+		if (ch == '"')
+		{
+			Quoted = !Quoted;
+			continue;
+		}
+		if (!Quoted)
+		{
+			return 0;
+		}
+		if (ch != '\\')
+		{
+			Result += ch;
+			continue;
+		}
+		if (loop >= Literal.size())
+		{
+			return 0;
+		}
+		switch (Literal[loop++])
+		{
+		case '\\':	Result += '\\';	break;
+		case '"':	Result += '"';	break;
+		case '\'':	Result += '\'';	break;
+		case 'a':	Result += '\a';	break;
+		case 'b':	Result += '\b';	break;
+		case 't':	Result += '\t';	break;
+		case 'v':	Result += '\v';	break;
+		case 'n':	Result += '\n';	break;
+		case 'r':	Result += '\r';	break;
+		case 'f':	Result += '\f';	break;
+		default:	return 0;
 		}
-		return Result;
 	}
+	return (Quoted == 0) && (Literal.size() != 0);
 }
 
+/** \brief Get the value of an integer case label
+ *
+ * \return true if the value could be determined.
+ */
+static int CaseValue(Node *Label, long long &Value)
+{
+	char *End;
+
+	switch (Label->Type)
+	{
+	case BAS_N_UMINUS:
+		if (CaseValue(Label->Tree[0], Value))
+		{
+			Value = -Value;
+			return 1;
+		}
+		return 0;
+
+	case BAS_N_UPLUS:
+	case '(':
+		return CaseValue(Label->Tree[0], Value);
+
+	case BAS_V_INTEGER:
+	case BAS_V_INT:
+		if ((Label->TextValue.size() == 3) && (Label->TextValue[0] == '\''))
+		{
+			Value = (unsigned char)Label->TextValue[1];
+			return 1;
+		}
+		Value = strtoll(Label->TextValue.c_str(), &End, 0);
+		return (End != Label->TextValue.c_str()) &&
+			((*End == '\0') || (*End == '%') || (*End == 'L'));
+
+	default:
+		return 0;
+	}
+}
+
+/** \brief Check that integer case labels don't overlap
+ *
+ * A C++ switch can't have the same value twice, which a
+ * BASIC select can.
+ *
+ * \return true if all of the labels are distinct.
+ */
+static int CaseDistinct(Node *CaseList)
+{
+	std::vector<std::pair<long long, long long> > Ranges;
+
+	for (Node *LookDown = CaseList; LookDown != 0; LookDown = LookDown->Block[0])
+	{
+		if (LookDown->Type != BAS_S_CASE)
+		{
+			continue;
+		}
+
+		for (Node *Label = LookDown->Tree[0]; Label != 0; )
+		{
+			Node *ThisLabel = Label;
+			long long Low, High;
+
+			if (Label->Type == BAS_N_LIST)
+			{
+				ThisLabel = Label->Tree[0];
+				Label = Label->Tree[1];
+			}
+			else
+			{
+				Label = 0;
+			}
+
+			if (ThisLabel->Type == BAS_S_TO)
+			{
+				if (!CaseValue(ThisLabel->Tree[0], Low) ||
+					!CaseValue(ThisLabel->Tree[1], High) ||
+					(Low > High))
+				{
+					return 0;
+				}
+			}
+			else
+			{
+				if (!CaseValue(ThisLabel, Low))
+				{
+					return 0;
+				}
+				High = Low;
+			}
+			Ranges.push_back(std::make_pair(Low, High));
+		}
+	}
+
+	std::sort(Ranges.begin(), Ranges.end());
+	for (size_t loop = 1; loop < Ranges.size(); loop++)
+	{
+		if (Ranges[loop].first <= Ranges[loop - 1].second)
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * \brief Flatten a chain of string '+' operations
+ *
+ * Collects the operands of 'A$ + B$ + ...' (which the parser builds
+ * as a left leaning tree) into a list so that they can be handed to
+ * basic::Concat/basic::Append in one call.
+ *
+ * \return true if every operand is a string.
+ */
+static int ConcatList(
+	Node *Expr,			/**< Expression to flatten */
+	std::vector<Node*> &Parts	/**< Operands, in order */
+)
+{
+	if (Expr->Type == '+')
+	{
+		return ConcatList(Expr->Tree[0], Parts) &&
+			ConcatList(Expr->Tree[1], Parts);
+	}
+
+	if (Expr->Type == '(' && Expr->Tree[0] != 0 &&
+		Expr->Tree[0]->Type == '+')
+	{
+		return ConcatList(Expr->Tree[0], Parts);
+	}
+
+	switch (Expr->GetNodeVarType())
+	{
+	case VARTYPE_DYNSTR:
+	case VARTYPE_FIXSTR:
+		Parts.push_back(Expr);
+		return 1;
+
+	default:
+		return 0;
+	}
+}
+
+/**
+ * \brief Output an argument to a boost string algorithm
+ *
+ * The boost algorithms want a real string (a range), which a
+ * byte exact MAP member isn't, so those are copied into one.
+ */
+static std::string BoostArgument(Node *Arg)
+{
+	if (Arg->GetNodeVarType() == VARTYPE_FIXSTR)
+	{
+		return "std::string(" + Arg->NoParen() + ")";
+	}
+	return Arg->NoParen();
+}
+
+/**
+ * \brief Substring functions that have a basic::string_view version
+ */
+static const char* SubstringFunctions[] =
+{
+	"basic::left", "basic::right", "basic::mid", "basic::Qseg",
+	"basic::trm", 0
+};
+
+/**
+ * \brief Functions that only look at their string arguments
+ *
+ * They take basic::string_view, so a substring passed to them
+ * can be a view instead of a new string.
+ */
+static const char* ViewFunctions[] =
+{
+	"basic::left", "basic::right", "basic::mid", "basic::Qseg",
+	"basic::trm", "basic::instr", "basic::pos", "basic::edit",
+	"basic::Val", "basic::ValInteger", 0
+};
+
+/**
+ * \brief Is a name in a list of functions
+ */
+static int InFunctionList(
+	const std::string &Name,	/**< C++ function name */
+	const char** List		/**< List to look in */
+)
+{
+	for (int loop = 0; List[loop] != 0; loop++)
+	{
+		if (Name == List[loop])
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * \brief Is this a LEFT$/RIGHT$/MID$/SEG$/TRM$ call
+ *
+ * \return The C++ name of the function, or "" if it isn't one.
+ */
+static std::string SubstringCall(
+	Node *Expr		/**< Expression to look at */
+)
+{
+	if ((Expr->Type != BAS_V_FUNCTION) || (Expr->Tree[0] == 0))
+	{
+		return "";
+	}
+
+	VariableStruct *ThisVar = Variables->Lookup(Expr->TextValue, Expr->Tree[0]);
+
+	if ((ThisVar == 0) || !InFunctionList(ThisVar->GetName(), SubstringFunctions))
+	{
+		return "";
+	}
+	return ThisVar->GetName();
+}
+
+/**
+ * \brief Output the operands of a flattened concatenation
+ *
+ * String literals are passed as is, since the helpers take
+ * 'const char*' directly.
+ */
+static std::string ConcatArgs(
+	std::vector<Node*> &Parts,	/**< Operands */
+	size_t First			/**< First operand to output */
+)
+{
+	std::string result;
+
+	for (size_t loop = First; loop < Parts.size(); loop++)
+	{
+		if (loop != First)
+		{
+			result += ", ";
+		}
+		result += Parts[loop]->ViewArgument();
+	}
+	return result;
+}
+
+/**
+ * \brief Are two nodes the same variable
+ *
+ * Compares the trees themselves (type, name and subscripts)
+ * rather than their output, which would cost a walk of each
+ * subtree and intern any literals it came across.
+ *
+ * \return true if Left and Right are the same reference.
+ */
+static int SameVariable(
+	Node *Left,			/**< One reference */
+	Node *Right			/**< The other */
+)
+{
+	if ((Left == 0) || (Right == 0))
+	{
+		return Left == Right;
+	}
+	if ((Left->Type != Right->Type) || (Left->TextValue != Right->TextValue))
+	{
+		return 0;
+	}
+	for (int loop = 0; loop < 5; loop++)
+	{
+		if (!SameVariable(Left->Tree[loop], Right->Tree[loop]))
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * \brief Does an expression refer to a variable
+ *
+ * Used to keep 'A$ = A$ + "," + A$' out of basic::Append, which
+ * would see A$ after it had already grown.
+ *
+ * \return true if Target is Expr or any part of it.
+ */
+static int UsesVariable(
+	Node *Expr,			/**< Expression to search */
+	Node *Target			/**< Variable to look for */
+)
+{
+	if (Expr == 0)
+	{
+		return 0;
+	}
+	if (SameVariable(Expr, Target))
+	{
+		return 1;
+	}
+	for (int loop = 0; loop < 5; loop++)
+	{
+		if (UsesVariable(Expr->Tree[loop], Target))
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * \brief Do any of the operands of a concatenation refer to a variable
+ *
+ * \return true if Target is used in Parts[First] or later.
+ */
+static int UsesVariable(
+	std::vector<Node*> &Parts,	/**< Operands */
+	size_t First,			/**< First operand to search */
+	Node *Target			/**< Variable to look for */
+)
+{
+	for (size_t loop = First; loop < Parts.size(); loop++)
+	{
+		if (UsesVariable(Parts[loop], Target))
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
 
 /**
  * \brief Main function to output translated code.
@@ -93,9 +650,30 @@ static std::string IncrString(const std::string &orig, long increment)
  *	This function outputs the translated code.
  */
 void Node::Output(
-	std::ostream& os	/**< Stream to write C++ code to */
+	std::ostream& File	/**< Stream to write C++ code to */
 )
 {
+	//
+	// With -g, the code is held until the lines it is written
+	// on are known.
+	//
+	std::ostringstream Buffer;
+	std::ostream& os = LineDirectives ? Buffer : File;
+
+	//
+	// Start with empty pools and no #line in effect. Anything
+	// left by a program that was abandoned part way through (or
+	// interned by an earlier pass) would otherwise leak into
+	// this one.
+	//
+	LineStream = 0;
+	LiteralPool.clear();
+	LiteralOrder.clear();
+	NeedlePool.clear();
+	NeedleOrder.clear();
+	ProfilePool.clear();
+	ProfileOrder.clear();
+
 	//
 	// Handle Include Files
 	//
@@ -155,6 +733,11 @@ void Node::Output(
 		NeedVirtual = 0;
 	}
 
+	if (ProfileFlag)
+	{
+		os << "#include \"basicprofile.h\"" << std::endl;
+	}
+
 	os << std::endl;
 
 	if (NeedRFA != 0)
@@ -163,17 +746,7 @@ void Node::Output(
 		NeedRFA = 0;
 	}
 
-	if (NeedPuse != 0)
-	{
-		os << "static basic::PUsing PUse;\t// Needed for print using" << std::endl;
-		NeedPuse = 0;
-	}
-
-	//
-	// This code duplicates basicfun.h, but sometimes it is still needed
-	// 
-	os << Indent() << "extern basic::BasicError Be;" <<
-		std::endl;
+	NeedPuse = 0;
 
 	os << std::endl;
 
@@ -188,54 +761,315 @@ void Node::Output(
 	OutputPrototypes(os);
 
 	//
-	// Output code
+	// Byte exact MAP/COMMON areas are made at the largest size
+	// any module reserves, so tell the library this one's sizes
+	// before anything runs.
+	//
+	if (MapSizes.size() != 0)
+	{
+		int Count = 0;
+
+		os << std::endl <<
+			"//" << std::endl <<
+			"// MAP and COMMON Sizes" << std::endl <<
+			"//" << std::endl;
+		for (std::map<std::string, long>::iterator loop = MapSizes.begin();
+			loop != MapSizes.end(); loop++)
+		{
+			os << "static basic::MapReserve MapReserve" << ++Count <<
+				"(\"" << loop->first << "\", " << loop->second <<
+				");" << std::endl;
+		}
+	}
+
+	//
+	// Output code.
+	// The code is buffered so that the string literals it
+	// uses can be defined ahead of it.
 	//
 	Level = 0;
-	OutputCode(os);
+	ForCount = 0;
+	std::ostringstream Body;
+	OutputCode(Body);
+	EndLineMap(Body);
+
+	if (LiteralOrder.size() != 0)
+	{
+		os << std::endl <<
+			"//" << std::endl <<
+			"// String Literals" << std::endl <<
+			"//" << std::endl;
+		for (size_t loop = 0; loop < LiteralOrder.size(); loop++)
+		{
+			os << "static const std::string " <<
+				LiteralPool[LiteralOrder[loop]] << "(" <<
+				LiteralOrder[loop] << ");" << std::endl;
+		}
+	}
+
+	if (NeedleOrder.size() != 0)
+	{
+		os << std::endl <<
+			"//" << std::endl <<
+			"// Search Strings" << std::endl <<
+			"//" << std::endl;
+		for (size_t loop = 0; loop < NeedleOrder.size(); loop++)
+		{
+			os << "static const basic::Needle " <<
+				NeedlePool[NeedleOrder[loop]] << "(" <<
+				NeedleOrder[loop] << ");" << std::endl;
+		}
+	}
+
+	if (ProfileOrder.size() != 0)
+	{
+		os << std::endl <<
+			"//" << std::endl <<
+			"// Line Profile" << std::endl <<
+			"//" << std::endl <<
+			"static basic::ProfileLine ProfileLines[] =" << std::endl <<
+			"{" << std::endl;
+		for (size_t loop = 0; loop < ProfileOrder.size(); loop++)
+		{
+			int Source = ProfileOrder[loop].first;
+
+			os << "\t{ " << QuoteFileName(
+				Source < (int)source_name.size() ?
+				source_name[Source] : "") << ", " <<
+				ProfileOrder[loop].second << " }," << std::endl;
+		}
+		os << "};" << std::endl <<
+			"static basic::ProfileTable ProfileLineTable(ProfileLines, " <<
+			ProfileOrder.size() << ");" << std::endl;
+	}
+
+	os << Body.str();
+
+	if (LineDirectives)
+	{
+		WriteGenerated(File, Buffer.str());
+	}
+}
+
+
+/**
+ * \brief Output the code of a routine
+ *
+ *	FOR loops collect the temporaries for their limits and steps
+ *	in ForTemps while the code is written. They are declared
+ *	ahead of the code, with the routine's other locals, so a
+ *	GOTO into a loop doesn't jump over their initialization.
+ */
+void Node::OutputRoutineCode(
+	std::ostream& os	/**< iostream to write C++ code to */
+)
+{
+	std::string KeepTemps;
+	std::string KeepIndent = ForTempsIndent;
+	std::ostringstream Body;
+
+	KeepTemps.swap(ForTemps);
+	ForTempsIndent = Indent();
+	OutputCode(Body);
+	if (ForTemps.length() != 0)
+	{
+		os << ForTemps << std::endl;
+	}
+	os << Body.str();
+	EndLineMap(os);
+	ForTemps.swap(KeepTemps);
+	ForTempsIndent = KeepIndent;
+}
+
+/**
+ * \brief Output one block of code.
+ *
+ *	This function goes through the level 0 code (statements)
+ *	and handle output of the commands at that level.
+ */
+void Node::OutputCode(
+	std::ostream& os	/**< iostream to write the C++ code to */
+)
+{
+	//
+	// Local Variables
+	//
+	Node *Program = this;
+
+	//
+	// Starting at the top node, we scan down handling each
+	// level 0 node type as necessary.
+	//
+	// Could do this by calling OutputCode recursively for the Down
+	// level instead of splitting into OutputCode and OutputCodeOne,
+	// but that would consume huge amounts of stack space.
+	//
+	while (Program != 0)
+	{
+		//
+		// Handle Statement. Don't output code from included files.
+		//
+		if ((Program->FromInclude == 0) || (CompileFlag != 0))
+		{
+			if (ProfileFlag)
+			{
+				Program->OutputProfile(os);
+			}
+			if (LineDirectives)
+			{
+				Program->OutputLine(os);
+			}
+			Program->OutputCodeOne(os);
+		}
+
+		//
+		// Get next node
+		//
+		Program = Program->Block[0];
+	}
+}
+
+
+/**
+ * \brief Node that says where in the source a statement is
+ *
+ *	Nodes built by the parser (assignments, for example) have
+ *	no line of their own, so use the first thing under them
+ *	that came from the lexer.
+ */
+Node* Node::SourceNode()
+{
+	if (lineno != 0)
+	{
+		return this;
+	}
+	for (int loop = 0; loop < 5; loop++)
+	{
+		if (Tree[loop] != 0)
+		{
+			Node* Found = Tree[loop]->SourceNode();
+			if (Found != 0)
+			{
+				return Found;
+			}
+		}
+	}
+	return 0;
+}
+
+/**
+ * \brief Point the compiler back at the BASIC source of a statement (-g)
+ *
+ *	Writes a #line directive, so compiler errors, debuggers,
+ *	perf and the sanitizers report the BASIC file and line
+ *	instead of the generated C++. Labels produce no code, so
+ *	get none, and one isn't repeated if nothing has been
+ *	written since the last one for the same line.
+ */
+void Node::OutputLine(
+	std::ostream& os	/**< iostream to write the C++ code to */
+)
+{
+	Node* Where = SourceNode();
+
+	if ((Type == BAS_V_LABEL) || (Where == 0) ||
+		(Where->FromInclude >= (int)source_name.size()))
+	{
+		return;
+	}
+	if ((LineStream == &os) && (LinePosition == os.tellp()) &&
+		(LineSource == Where->FromInclude) &&
+		(LineNumber == Where->lineno))
+	{
+		return;
+	}
+
+	os << "#line " << Where->lineno << " " <<
+		QuoteFileName(source_name[Where->FromInclude]) << std::endl;
+	LineStream = &os;
+	LinePosition = os.tellp();
+	LineSource = Where->FromInclude;
+	LineNumber = Where->lineno;
 }
 
+/**
+ * \brief Count a hit on the BASIC line of a statement (-f)
+ *
+ *	Only executable statements get a counter. Declarations,
+ *	labels, remarks and the like cost nothing to run, and some
+ *	of them don't produce code where a statement could go.
+ */
+void Node::OutputProfile(
+	std::ostream& os	/**< iostream to write the C++ code to */
+)
+{
+	switch (Type)
+	{
+	case BAS_N_ASSIGN:
+	case BAS_N_CAUSEERROR:
+	case BAS_N_FORUNTIL:
+	case BAS_N_FORWHILE:
+	case BAS_N_ONERROR:
+	case BAS_N_ONGOSUB:
+	case BAS_N_ONGOTO:
+	case BAS_N_WHENERRORIN:
+	case BAS_S_CALL:
+	case BAS_S_CHAIN:
+	case BAS_S_CHANGE1:
+	case BAS_S_CHANGE2:
+	case BAS_S_CLOSE:
+	case BAS_S_CONTINUE:
+	case BAS_S_DELETE:
+	case BAS_S_EXIT:
+	case BAS_S_FIND:
+	case BAS_S_FOR:
+	case BAS_S_GET:
+	case BAS_S_GOSUB:
+	case BAS_S_GOTO:
+	case BAS_S_IF:
+	case BAS_S_INPUT:
+	case BAS_S_ITERATE:
+	case BAS_S_KILL:
+	case BAS_S_LET:
+	case BAS_S_LINPUT:
+	case BAS_S_LSET:
+	case BAS_S_MARGIN:
+	case BAS_S_MAT:
+	case BAS_S_OPEN:
+	case BAS_S_PRINT:
+	case BAS_S_PUT:
+	case BAS_S_RANDOM:
+	case BAS_S_READ:
+	case BAS_S_RESET:
+	case BAS_S_RESTORE:
+	case BAS_S_RESUME:
+	case BAS_S_RETURN:
+	case BAS_S_RSET:
+	case BAS_S_SCRATCH:
+	case BAS_S_SELECT:
+	case BAS_S_SLEEP:
+	case BAS_S_STOP:
+	case BAS_S_UNLESS:
+	case BAS_S_UNLOCK:
+	case BAS_S_UNTIL:
+	case BAS_S_UPDATE:
+	case BAS_S_WAIT:
+	case BAS_S_WHILE:
+		break;
 
-/**
- * \brief Output one block of code.
- *
- *	This function goes through the level 0 code (statements)
- *	and handle output of the commands at that level.
- */
-void Node::OutputCode(
-	std::ostream& os	/**< iostream to write the C++ code to */
-)
-{
-	//
-	// Local Variables
-	//
-	Node *Program = this;
+	default:
+		return;
+	}
 
-	//
-	// Starting at the top node, we scan down handling each
-	// level 0 node type as necessary.
-	//
-	// Could do this by calling OutputCode recursively for the Down
-	// level instead of splitting into OutputCode and OutputCodeOne,
-	// but that would consume huge amounts of stack space.
-	//
-	while (Program != 0)
+	Node* Where = SourceNode();
+	if (Where != 0)
 	{
-		//
-		// Handle Statement. Don't output code from included files.
-		//
-		if ((Program->FromInclude == 0) || (CompileFlag != 0))
-		{
-			Program->OutputCodeOne(os);
-		}
-
-		//
-		// Get next node
-		//
-		Program = Program->Block[0];
+		os << Indent() << "basic::ProfileHit(ProfileLines[" <<
+			InternProfileLine(Where->FromInclude, Where->lineno) <<
+			"]);" << std::endl;
 	}
 }
 
-
 /**
  * \brief Output one block of code.
  *
@@ -282,6 +1116,14 @@ void Node::OutputBlock(
 			//
 			if ((Program->FromInclude == 0) || (CompileFlag != 0))
 			{
+				if (ProfileFlag)
+				{
+					Program->OutputProfile(os);
+				}
+				if (LineDirectives)
+				{
+					Program->OutputLine(os);
+				}
 				Program->OutputCodeOne(os);
 			}
 
@@ -357,6 +1199,10 @@ std::string Node::Paren(void)
  */
 std::string Node::ParenString(void)
 {
+	if (Type == BAS_V_TEXTSTRING && IsReallyString())
+	{
+		return InternLiteral(TextValue);
+	}
 	if (TextValue[0] == '"' || TextValue[0] == '\'')
 	{
 		return std::string("std::string(") +
@@ -427,8 +1273,12 @@ void Node::OutputPrototypes(
 			//
 			// Scan the call parameters
 			//
-			ThisNode->VariableScanOne(1);
-			Variables->Fixup();
+			{
+				PassTimer Timer(PASS_FIXUP);
+
+				ThisNode->VariableScanOne(1);
+				Variables->Fixup();
+			}
 
 			//
 			// Output function name
@@ -495,6 +1345,29 @@ void Node::OutputCodeOne(
 			}
 			else
 			{
+				//
+				// Is this a string append?
+				//	A$ = A$ + B$ + C$ becomes an in place append,
+				//	unless A$ is also one of the later pieces.
+				//
+				if (Tree[1]->Type == '+')
+				{
+					std::vector<Node*> Parts;
+
+					if (ConcatList(Tree[1], Parts) &&
+						(Parts.size() > 2) &&
+						(Tree[0]->GetNodeVarType() == VARTYPE_DYNSTR) &&
+						SameVariable(Tree[0], Parts[0]) &&
+						!UsesVariable(Parts, 1, Tree[0]))
+					{
+						os << "basic::Append(" <<
+							Tree[0]->Expression() << ", " <<
+							ConcatArgs(Parts, 1) << ");" <<
+							std::endl;
+						break;
+					}
+				}
+
 				//
 				// Is this an increment command?
 				//
@@ -594,7 +1467,12 @@ void Node::OutputCodeOne(
 
 	case BAS_S_CHAIN:
 		os << Indent() << "basic::BasicChain(" <<
-			Tree[0]->NoParen() << ");" << std::endl;
+			Tree[0]->NoParen();
+		if (Tree[1] != 0)
+		{
+			os << ", " << Tree[1]->NoParen();
+		}
+		os << ");" << std::endl;
 		break;
 
 	case BAS_S_CHANGE1:
@@ -716,14 +1594,14 @@ void Node::OutputCodeOne(
 
 	case BAS_N_EXITHANDLER:
 		// Re-throw the exception
-		os << Indent() << "throw Be;" << std::endl;
+		os << Indent() << "throw basic::Context().Error;" << std::endl;
 		break;
 
 	case BAS_S_FIELD:
 		os << Indent() << "// Field Statement" << std::endl <<
 			Indent() << "{" << std::endl;
 		Level++;
-		os << Indent() << "char* FieldBase = BasicChannel[" <<
+		os << Indent() << "char* FieldBase = basic::Context().Channel[" <<
 			Tree[0]->OutputForcedType(VARTYPE_INTEGER) <<
 			"].BufferLoc();" << std::endl;
 		Tree[1]->OutputField(os);
@@ -742,60 +1620,143 @@ void Node::OutputCodeOne(
 		break;
 
 	case BAS_S_FOR:
-		os << Indent() << "for (";
+		{
+			//
+			// BASIC evaluates the limit and step once, before the
+			// loop starts, so anything that isn't a constant is
+			// copied into a temporary. The temporaries use the type
+			// of the loop variable, so integer loops stay integer,
+			// unless the limit has a fraction that must be kept.
+			//
+			Node *ForVar = Tree[0]->Tree[0];
+			std::string VarName = ForVar->Expression();
+			VARTYPE ForType = ForVar->GetNodeVarType();
+			VARTYPE LimitType;
+			std::string Limit;	// Text for limit
+			std::string Step;	// Text for step
+			std::string Temps;	// Temporary definitions
+			int Direction = 1;	// 1=up, -1=down, 0=test at runtime
+			char Buffer[32];
+
+			ForCount++;
 
-		//
-		// from
-		//
-		os << Tree[0]->Expression() << "; ";
+			//
+			// to
+			//
+			if (Tree[1]->IsConstantNumber())
+			{
+				Limit = Tree[1]->Expression();
+			}
+			else
+			{
+				sprintf(Buffer, "ForLimit%d", ForCount);
+				Limit = Buffer;
+				Temps = Indent() + Limit + " = " + Tree[1]->NoParen() +
+					";\n";
 
-		//
-		// to
-		//
-		//	We have to try to look at the step and guess if
-		//	it is a negitive step value. If we can't tell,
-		//	assume positive.
-		//
-		if ((Tree[2] != 0) &&
-			(Tree[2]->Type == BAS_N_UMINUS))
-		{
-			os << Tree[0]->Tree[0]->Expression() << " >= " <<
-				Tree[1]->Expression() << "; ";
-		}
-		else
-		{
-			os << Tree[0]->Tree[0]->Expression() << " <= " <<
-				Tree[1]->Expression() << "; ";
-		}
+				LimitType = Tree[1]->GetNodeVarType();
+				if (LimitType >= VARTYPE_BYTE)
+				{
+					ForType = ChooseVarType(ForType, LimitType);
+				}
+			}
 
-		//
-		// step
-		//
-		if (Tree[2] != 0)
-		{
 			//
-			// Loop going backwards?
+			// step
 			//
-			if (Tree[2]->Type == BAS_N_UMINUS)
+			if (Tree[2] == 0)
+			{
+				Step = VarName + "++";
+			}
+			else if (Tree[2]->IsConstantNumber())
 			{
-				os << Tree[0]->Tree[0]->Expression() << " -= " <<
-					Tree[2]->Tree[0]->Expression();
+				if (Tree[2]->Type == BAS_N_UMINUS)
+				{
+					Direction = -1;
+					if (Tree[2]->Tree[0]->IsSimpleInteger() &&
+						(atol(Tree[2]->Tree[0]->TextValue.c_str()) == 1))
+					{
+						Step = VarName + "--";
+					}
+					else
+					{
+						Step = VarName + " -= " +
+							Tree[2]->Tree[0]->Expression();
+					}
+				}
+				else if (Tree[2]->IsSimpleInteger() &&
+					(atol(Tree[2]->TextValue.c_str()) == 1))
+				{
+					Step = VarName + "++";
+				}
+				else
+				{
+					Step = VarName + " += " +
+						Tree[2]->Expression();
+				}
 			}
 			else
 			{
-				os << Tree[0]->Tree[0]->Expression() << " += " <<
-					Tree[2]->Expression();
+				Direction = 0;
+				sprintf(Buffer, "ForStep%d", ForCount);
+				Temps += Indent() + Buffer + " = " +
+					Tree[2]->NoParen() + ";\n";
+				Step = VarName + " += " + Buffer;
 			}
-		}
-		else
-		{
-			os << Tree[0]->Tree[0]->Expression() << "++";
-		}
 
-		os << ")" << std::endl;
+			//
+			// The temporaries are declared with the routine's
+			// locals (see OutputRoutineCode), and set before the
+			// loop variable, since BASIC evaluates them first.
+			//
+			if (Temps.length() != 0)
+			{
+				std::string TempType = OutputVarType(
+					ForType == VARTYPE_NONE ? VARTYPE_REAL : ForType);
 
-		Block[1]->OutputBlock(os);
+				if (!Tree[1]->IsConstantNumber())
+				{
+					ForTemps += ForTempsIndent + TempType + " " +
+						Limit + " = 0;\n";
+				}
+				if (Direction == 0)
+				{
+					ForTemps += ForTempsIndent + TempType + " " +
+						Buffer + " = 0;\n";
+				}
+				os << Temps;
+			}
+
+			//
+			// from
+			//
+			os << Indent() << "for (" <<
+				Tree[0]->Expression() << "; ";
+
+			//
+			// test
+			//
+			switch (Direction)
+			{
+			case 1:
+				os << VarName << " <= " << Limit << "; ";
+				break;
+
+			case -1:
+				os << VarName << " >= " << Limit << "; ";
+				break;
+
+			default:
+				os << "(" << Buffer << " >= 0) ? (" <<
+					VarName << " <= " << Limit << ") : (" <<
+					VarName << " >= " << Limit << "); ";
+				break;
+			}
 
+			os << Step << ")" << std::endl;
+
+			Block[1]->OutputBlock(os);
+		}
 		break;
 
 	case BAS_N_FORUNTIL:
@@ -900,22 +1861,31 @@ void Node::OutputCodeOne(
 			ThisVar->Type = ThisType;
 		}
 
-		//
-		// Scan calling parameters
-		//
-		if (Tree[3] != 0)
 		{
-			Tree[3]->VariableScan(1);
-		}
+			PassTimer Timer(PASS_FIXUP);
 
-		//
-		// Scan local code
-		//
-		if (Block[1] != 0)
-		{
-			Block[1]->VariableScan(0);
+			//
+			// Scan calling parameters
+			//
+			if (Tree[3] != 0)
+			{
+				Tree[3]->VariableScan(1);
+			}
+
+			//
+			// Scan local code
+			//
+			if (Block[1] != 0)
+			{
+				Block[1]->VariableScan(0);
+			}
+			Variables->Fixup();
+
+			//
+			// Narrow implicit REAL variables that are really integers
+			//
+			NarrowVariables(Block[1], Block[2], Tree[1]->TextValue);
 		}
-		Variables->Fixup();
 
 		//
 		// Scan def* code
@@ -991,7 +1961,7 @@ void Node::OutputCodeOne(
 				WhenErrorFlag = 0;
 			}
 
-			Block[1]->OutputCode(os);
+			Block[1]->OutputRoutineCode(os);
 		}
 
 		//
@@ -1030,15 +2000,24 @@ void Node::OutputCodeOne(
 
 		Variables->NewLevel();
 
-		//
-		// Scan the call parameters
-		//
-		VariableScanOne(1);
-		if (Block[1] != 0)
 		{
-			Block[1]->VariableScan(0);
+			PassTimer Timer(PASS_FIXUP);
+
+			//
+			// Scan the call parameters
+			//
+			VariableScanOne(1);
+			if (Block[1] != 0)
+			{
+				Block[1]->VariableScan(0);
+			}
+			Variables->Fixup();
+
+			//
+			// Narrow implicit REAL variables that are really integers
+			//
+			NarrowVariables(Block[1], Block[2], "main");
 		}
-		Variables->Fixup();
 
 		//
 		// Scan for any local def* functions
@@ -1057,11 +2036,26 @@ void Node::OutputCodeOne(
 		}
 
 		//
-		// Output function name
+		// Output function name.
+		// A program that is to be CHAINed to in process is
+		// registered under its name instead of being main().
 		//
 		os << std::endl;
-		os << Indent() << "int main(int argc, char **argv)" <<
-			std::endl;
+		if (ChainName.empty())
+		{
+			os << Indent() << "int main(int argc, char **argv)" <<
+				std::endl;
+		}
+		else
+		{
+			os << Indent() << "static int ChainMain(int argc, char **argv);" <<
+				std::endl <<
+				Indent() << "static basic::ChainEntry ChainRegister(\"" <<
+				ChainName << "\", ChainMain);" << std::endl <<
+				std::endl <<
+				Indent() << "static int ChainMain(int argc, char **argv)" <<
+				std::endl;
+		}
 
 		//
 		// Braces starting function
@@ -1095,7 +2089,7 @@ void Node::OutputCodeOne(
 				WhenErrorFlag = 0;
 			}
 
-			Block[1]->OutputCode(os);
+			Block[1]->OutputRoutineCode(os);
 		}
 
 		//
@@ -1193,9 +2187,16 @@ void Node::OutputCodeOne(
 
 		if (Block[2] != 0)
 		{
-			os << Indent() << "catch(basic::BasicError &Be)" << std::endl;
-
-			Block[2]->OutputBlock(os);
+			//
+			// Make the error visible to ERR/ERL/ERN$
+			//
+			os << Indent() << "catch(basic::BasicError &Be)" << std::endl <<
+				Indent() << "{" << std::endl;
+			Level++;
+			os << Indent() << "basic::Context().Error = Be;" << std::endl;
+			Block[2]->OutputCode(os);
+			Level--;
+			os << Indent() << "}" << std::endl;
 		}
 		break;
 
@@ -1448,7 +2449,7 @@ void Node::OutputCodeOne(
 		{
 			os << Indent() << "default:" << std::endl <<
 				Indent() <<
-				"OnErrorHit(58, " <<
+				"OnErrorHit(basic::ErrOnOutOfRange, " <<
 				erl << ");\t// Out of range" << std::endl;
 		}
 		os << Indent() << "}" << std::endl;
@@ -1494,7 +2495,7 @@ void Node::OutputCodeOne(
 		os << Indent() <<
 			"if (!" <<
 			GetIPChannel(Tree[2], 0) <<
-			".is_open()) { OnErrorHit(5, " <<
+			".is_open()) { OnErrorHit(basic::ErrCantFindFile, " <<
 			erl << "); }" <<
 			std::endl;;
 		break;
@@ -1514,7 +2515,7 @@ void Node::OutputCodeOne(
 		break;
 
 	case BAS_S_RANDOM:
-		os << Indent() << "srand(time(0));" << std::endl;
+		os << Indent() << "basic::Context().Randomize();" << std::endl;
 		break;
 
 	case BAS_S_RECORD:
@@ -1587,7 +2588,16 @@ void Node::OutputCodeOne(
 		break;
 
 	case BAS_S_SELECT:
-		if (Block[1] != 0 && Block[1]->CheckCaseLabel())
+		if (Block[1] != 0 && Block[1]->CheckCaseString())
+		{
+			//
+			// All labels are string literals, so hash the
+			// selector and switch on that.
+			//
+			OutputCaseHash(os);
+		}
+		else if (Block[1] != 0 && (Block[1]->CheckCaseLabel() ||
+			!CaseDistinct(Block[1])))
 		{
 			os << Indent() <<
 				"// ** Converted from a select statement **" <<
@@ -1609,6 +2619,16 @@ void Node::OutputCodeOne(
 
 			while(LookDown)
 			{
+				//
+				// Line numbers on the CASE lines can't go
+				// between the if's.
+				//
+				if (LookDown->Type == BAS_V_LABEL)
+				{
+					LookDown = LookDown->Block[0];
+					continue;
+				}
+
 				switch(LookDown->Type)
 				{
 				case BAS_S_REMARK:
@@ -1692,6 +2712,11 @@ void Node::OutputCodeOne(
 					isremark = 1;
 					break;
 
+				case BAS_V_LABEL:
+					LookDown->OutputCodeOne(os);
+					isremark = 1;
+					break;
+
 				}
 
 				//
@@ -1747,19 +2772,28 @@ void Node::OutputCodeOne(
 
 		Variables->NewLevel();
 
-		//
-		// Scan the call parameters
-		//
-		VariableScanOne(1);
-
-		//
-		// Scan local code
-		//
-		if (Block[1] != 0)
 		{
-			Block[1]->VariableScan(0);
+			PassTimer Timer(PASS_FIXUP);
+
+			//
+			// Scan the call parameters
+			//
+			VariableScanOne(1);
+
+			//
+			// Scan local code
+			//
+			if (Block[1] != 0)
+			{
+				Block[1]->VariableScan(0);
+			}
+			Variables->Fixup();
+
+			//
+			// Narrow implicit REAL variables that are really integers
+			//
+			NarrowVariables(Block[1], Block[2], Tree[1]->TextValue);
 		}
-		Variables->Fixup();
 
 		//
 		// Scan def* code
@@ -1817,7 +2851,7 @@ void Node::OutputCodeOne(
 				WhenErrorFlag = 0;
 			}
 
-			Block[1]->OutputCode(os);
+			Block[1]->OutputRoutineCode(os);
 		}
 
 		Level--;
@@ -1844,19 +2878,28 @@ void Node::OutputCodeOne(
 
 		Variables->NewLevel();
 
-		//
-		// Scan the call parameters
-		//
-		VariableScanOne(1);
-
-		//
-		// Scan local code
-		//
-		if (Block[1] != 0)
 		{
-			Block[1]->VariableScan(0);
+			PassTimer Timer(PASS_FIXUP);
+
+			//
+			// Scan the call parameters
+			//
+			VariableScanOne(1);
+
+			//
+			// Scan local code
+			//
+			if (Block[1] != 0)
+			{
+				Block[1]->VariableScan(0);
+			}
+			Variables->Fixup();
+
+			//
+			// Narrow implicit REAL variables that are really integers
+			//
+			NarrowVariables(Block[1], Block[2], Tree[1]->TextValue);
 		}
-		Variables->Fixup();
 
 		//
 		// Scan def* code
@@ -1914,7 +2957,7 @@ void Node::OutputCodeOne(
 				WhenErrorFlag = 0;
 			}
 
-			Block[1]->OutputCode(os);
+			Block[1]->OutputRoutineCode(os);
 		}
 
 		Level--;
@@ -2185,12 +3228,6 @@ std::string Node::Expression(void)
 				".find_first_of(" + 
 				Tree[0]->Tree[1]->NoParen() + ") + 1";
 		}
-		else if (result == "basic::left" && Tree[0]->Type == BAS_N_LIST)
-		{
-			result = Tree[0]->Tree[0]->ParenString() +
-				".substr(0, " + 
-				Tree[0]->Tree[1]->NoParen() + ")";
-		}
 
 #if 0		// Doesn't work because substr bast end of string causes crash
 
@@ -2226,11 +3263,19 @@ std::string Node::Expression(void)
 			Tree[0]->Type == BAS_N_LIST &&
 			Tree[0]->Tree[1]->Type == BAS_N_LIST)
 		{
-			std::string temp = IncrString(Tree[0]->Tree[0]->NoParen(), -1);
-			result = std::string("(") +
-				Tree[0]->Tree[1]->Tree[0]->ParenString() + ".find(" + 
-				Tree[0]->Tree[1]->Tree[1]->NoParen() + ", " +
-				temp + ") + 1)";
+			result = "basic::instr(" +
+				Tree[0]->Tree[0]->NoParen() + ", " +
+				Tree[0]->Tree[1]->Tree[0]->ViewArgument() + ", " +
+				NeedleArgument(Tree[0]->Tree[1]->Tree[1]) + ")";
+		}
+		else if (result == "basic::pos" &&
+			Tree[0]->Type == BAS_N_LIST &&
+			Tree[0]->Tree[1]->Type == BAS_N_LIST)
+		{
+			result = "basic::pos(" +
+				Tree[0]->Tree[0]->ViewArgument() + ", " +
+				NeedleArgument(Tree[0]->Tree[1]->Tree[0]) + ", " +
+				Tree[0]->Tree[1]->Tree[1]->NoParen() + ")";
 		}
 		//     EDIT$(str-exp, int-exp)
 		//
@@ -2251,14 +3296,14 @@ std::string Node::Expression(void)
 			Tree[0]->Tree[1]->NoParen() == "2")
 		{
 			result = std::string("boost::erase_all_copy(") +
-				Tree[0]->Tree[0]->NoParen() + ", \" \")";
+				BoostArgument(Tree[0]->Tree[0]) + ", \" \")";
 		}
 		else if (result == "basic::edit" &&
 			Tree[0]->Type == BAS_N_LIST &&
 			Tree[0]->Tree[1]->NoParen() == "4")
 		{
 			result = std::string("boost::replace_regex_all_copy(") +
-				Tree[0]->Tree[0]->NoParen() +
+				BoostArgument(Tree[0]->Tree[0]) +
 				", \"[\\n\\r\\f\\0x1a\\0xff]\", \"\")";
 		}
 		else if (result == "basic::edit" &&
@@ -2266,21 +3311,21 @@ std::string Node::Expression(void)
 			Tree[0]->Tree[1]->NoParen() == "8")
 		{
 			result = std::string("boost::trim_left_copy(") +
-				Tree[0]->Tree[0]->NoParen() + ")";
+				BoostArgument(Tree[0]->Tree[0]) + ")";
 		}
 		else if (result == "basic::edit" &&
 			Tree[0]->Type == BAS_N_LIST &&
 			Tree[0]->Tree[1]->NoParen() == "8 + 128")
 		{
 			result = std::string("boost::trim_copy(") +
-				Tree[0]->Tree[0]->NoParen() + ")";
+				BoostArgument(Tree[0]->Tree[0]) + ")";
 		}
 		else if (result == "basic::edit" &&
 			Tree[0]->Type == BAS_N_LIST &&
 			Tree[0]->Tree[1]->NoParen() == "16")
 		{
 			result = std::string("boost::replace_regex_all_copy(") +
-				Tree[0]->Tree[0]->NoParen() +
+				BoostArgument(Tree[0]->Tree[0]) +
 				", \"[ \\t]+\", \" \")";
 		}
 		else if (result == "basic::edit" &&
@@ -2288,24 +3333,33 @@ std::string Node::Expression(void)
 			Tree[0]->Tree[1]->NoParen() == "32")
 		{
 			result = std::string("boost::to_upper_copy(") +
-				Tree[0]->Tree[0]->NoParen() + ")";
+				BoostArgument(Tree[0]->Tree[0]) + ")";
 		}
 		else if (result == "basic::edit" &&
 			Tree[0]->Type == BAS_N_LIST &&
 			Tree[0]->Tree[1]->NoParen() == "128")
 		{
 			result = std::string("boost::trim_right_copy(") +
-				Tree[0]->Tree[0]->NoParen() + ")";
+				BoostArgument(Tree[0]->Tree[0]) + ")";
+		}
+		else if ((result.compare(0, 7, "boost::") == 0) &&
+			(Tree[0] != 0) && (Tree[0]->Type != BAS_N_LIST))
+		{
+			result += "(" + BoostArgument(Tree[0]) + ")";
 		}
 		else
 		{
-			if (Tree[0] != 0)
+			if (Tree[0] == 0)
 			{
-				result += "(" + Tree[0]->NoParen() + ")";
+				result += "()";
+			}
+			else if (InFunctionList(result, ViewFunctions))
+			{
+				result += "(" + Tree[0]->ViewArguments() + ")";
 			}
 			else
 			{
-				result += "()";
+				result += "(" + Tree[0]->NoParen() + ")";
 			}
 		}
 		break;
@@ -2357,20 +3411,59 @@ std::string Node::Expression(void)
 	// Equality statement
 	//
 	case '=':
-		result = Tree[0]->OutputBstringText() + " == " +
-			Tree[1]->Expression();
+		if (SubstringCall(Tree[0]) != "")
+		{
+			result = Tree[0]->ViewExpression() + " == " +
+				Tree[1]->ViewExpression();
+		}
+		else
+		{
+			result = Tree[0]->OutputBstringText() + " == " +
+				Tree[1]->ViewExpression();
+		}
 		break;
 
 	case '+':
+		//
+		// A chain of string concatenations is done in one
+		// allocation instead of one per '+'.
+		//
+		{
+			std::vector<Node*> Parts;
+
+			if (ConcatList(this, Parts) && ((Parts.size() > 2) ||
+				(SubstringCall(Parts[0]) != "") ||
+				(SubstringCall(Parts[1]) != "")))
+			{
+				result = std::string("basic::Concat(") +
+					ConcatArgs(Parts, 0) + ")";
+				break;
+			}
+		}
+		result = Tree[0]->OutputBstringText() + " " + TextValue +
+			" " + Tree[1]->Expression();
+		break;
+
 	case '-':
 	case '*':
 	case '/':
-	case '>':
-	case '<':
 		result = Tree[0]->OutputBstringText() + " " + TextValue +
 			" " + Tree[1]->Expression();
 		break;
 
+	case '>':
+	case '<':
+		if (SubstringCall(Tree[0]) != "")
+		{
+			result = Tree[0]->ViewExpression();
+		}
+		else
+		{
+			result = Tree[0]->OutputBstringText();
+		}
+		result += " " + TextValue + " " + Tree[1]->ViewExpression();
+		break;
+
 	case BAS_S_MOD:
 		result = Tree[0]->Expression() + " % " + Tree[1]->Expression();
 		break;
@@ -2403,7 +3496,20 @@ std::string Node::Expression(void)
 			break;
 
 		case BAS_S_REF:
-			result = std::string("&") + Tree[0]->Expression();
+			//
+			// A byte exact MAP member can't be pointed at, so
+			// it is passed as a copy that is stored back after
+			// the call (see basic::MapRef).
+			//
+			if (MapMembers.count(Tree[0]->TextValue) != 0)
+			{
+				result = std::string("basic::ByRef(") +
+					Tree[0]->Expression() + ")";
+			}
+			else
+			{
+				result = std::string("&") + Tree[0]->Expression();
+			}
 			break;
 
 		default:
@@ -2423,7 +3529,8 @@ std::string Node::Expression(void)
 		break;
 
 	case BAS_X_GE:
-		result = Tree[0]->Expression() + " >= " + Tree[1]->Expression();
+		result = Tree[0]->ViewExpression() + " >= " +
+			Tree[1]->ViewExpression();
 		break;
 
 	case BAS_V_INT:
@@ -2433,7 +3540,8 @@ std::string Node::Expression(void)
 		break;
 
 	case BAS_X_LE:
-		result = Tree[0]->Expression() + " <= " + Tree[1]->Expression();
+		result = Tree[0]->ViewExpression() + " <= " +
+			Tree[1]->ViewExpression();
 		break;
 
 	case BAS_N_LIST:
@@ -2465,11 +3573,13 @@ std::string Node::Expression(void)
 		break;
 
 	case BAS_X_EQ:
-		result = Tree[0]->Expression() + " == " + Tree[1]->Expression();
+		result = Tree[0]->ViewExpression() + " == " +
+			Tree[1]->ViewExpression();
 		break;
 
 	case BAS_X_NEQ:
-		result = Tree[0]->Expression() + " != " + Tree[1]->Expression();
+		result = Tree[0]->ViewExpression() + " != " +
+			Tree[1]->ViewExpression();
 		break;
 
 	case BAS_S_NOT:
@@ -2784,7 +3894,7 @@ void Node::OutputPrint(
 		if (IOUsing != 0)
 		{
 			OutputIPChannel(os, 0);
-			os << " << PUse.Finish()";
+			os << " << basic::Context().PUse.Finish()";
 		}
 
 		//
@@ -2885,7 +3995,7 @@ std::string GetIPChannel(
 	}
 	else
 	{
-		return "BasicChannel[" + IOChannel->Expression() + "]";
+		return "basic::Context().Channel[" + IOChannel->Expression() + "]";
 	}
 
 }
@@ -3014,7 +4124,7 @@ int Node::OutputPrintData(
 		IOUsing = Tree[0];
 		ReturnFlag = 2;
 
-		os << Indent() << "PUse.SetFormat(" << IOUsing->Expression() <<
+		os << Indent() << "basic::Context().PUse.SetFormat(" << IOUsing->Expression() <<
 			");" << std::endl;
 
 		break;
@@ -3034,7 +4144,7 @@ int Node::OutputPrintData(
 		//
 		if (IOUsing != 0)
 		{
-			os << " << PUse.Output(" << Expression() << ");" << std::endl;
+			os << " << basic::Context().PUse.Output(" << Expression() << ");" << std::endl;
 			IOChPrinted = 0;
 		}
 		else
@@ -3071,7 +4181,7 @@ int Node::OutputPrintData(
 		//
 		if (IOUsing != 0)
 		{
-			os << " << PUse.Output(" << Expression() << ");" << std::endl;
+			os << " << basic::Context().PUse.Output(" << Expression() << ");" << std::endl;
 			IOChPrinted = 0;
 		}
 		else
@@ -3212,7 +4322,7 @@ int Node::OutputInputData(
 		IOUsing = Tree[0];
 		ReturnFlag = 2;
 
-		os << Indent() << "PUse.SetFormat(" << IOUsing->Expression() <<
+		os << Indent() << "basic::Context().PUse.SetFormat(" << IOUsing->Expression() <<
 			");" << std::endl;
 
 		break;
@@ -3333,14 +4443,14 @@ int Node::OutputInputData(
 				os << Indent() <<
 					"if (" <<
 					GetIPChannel(IOChannel, InputFlag) <<
-					".eof()) { OnErrorHit(11, " <<
+					".eof()) { OnErrorHit(basic::ErrEndOfFile, " <<
 					erl << "); }" <<
 					"\t// End of file on device" <<
 					std::endl;
 				os << Indent() <<
 					"if (" <<
 					GetIPChannel(IOChannel, InputFlag) <<
-					".fail()) { OnErrorHit(12, " <<
+					".fail()) { OnErrorHit(basic::ErrIoFailure, " <<
 					erl << "); }" <<
 					"\t// Fatal system I/O failure" <<
 					std::endl;
@@ -3481,86 +4591,402 @@ void Node::OutputDataValue(
 		case BAS_V_INTEGER:
 		case BAS_V_FLOAT:
 
-			os << '"' << TextValue << '"';
-			DataWidth += TextValue.length() + 2;
-			break;
+			os << '"' << TextValue << '"';
+			DataWidth += TextValue.length() + 2;
+			break;
+
+		default:
+			//
+			// Force quotes around data value
+			//
+			os << '"' << Expression() << '"';
+			DataWidth +=Expression().length() + 2;
+			break;
+		}
+	}
+}
+
+/**
+ * \brief Outputs a map or common statement.
+ *
+ *	This function will mangle a map or common statement.
+ */
+void Node::OutputMap(
+	std::ostream& os		/**< iostream to write C++ code to */
+)
+{
+	VariableStruct* ThisVar = Variables->Lookup(Tree[0]->TextValue, 0);
+
+	os << std::endl << Indent() <<
+		"// #pragma psect static_rw " << ThisVar->GetName(1) <<
+		",gbl,ovr" << std::endl;
+
+	//
+	// When every member has a fixed size, the MAP/COMMON is a block
+	// of bytes in the jobs runtime context, with a view for each
+	// member at its offset in the block. Every MAP with the same
+	// name gets the same block, so they overlay each other the way
+	// they do on the VAX.
+	//
+	if (MapPacked() >= 0)
+	{
+		static int MapCount = 0;
+		std::string Buffer = genname(Tree[0]->TextValue) +
+			"_M" + std::to_string(++MapCount);
+		long Offset = 0;
+
+		os << Indent() << "basic::MapBuffer " << Buffer << "(\"" <<
+			Tree[0]->TextValue << "\", " <<
+			MapSizes[Tree[0]->TextValue] << ", " <<
+			(Type == BAS_S_COMMON) << ");" << std::endl;
+
+		for (Node* Member = Tree[1]; Member != 0; Member = Member->Block[0])
+		{
+			std::string CType;
+			long Size;
+			long Count;
+
+			Member->MapMember(CType, Size, Count);
+
+			if (!Member->IsMapFill())
+			{
+				os << Indent();
+				if (CType.empty())
+				{
+					os << (Member->Tree[2] != 0 ?
+						"basic::MapStringArray " :
+						"basic::MapString ");
+				}
+				else if (Member->Tree[2] != 0)
+				{
+					os << "basic::MapArray<" << CType << "> ";
+				}
+				else
+				{
+					os << "basic::MapValue<" << CType << "> ";
+				}
+				os << Member->Tree[0]->OutputVarName(Member->Tree[2], 1 + 2) <<
+					"(" << Buffer << ".Data + " << Offset;
+				if (CType.empty())
+				{
+					os << ", " << Size;
+				}
+				os << ");" << std::endl;
+			}
+
+			Offset += Size * Count;
+		}
+
+		os << std::endl;
+		return;
+	}
+
+	//
+	// We implement MAP and COMMON as classes because dealing with
+	// their weirdness will be easier by creating methods in a base
+	// class than putting stuff in the actual source. It should also
+	// make putting everything in a common place simpler.
+	//
+	// Here we try to 'roll up' a MAP statement of the form
+	//	MAP (my_map) my_regord my_var
+	// into a shorder form than more comples MAPs. It means we can
+	// rever to the values as 'my_var.value' instead of
+	// 'my_map.my_var.value'.
+	// Similiar code must exist in program.cc arount the prefix
+	// generating code
+	//
+	// A COMMON lives in the jobs runtime context instead, so that
+	// it is shared by every routine that declares it, and is still
+	// there for the next program after a CHAIN.
+	//
+	std::string Instance;
+	std::string Layout;
+
+	if ((Tree[1]->Type == BAS_V_DEFINEVAR) && (Tree[1]->Block[0] == 0))
+	{
+		os <<
+			Indent() << "class " << ThisVar->GetName(1) <<
+				"_C : public " <<
+				Tree[1]->Tree[1]->OutputNodeVarType() <<
+				std::endl <<
+			Indent() << "{" << std::endl;
+
+		Instance = Tree[1]->Tree[0]->Expression();
+		Layout = Tree[1]->Tree[1]->OutputNodeVarType();
+	}
+	else
+	{
+		os <<
+			Indent() << "class " << ThisVar->GetName(1) <<
+				"_C" << std::endl <<
+			Indent() << "{" << std::endl <<
+			Indent() << "public:" << std::endl;
+
+		Level++;
+
+		if (Tree[1] != 0)
+		{
+			Tree[1]->OutputDefinitionList(os, 0, 0);
+			Layout = Tree[1]->CommonLayout();
+		}
+
+		Level--;
+		Instance = ThisVar->GetName(1);
+	}
+
+	if (Type == BAS_S_COMMON)
+	{
+		os <<
+			Indent() << "};" << std::endl <<
+			Indent() << ThisVar->GetName(1) << "_C &" << Instance <<
+				" = basic::ChainCommon<" << ThisVar->GetName(1) <<
+				"_C>(\"" << ThisVar->GetName(1) << "\", \"" <<
+				Layout << "\");" << std::endl <<
+			std::endl;
+	}
+	else
+	{
+		os <<
+			Indent() << "} " << Instance << ";" << std::endl <<
+			std::endl;
+	}
+
+//	os << "// #pragma psect end " << ThisVar->GetName() << std::endl;
+}
+
+/**
+ * \brief Describe the layout of a COMMON
+ *
+ *	Lists the C++ types of the members of a COMMON, so that the
+ *	runtime can tell whether the program it CHAINs to declares
+ *	the same COMMON the same way.
+ *
+ * \return comma separated list of types.
+ */
+std::string Node::CommonLayout(void)
+{
+	std::string result;
+
+	switch(Type)
+	{
+	case BAS_N_LIST:
+		if (Tree[0] != 0)
+		{
+			result = Tree[0]->CommonLayout();
+		}
+		if (Tree[1] != 0)
+		{
+			result += Tree[1]->CommonLayout();
+		}
+		return result;
+
+	case BAS_V_DEFINEVAR:
+		if (Tree[2] != 0)
+		{
+			result = Tree[2]->OutputArrayDef(this);
+		}
+		else if (Tree[1] != 0)
+		{
+			result = Tree[1]->OutputNodeVarType();
+		}
+		result += ",";
+		break;
+
+	default:
+		break;
+	}
+
+	if (Block[0] != 0)
+	{
+		result += Block[0]->CommonLayout();
+	}
+	return result;
+}
+
+/**
+ * \brief Work out how one member of a MAP/COMMON is stored
+ *
+ *	Gives the C++ type of one element of the member (empty for
+ *	a string), the size of that element in bytes, and how many
+ *	elements there are.
+ *
+ *	Floating point members are stored in the VAX formats, so the
+ *	type is followed by the storage format to use.
+ *
+ * \return 1 if the member can be laid out byte for byte, 0 if
+ *	it has to be left to the C++ compiler.
+ */
+int Node::MapMember(
+	std::string &CType,	/**< Returned C++ type of an element */
+	long &Size,		/**< Returned bytes in an element */
+	long &Count		/**< Returned number of elements */
+)
+{
+	long long Value;
+
+	if ((Type != BAS_V_DEFINEVAR) || (Tree[0] == 0) || (Tree[1] == 0))
+	{
+		return 0;
+	}
+
+	CType = "";
+	switch (Tree[1]->Type)
+	{
+	case BAS_S_BYTE:
+		CType = "int8_t";
+		Size = 1;
+		break;
+
+	case BAS_S_WORD:
+		CType = "int16_t";
+		Size = 2;
+		break;
+
+	case BAS_S_LONG:
+		CType = "int32_t";
+		Size = 4;
+		break;
+
+	case BAS_S_INTEGER:
+		if (IntegerType == VARTYPE_WORD)
+		{
+			CType = "int16_t";
+			Size = 2;
+		}
+		else
+		{
+			CType = "int32_t";
+			Size = 4;
+		}
+		break;
+
+	case BAS_S_SINGLE:
+		CType = "float, basic::FfloatStorage";
+		Size = 4;
+		break;
+
+	case BAS_S_REAL:
+		if (RealType == VARTYPE_SINGLE)
+		{
+			CType = "float, basic::FfloatStorage";
+			Size = 4;
+		}
+		else
+		{
+			CType = "double, basic::DfloatStorage";
+			Size = 8;
+		}
+		break;
+
+	case BAS_S_DOUBLE:
+		CType = "double, basic::DfloatStorage";
+		Size = 8;
+		break;
+
+	case BAS_S_GFLOAT:
+		CType = "double, basic::GfloatStorage";
+		Size = 8;
+		break;
+
+	case BAS_S_STRING:
+		//
+		// Strings in a MAP default to 16 characters
+		//
+		Size = 16;
+		if (Tree[3] != 0)
+		{
+			if (!CaseValue(Tree[3], Value) || (Value < 0))
+			{
+				return 0;
+			}
+			Size = Value;
+		}
+		break;
+
+	case BAS_S_DECIMAL:
+		//
+		// Packed decimal, P digits and a sign nibble
+		//
+		{
+			long long Precision = 15;
+			long long Scale = 2;
+			Node *Sizes = Tree[1]->Tree[4];
+
+			if (Sizes != 0)
+			{
+				if ((Sizes->Type != BAS_N_LIST) ||
+					!CaseValue(Sizes->Tree[0], Precision) ||
+					!CaseValue(Sizes->Tree[1], Scale))
+				{
+					return 0;
+				}
+			}
+			CType = "basic::Decimal<" + std::to_string(Precision) +
+				", " + std::to_string(Scale) + ">, basic::PackedStorage<" +
+				std::to_string(Precision) + ", " +
+				std::to_string(Scale) + ">";
+			Size = Precision / 2 + 1;
+		}
+		break;
+
+	default:
+		//
+		// HFLOAT, RFA and RECORDs
+		//
+		return 0;
+	}
 
-		default:
-			//
-			// Force quotes around data value
-			//
-			os << '"' << Expression() << '"';
-			DataWidth +=Expression().length() + 2;
-			break;
+	//
+	// Only simple one dimensional arrays for now
+	//
+	Count = 1;
+	if (Tree[2] != 0)
+	{
+		if ((Tree[2]->Block[0] != 0) ||
+			!CaseValue(Tree[2], Value) || (Value < 0))
+		{
+			return 0;
 		}
+		Count = Value + 1;
 	}
+
+	return 1;
 }
 
 /**
- * \brief Outputs a map or common statement.
- *
- *	This function will mangle a map or common statement.
+ * \brief Is this MAP/COMMON member just padding (FILL, FILL$, FILL%)
  */
-void Node::OutputMap(
-	std::ostream& os		/**< iostream to write C++ code to */
-)
+int Node::IsMapFill(void)
 {
-	VariableStruct* ThisVar = Variables->Lookup(Tree[0]->TextValue, 0);
-
-	os << std::endl << Indent() <<
-		"// #pragma psect static_rw " << ThisVar->GetName(1) <<
-		",gbl,ovr" << std::endl;
+	return (Tree[0] != 0) &&
+		((Tree[0]->TextValue == "FILL") ||
+		(Tree[0]->TextValue == "FILL$") ||
+		(Tree[0]->TextValue == "FILL%"));
+}
 
-	//
-	// We implement MAP and COMMON as classes because dealing with
-	// their weirdness will be easier by creating methods in a base
-	// class than putting stuff in the actual source. It should also
-	// make putting everything in a common place simpler.
-	//
-	// Here we try to 'roll up' a MAP statement of the form
-	//	MAP (my_map) my_regord my_var
-	// into a shorder form than more comples MAPs. It means we can
-	// rever to the values as 'my_var.value' instead of
-	// 'my_map.my_var.value'.
-	// Similiar code must exist in program.cc arount the prefix
-	// generating code
-	//
-	if ((Tree[1]->Type == BAS_V_DEFINEVAR) && (Tree[1]->Block[0] == 0))
-	{
-		os <<
-			Indent() << "class " << ThisVar->GetName(1) <<
-				"_C : public " <<
-				Tree[1]->Tree[1]->OutputNodeVarType() <<
-				std::endl <<
-			Indent() << "{" << std::endl;
+/**
+ * \brief Decide if a MAP/COMMON can be laid out byte for byte
+ *
+ * \return Size of the MAP/COMMON in bytes, or -1 if some member
+ *	can't be laid out that way.
+ */
+long Node::MapPacked(void)
+{
+	long Total = 0;
 
-		std::cout <<
-			Indent() << "} " << Tree[1]->Tree[0]->Expression() <<
-				";" << std::endl <<
-			std::endl;
-	}
-	else
+	for (Node* Member = Tree[1]; Member != 0; Member = Member->Block[0])
 	{
-		os <<
-			Indent() << "class " << ThisVar->GetName(1) <<
-				"_C" << std::endl <<
-			Indent() << "{" << std::endl <<
-			Indent() << "public:" << std::endl;
-
-		Level++;
+		std::string CType;
+		long Size;
+		long Count;
 
-		if (Tree[1] != 0)
+		if (!Member->MapMember(CType, Size, Count))
 		{
-			Tree[1]->OutputDefinitionList(os, 0, 0);
+			return -1;
 		}
-
-		Level--;
-		std::cout <<
-			Indent() << "} " << ThisVar->GetName(1) << ";" << std::endl <<
-			std::endl;
+		Total += Size * Count;
 	}
-
-//	os << "// #pragma psect end " << ThisVar->GetName() << std::endl;
+	return Total;
 }
 
 /**
@@ -3580,6 +5006,16 @@ void Node::OutputCaseLabel(
 		return;
 	}
 
+	//
+	// Ranges use the gcc/clang case range extension
+	//
+	if (Type == BAS_S_TO)
+	{
+		os << Indent() << "case " << Tree[0]->Expression() << " ... " <<
+			Tree[1]->Expression() << ":" << std::endl;
+		return;
+	}
+
 	//
 	// Output one case statement
 	//
@@ -3659,6 +5095,7 @@ int Node::CheckCaseLabel(void)
 	switch (Type)
 	{
 	case BAS_S_REMARK:
+	case BAS_V_LABEL:
 		if (Block[0])
 		{
 			return Block[0]->CheckCaseLabel();
@@ -3667,7 +5104,7 @@ int Node::CheckCaseLabel(void)
 
 	case BAS_S_CASE:
 
-		if (Tree[0]->CheckCaseLabel())
+		if ((Tree[0] == 0) || Tree[0]->CheckCaseLabel())
 		{
 			return 1;
 		}
@@ -3695,18 +5132,246 @@ int Node::CheckCaseLabel(void)
 	case BAS_X_UNARYGE:
 	case BAS_X_UNARYNEQ:
 		return 1;
+
+	case BAS_S_TO:
+		//
+		// Ranges of constants can be case ranges
+		//
+		if (Tree[0]->CheckCaseLabel() || Tree[1]->CheckCaseLabel())
+		{
+			return 1;
+		}
+		return 0;
 	}
 
+	//
+	// Case labels must be integer constants
+	//
 	int ThisType = GetNodeVarType();
 	switch (ThisType)
 	{
 	case VARTYPE_INTEGER:
-		return 0;
+		if (IsConstantNumber())
+		{
+			return 0;
+		}
+		return 1;
 	default:
 		return 1;
 	}
 }
 
+/**
+ * \brief Test for a select on string literals.
+ *
+ *	Returns true if every CASE in the list is one or more
+ *	string literals (no relations or ranges), so that the
+ *	select can be done with a hash.
+ */
+int Node::CheckCaseString(void)
+{
+	int LabelCount = 0;
+
+	for (Node *LookDown = this; LookDown != 0; LookDown = LookDown->Block[0])
+	{
+		switch (LookDown->Type)
+		{
+		case BAS_S_REMARK:
+		case BAS_V_LABEL:
+		case BAS_N_CASEELSE:
+			break;
+
+		case BAS_S_CASE:
+			if (LookDown->Tree[0] == 0)
+			{
+				return 0;
+			}
+			for (Node *Label = LookDown->Tree[0]; Label != 0; )
+			{
+				Node *ThisLabel = Label;
+				std::string Text;
+
+				if (Label->Type == BAS_N_LIST)
+				{
+					ThisLabel = Label->Tree[0];
+					Label = Label->Tree[1];
+				}
+				else
+				{
+					Label = 0;
+				}
+
+				if ((ThisLabel == 0) ||
+					(ThisLabel->Type != BAS_V_TEXTSTRING) ||
+					!LiteralText(ThisLabel->TextValue, Text))
+				{
+					return 0;
+				}
+				LabelCount++;
+			}
+			break;
+
+		default:
+			return 0;
+		}
+	}
+
+	return LabelCount != 0;
+}
+
+/**
+ * \brief Output a select on string literals as a hashed switch.
+ *
+ *	Each label is hashed here using the same function as
+ *	basic::SelectHash, choosing a seed so that no two labels have
+ *	the same hash. The selector is hashed once at run time,
+ *	switched on, and checked against the one label that could
+ *	match. A second switch then runs the selected case.
+ */
+void Node::OutputCaseHash(
+	std::ostream& os	/**< iostream to write C++ code to */
+)
+{
+	std::vector<std::string> Labels;	// Text of each label
+	std::vector<Node*> LabelNode;		// Node for each label
+	std::vector<int> LabelCase;		// Case number of each label
+	std::vector<unsigned long> Hashes;	// Hash of each label
+	unsigned long Seed;			// Seed for hash
+	int CaseNumber = 0;
+	char Buffer[32];
+
+	//
+	// Collect the labels. Duplicates go to the first case,
+	// just like the chain of if's would.
+	//
+	for (Node *LookDown = Block[1]; LookDown != 0; LookDown = LookDown->Block[0])
+	{
+		if (LookDown->Type != BAS_S_CASE)
+		{
+			continue;
+		}
+		CaseNumber++;
+
+		for (Node *Label = LookDown->Tree[0]; Label != 0; )
+		{
+			Node *ThisLabel = Label;
+			std::string Text;
+
+			if (Label->Type == BAS_N_LIST)
+			{
+				ThisLabel = Label->Tree[0];
+				Label = Label->Tree[1];
+			}
+			else
+			{
+				Label = 0;
+			}
+
+			LiteralText(ThisLabel->TextValue, Text);
+			if (std::find(Labels.begin(), Labels.end(), Text) ==
+				Labels.end())
+			{
+				Labels.push_back(Text);
+				LabelNode.push_back(ThisLabel);
+				LabelCase.push_back(CaseNumber);
+			}
+		}
+	}
+
+	//
+	// Find a seed that gives every label its own hash
+	//
+	for (Seed = 0; ; Seed++)
+	{
+		Hashes.clear();
+		for (size_t loop = 0; loop < Labels.size(); loop++)
+		{
+			Hashes.push_back(SelectHash(Labels[loop], Seed));
+		}
+
+		std::vector<unsigned long> Sorted(Hashes);
+		std::sort(Sorted.begin(), Sorted.end());
+		if (std::adjacent_find(Sorted.begin(), Sorted.end()) ==
+			Sorted.end())
+		{
+			break;
+		}
+	}
+
+	os << Indent() <<
+		"// ** Converted from a select statement **" <<
+		std::endl;
+	os << Indent() << "{" << std::endl;
+	Level++;
+	os << Indent() << "const std::string &TempS = " <<
+		Tree[0]->Expression() << ";" << std::endl;
+	os << Indent() << "int TempC = 0;" << std::endl;
+
+	//
+	// Pick the case
+	//
+	sprintf(Buffer, "%luUL", Seed);
+	os << Indent() << "switch (basic::SelectHash(TempS, " << Buffer <<
+		"))" << std::endl;
+	os << Indent() << "{" << std::endl;
+	for (size_t loop = 0; loop < Labels.size(); loop++)
+	{
+		sprintf(Buffer, "0x%08lxUL", Hashes[loop]);
+		os << Indent() << "case " << Buffer << ":" << std::endl;
+		Level++;
+		os << Indent() << "if (TempS == " <<
+			LabelNode[loop]->TextValue << ")" << std::endl;
+		os << Indent() << "{" << std::endl;
+		os << Indent() << "\tTempC = " << LabelCase[loop] << ";" <<
+			std::endl;
+		os << Indent() << "}" << std::endl;
+		os << Indent() << "break;" << std::endl;
+		Level--;
+	}
+	os << Indent() << "}" << std::endl;
+
+	//
+	// Run the case
+	//
+	os << Indent() << "switch (TempC)" << std::endl;
+	os << Indent() << "{" << std::endl;
+	CaseNumber = 0;
+	for (Node *LookDown = Block[1]; LookDown != 0; LookDown = LookDown->Block[0])
+	{
+		switch (LookDown->Type)
+		{
+		case BAS_S_REMARK:
+			os << Indent();
+			LookDown->OutputRemark(os);
+			continue;
+
+		case BAS_V_LABEL:
+			LookDown->OutputCodeOne(os);
+			continue;
+
+		case BAS_S_CASE:
+			os << Indent() << "case " << ++CaseNumber << ":" << std::endl;
+			break;
+
+		default:
+			os << Indent() << "default:" << std::endl;
+			break;
+		}
+
+		Level++;
+		if (LookDown->Block[1] != 0)
+		{
+			LookDown->Block[1]->OutputCode(os);
+		}
+		os << Indent() << "break;" << std::endl << std::endl;
+		Level--;
+	}
+	os << Indent() << "}" << std::endl;
+
+	Level--;
+	os << Indent() << "}" << std::endl;
+}
+
 
 /**
  * \brief Prints out a comment.
@@ -4242,7 +5907,7 @@ std::string Node::OutputDefinitionParams(
 		break;
 
 	default:
-std::cerr << "Something isn't using BAS_V_DEFINE??? (default) @ " << lineno << std::endl;
+*ErrorFile << "Something isn't using BAS_V_DEFINE??? (default) @ " << lineno << std::endl;
 		result += "const " + OutputDefinition(MainType, ExtType);
 		break;
 	}
@@ -4893,17 +6558,28 @@ void Node::OutputOpenStuff(
 
 		os << Indent() <<
 			GetIPChannel(Channel, 0) <<
-			".SetConnect(BasicChannel[" << Tree[0]->Expression() << "]);" <<
+			".SetConnect(basic::Context().Channel[" << Tree[0]->Expression() << "]);" <<
 			std::endl;
 		break;
 
 	case BAS_S_MAP:
+		{
+			//
+			// A byte exact MAP is found by name
+			//
+			std::string MapName = Tree[0]->Expression();
+			if (MapSizes.find(Tree[0]->TextValue) != MapSizes.end())
+			{
+				MapName = "basic::MapBuffer(\"" +
+					Tree[0]->TextValue + "\")";
+			}
 
-		os << Indent() <<
-			GetIPChannel(Channel, 0) <<
-			".SetMap(" << Tree[0]->Expression() << ", sizeof(" <<
-			Tree[0]->Expression() <<
-			"));" << std::endl;
+			os << Indent() <<
+				GetIPChannel(Channel, 0) <<
+				".SetMap(basic::MapData(" << MapName <<
+				"), basic::MapSize(" << MapName <<
+				"));" << std::endl;
+		}
 		break;
 
 	case BAS_S_RECORDTYPE:
@@ -4975,7 +6651,14 @@ std::string Node::OutputBstringText(void)
 	switch(Type)
 	{
 	case BAS_V_TEXTSTRING:
-		result = "std::string(" + Expression() + ")";
+		if (IsReallyString())
+		{
+			result = InternLiteral(TextValue);
+		}
+		else
+		{
+			result = "std::string(" + Expression() + ")";
+		}
 		break;
 
 	default:
@@ -4986,6 +6669,52 @@ std::string Node::OutputBstringText(void)
 	return result;
 }
 
+/**
+ * \brief Output an expression whose value is only looked at
+ *
+ *	Used where a string is compared, searched, or appended to
+ *	something else. LEFT$, RIGHT$, MID$, SEG$ and TRM$ are output
+ *	as their basic::string_view versions here, so they don't
+ *	build a new string. Anything else is output as normal.
+ */
+std::string Node::ViewExpression(void)
+{
+	std::string Name = SubstringCall(this);
+
+	if (Name == "")
+	{
+		return Expression();
+	}
+	return Name + "_view(" + Tree[0]->ViewArguments() + ")";
+}
+
+/**
+ * \brief ViewExpression, for a function argument
+ *
+ *	The commas around an argument already delimit it, so its
+ *	outer parentheses can be dropped.
+ */
+std::string Node::ViewArgument(void)
+{
+	if (SubstringCall(this) == "")
+	{
+		return NoParen();
+	}
+	return ViewExpression();
+}
+
+/**
+ * \brief Output the arguments of a function taking string views
+ */
+std::string Node::ViewArguments(void)
+{
+	if ((Type == BAS_N_LIST) && (Tree[0] != 0) && (Tree[1] != 0))
+	{
+		return Tree[0]->ViewArgument() + ", " + Tree[1]->ViewArguments();
+	}
+	return ViewArgument();
+}
+
 /**
  * \brief Output an integer/number
  *
@@ -5244,6 +6973,22 @@ std::string Node::OutputNodeVarType(void)
 		result = genname(TextValue);
 		break;
 
+	case BAS_S_DECIMAL:
+		//
+		// DECIMAL(p,s) carries its size in Tree[4]
+		//
+		if ((Tree[4] != 0) && (Tree[4]->Type == BAS_N_LIST) &&
+			(Tree[4]->Tree[0] != 0) && (Tree[4]->Tree[1] != 0))
+		{
+			result = "basic::Decimal<" + Tree[4]->Tree[0]->Expression() +
+				", " + Tree[4]->Tree[1]->Expression() + ">";
+		}
+		else
+		{
+			result = OutputVarType(VARTYPE_DECIMAL);
+		}
+		break;
+
 	default:
 		result = OutputVarType(GetNodeVarType());
 		break;
@@ -19,6 +19,18 @@
 #include "variable.h"
 #include "varlist.h"
 #include "nodes.h"
+#include "passtime.h"
+
+/*
+ * Charge the time spent in the lexer to the lex pass (-j)
+ */
+static int TimedLex()
+{
+	PassTimer Timer(PASS_LEX);
+
+	return yylex();
+}
+#define yylex TimedLex
 
 #ifndef YYSTYPE
 #define YYSTYPE Node *
@@ -883,6 +895,7 @@ paramlist:	/* Empty */ { $$ = 0; }
 			$$ = $2->Link($1, $3); }
 		| nullexpr ',' paramlist { $2->Type = BAS_N_LIST;
 			$$ = $2->Link($1, $3); }
+		| BAS_S_WAIT expression { $$ = $2; delete $1; }
 ;
 
 caseexprlist:	caseexpression
@@ -1069,8 +1082,8 @@ vartypetwo:	BAS_S_INTEGER
 		| BAS_S_STRING
 		| BAS_S_RFA
 		| BAS_S_DECIMAL
-		| BAS_S_DECIMAL '(' exprlist ')' { delete $2;
-			delete $4; delete $3; $$ = $1; }
+		| BAS_S_DECIMAL '(' exprlist ')' {
+			$$ = $1->Link(0, 0, 0, 0, $3); delete $2; delete $4; }
 ;
 
 fundeflist:	fundef
@@ -1319,10 +1332,10 @@ fielditem:	expression BAS_S_AS variablex { $$ = $2->Link($1, $3); }
  */
 int yyerror(char *s)
 {
-	std::cerr << "Parse error: " << s << " near line " << xline << std::endl;
+	*ErrorFile << "Parse error: " << s << " near line " << xline << std::endl;
 	if (include_stack_pointer > 0)
 	{
-		std::cerr << " in included file " <<
+		*ErrorFile << " in included file " <<
 			include_name[include_stack_pointer - 1] << std::endl;
 	}
 	return 0;
@@ -0,0 +1,39 @@
+/**\file passnew.cc
+ * \brief Count memory allocations for the pass report
+ *
+ *	Replaces the global operator new, so the -j report can
+ *	show the allocations made by each pass. Part of the btran
+ *	program only, not the translator library, so a program
+ *	using the library doesn't get its operator new replaced.
+ */
+
+//
+// System Include Files
+//
+#include <cstdlib>
+#include <new>
+
+//
+// Project Include Files
+//
+#include "passtime.h"
+
+//
+// Count allocations. The default new[] and sized delete
+// call these.
+//
+void* operator new(size_t Size)
+{
+	PassAllocations++;
+	void* Result = malloc(Size == 0 ? 1 : Size);
+	if (Result == 0)
+	{
+		throw std::bad_alloc();
+	}
+	return Result;
+}
+
+void operator delete(void* Pointer) noexcept
+{
+	free(Pointer);
+}
@@ -0,0 +1,315 @@
+/**\file passtime.cc
+ * \brief Time and memory used by each pass of the translator
+ *
+ *	Enabled with the -j option, which writes a JSON report of
+ *	the wall time, CPU time, memory allocations and memory
+ *	growth of each pass, for each file and in total.
+ *
+ *	Memory growth comes from the peak resident set size, which
+ *	is only read when a pass other than the lexer starts or
+ *	stops (it costs a system call, and the lexer is called
+ *	once per token), so what the lexer adds shows up under the
+ *	parser.
+ *
+ *	Reading the CPU clock is a system call too, so timing the
+ *	lexer makes the whole run somewhat slower than it would be
+ *	without -j. Compare passes with each other, not with runs
+ *	without the report.
+ *
+ *	Allocations are counted by the operator new in passnew.cc,
+ *	which only the btran program links in. A program using the
+ *	translator library keeps its own, and sees no allocations.
+ */
+
+//
+// System Include Files
+//
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <time.h>
+#include <sys/resource.h>
+
+//
+// Project Include Files
+//
+#include "passtime.h"
+
+/**
+ * \brief Names of the passes in the report
+ */
+static const char* PassName[PASS_COUNT] =
+{
+	"lex", "parse", "scan_for_loops", "move_functions",
+	"variable_fixup", "output"
+};
+
+/**
+ * \brief Resources used by a pass
+ */
+struct PassCost
+{
+	long Calls;		/**< \brief Times the pass was entered */
+	double Wall;		/**< \brief Wall time (seconds) */
+	double Cpu;		/**< \brief CPU time (seconds) */
+	long Allocations;	/**< \brief Memory allocations */
+	long RssGrowth;		/**< \brief Growth of peak RSS (KB) */
+};
+
+/**
+ * \brief Measurements for one source file
+ */
+struct FileReport
+{
+	std::string Name;		/**< \brief Source file name */
+	PassCost Cost[PASS_COUNT];	/**< \brief Cost of each pass */
+	long PeakRss;			/**< \brief Peak RSS at the end (KB) */
+};
+
+/**
+ * \brief A reading of the clocks and counters
+ */
+struct Snapshot
+{
+	double Wall;		/**< \brief Wall clock (seconds) */
+	double Cpu;		/**< \brief Process CPU time (seconds) */
+	long Allocations;	/**< \brief Allocations so far */
+	long Rss;		/**< \brief Peak RSS so far (KB) */
+};
+
+long PassAllocations = 0;		/**< \brief operator new calls */
+static std::vector<FileReport> Files;	/**< \brief One per source file */
+static PassType Running[64];		/**< \brief Stack of running passes */
+static int Depth = 0;			/**< \brief Passes running */
+static Snapshot Last;			/**< \brief When the top pass was last charged */
+
+/**
+ * \brief Peak resident set size so far
+ */
+static long PeakRss()
+{
+	struct rusage Usage;
+
+	getrusage(RUSAGE_SELF, &Usage);
+	return Usage.ru_maxrss;
+}
+
+/**
+ * \brief Read the clocks
+ */
+static Snapshot Take(
+	int WithRss		/**< Read the RSS too */
+)
+{
+	Snapshot Result;
+	struct timespec Cpu;
+
+	Result.Wall = std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &Cpu);
+	Result.Cpu = Cpu.tv_sec + Cpu.tv_nsec / 1e9;
+	Result.Allocations = PassAllocations;
+	Result.Rss = WithRss ? PeakRss() : Last.Rss;
+	return Result;
+}
+
+/**
+ * \brief Charge everything since the last reading to the top pass
+ */
+static void Charge(
+	const Snapshot &Now	/**< Current reading */
+)
+{
+	if ((Depth > 0) && !Files.empty())
+	{
+		PassCost &Cost = Files.back().Cost[Running[Depth - 1]];
+
+		Cost.Wall += Now.Wall - Last.Wall;
+		Cost.Cpu += Now.Cpu - Last.Cpu;
+		Cost.Allocations += Now.Allocations - Last.Allocations;
+		Cost.RssGrowth += Now.Rss - Last.Rss;
+	}
+	Last = Now;
+}
+
+/**
+ * \brief Start charging to a pass
+ */
+void PassTimer::Start(
+	PassType Pass		/**< Pass to charge */
+)
+{
+	Charge(Take(Pass != PASS_LEX));
+	if (Depth < (int)(sizeof(Running) / sizeof(Running[0])))
+	{
+		Running[Depth++] = Pass;
+		if (!Files.empty())
+		{
+			Files.back().Cost[Pass].Calls++;
+		}
+	}
+}
+
+/**
+ * \brief Go back to charging the enclosing pass
+ */
+void PassTimer::Stop()
+{
+	if (Depth > 0)
+	{
+		Charge(Take(Running[Depth - 1] != PASS_LEX));
+		Depth--;
+	}
+}
+
+/**
+ * \brief Start measuring a new source file
+ */
+void PassReportFile(
+	const std::string &FileName	/**< Source file name */
+)
+{
+	FileReport Report;
+
+	Report.Name = FileName;
+	for (int Pass = 0; Pass < PASS_COUNT; Pass++)
+	{
+		Report.Cost[Pass] = PassCost();
+	}
+	Report.PeakRss = 0;
+
+	if (!Files.empty())
+	{
+		Files.back().PeakRss = PeakRss();
+	}
+	Files.push_back(Report);
+	Last = Take(1);
+}
+
+/**
+ * \brief Write a string as a JSON string
+ */
+static void JsonString(
+	std::ostream &os,		/**< Stream to write to */
+	const std::string &Text		/**< String */
+)
+{
+	os << '"';
+	for (std::string::size_type loop = 0; loop < Text.size(); loop++)
+	{
+		unsigned char Ch = Text[loop];
+
+		if ((Ch == '"') || (Ch == '\\'))
+		{
+			os << '\\' << Ch;
+		}
+		else if (Ch < ' ')
+		{
+			os << "\\u" << std::hex << std::setw(4) <<
+				std::setfill('0') << (int)Ch << std::dec;
+		}
+		else
+		{
+			os << Ch;
+		}
+	}
+	os << '"';
+}
+
+/**
+ * \brief Write the passes of one file (or the total) as JSON
+ */
+static void JsonCosts(
+	std::ostream &os,		/**< Stream to write to */
+	const PassCost *Cost,		/**< Cost of each pass */
+	long Peak,			/**< Peak RSS (KB) */
+	const char* Indent		/**< Indentation */
+)
+{
+	PassCost Sum = PassCost();
+
+	os << Indent << "\"peak_rss_kb\": " << Peak << ",\n" <<
+		Indent << "\"passes\": {\n";
+	for (int Pass = 0; Pass < PASS_COUNT; Pass++)
+	{
+		os << Indent << "\t\"" << PassName[Pass] << "\": { " <<
+			"\"calls\": " << Cost[Pass].Calls << ", " <<
+			"\"wall_ms\": " << Cost[Pass].Wall * 1000.0 << ", " <<
+			"\"cpu_ms\": " << Cost[Pass].Cpu * 1000.0 << ", " <<
+			"\"allocations\": " << Cost[Pass].Allocations << ", " <<
+			"\"rss_growth_kb\": " << Cost[Pass].RssGrowth << " }" <<
+			(Pass + 1 < PASS_COUNT ? ",\n" : "\n");
+
+		Sum.Wall += Cost[Pass].Wall;
+		Sum.Cpu += Cost[Pass].Cpu;
+		Sum.Allocations += Cost[Pass].Allocations;
+	}
+	os << Indent << "},\n" <<
+		Indent << "\"total\": { " <<
+		"\"wall_ms\": " << Sum.Wall * 1000.0 << ", " <<
+		"\"cpu_ms\": " << Sum.Cpu * 1000.0 << ", " <<
+		"\"allocations\": " << Sum.Allocations << " }\n";
+}
+
+/**
+ * \brief Write the report
+ *
+ *	A report name of "-" writes it to standard error.
+ */
+void PassReportWrite(
+	const std::string &ReportName	/**< File to write the report to */
+)
+{
+	std::ofstream ReportFile;
+	std::ostream *os = &std::cerr;
+
+	if (ReportName != "-")
+	{
+		ReportFile.open(ReportName.c_str());
+		if (!ReportFile.is_open())
+		{
+			std::cerr << "Unable to open " << ReportName <<
+				" for output" << std::endl;
+			return;
+		}
+		os = &ReportFile;
+	}
+
+	if (!Files.empty())
+	{
+		Files.back().PeakRss = PeakRss();
+	}
+
+	PassCost Total[PASS_COUNT];
+	for (int Pass = 0; Pass < PASS_COUNT; Pass++)
+	{
+		Total[Pass] = PassCost();
+	}
+
+	*os << std::fixed << std::setprecision(3) << "{\n\t\"files\": [\n";
+	for (std::vector<FileReport>::size_type loop = 0;
+		loop < Files.size(); loop++)
+	{
+		*os << "\t\t{\n\t\t\t\"file\": ";
+		JsonString(*os, Files[loop].Name);
+		*os << ",\n";
+		JsonCosts(*os, Files[loop].Cost, Files[loop].PeakRss, "\t\t\t");
+		*os << "\t\t}" << (loop + 1 < Files.size() ? ",\n" : "\n");
+
+		for (int Pass = 0; Pass < PASS_COUNT; Pass++)
+		{
+			Total[Pass].Calls += Files[loop].Cost[Pass].Calls;
+			Total[Pass].Wall += Files[loop].Cost[Pass].Wall;
+			Total[Pass].Cpu += Files[loop].Cost[Pass].Cpu;
+			Total[Pass].Allocations += Files[loop].Cost[Pass].Allocations;
+			Total[Pass].RssGrowth += Files[loop].Cost[Pass].RssGrowth;
+		}
+	}
+	*os << "\t],\n\t\"all\": {\n";
+	JsonCosts(*os, Total, PeakRss(), "\t\t");
+	*os << "\t}\n}\n";
+}
@@ -0,0 +1,73 @@
+/**\file passtime.h
+ * \brief Time and memory used by each pass of the translator
+ *
+ *	Each pass is bracketed by a PassTimer. Passes nest (the
+ *	parser calls the lexer, and everything after the parse is
+ *	called from inside the parser), so the time and memory are
+ *	charged to the innermost pass running, and each pass gets
+ *	only what it used itself.
+ */
+#ifndef _PASSTIME_H_
+#define _PASSTIME_H_
+
+#include <string>
+
+/**
+ * \brief Translator passes
+ */
+enum PassType
+{
+	PASS_LEX,		/**< \brief Lexing (yylex) */
+	PASS_PARSE,		/**< \brief Parsing (yyparse) */
+	PASS_LOOPS,		/**< \brief ScanForLoops */
+	PASS_FUNCTIONS,		/**< \brief MoveFunctions */
+	PASS_FIXUP,		/**< \brief Variable scan, fixup and narrowing */
+	PASS_OUTPUT,		/**< \brief Writing the C++ code */
+	PASS_COUNT		/**< \brief Number of passes */
+};
+
+extern int PassReport;		/**< \brief Are passes being measured */
+extern long PassAllocations;	/**< \brief Allocations so far (counted by passnew.cc) */
+
+/**
+ * \brief Charge what happens in a scope to a pass
+ */
+class PassTimer
+{
+private:
+	int Active;		/**< \brief Was this timer started */
+
+public:
+	void Start(PassType Pass);
+	void Stop();
+
+	/**
+	 * \brief Start timing a pass
+	 */
+	explicit PassTimer(
+		PassType Pass		/**< Pass to charge */
+	)
+	{
+		Active = PassReport;
+		if (Active)
+		{
+			Start(Pass);
+		}
+	}
+
+	/**
+	 * \brief Stop timing, and go back to the enclosing pass
+	 */
+	~PassTimer()
+	{
+		if (Active)
+		{
+			Stop();
+		}
+	}
+};
+
+void PassReportFile(const std::string &FileName);
+void PassReportWrite(const std::string &ReportName);
+
+#endif
@@ -30,6 +30,7 @@
 #include "varlist.h"
 #include "nodes.h"
 #include "parse.hh"
+#include "passtime.h"
 
 //
 // Module Function Prototypes
@@ -85,7 +86,10 @@ void DoProgram(
 	{
 		std::cerr << "Scanning for loops" << std::endl;
 	}
-	BeginProgram = ScanForLoops(BeginProgram);
+	{
+		PassTimer Timer(PASS_LOOPS);
+		BeginProgram = ScanForLoops(BeginProgram);
+	}
 
 	if (DebugDumpOne)
 	{
@@ -101,7 +105,18 @@ void DoProgram(
 	{
 		std::cerr << "Move Local Functions" << std::endl;
 	}
-	BeginProgram = MoveFunctions(BeginProgram);
+	{
+		PassTimer Timer(PASS_FUNCTIONS);
+		BeginProgram = MoveFunctions(BeginProgram);
+	}
+
+	//
+	// Size the byte exact MAP/COMMON areas before any routine
+	// is written, so each is created at its full size
+	//
+	MapSizes.clear();
+	MapMembers.clear();
+	BeginProgram->ScanMapSizes();
 
 	//
 	// Output the translated code
@@ -116,7 +131,10 @@ void DoProgram(
 		std::cout << std::endl << "*** Dump After Function Scan ***" << std::endl;
 		BeginProgram->PrintTree();
 	}
-	BeginProgram->Output(*OutFile);
+	{
+		PassTimer Timer(PASS_OUTPUT);
+		BeginProgram->Output(*OutFile);
+	}
 
 	//
 	// Free up all memory allocated
@@ -227,7 +245,7 @@ static Node *ScanForLoops
 			}
 			else
 			{
-				std::cerr << "Missing IF for ELSE" << std::endl;
+				*ErrorFile << "Missing IF for ELSE" << std::endl;
 			}
 
 			goto reloop;
@@ -257,7 +275,7 @@ static Node *ScanForLoops
 			}
 			else
 			{
-				std::cerr << "Missing WHEN ERROR IN for USE" << std::endl;
+				*ErrorFile << "Missing WHEN ERROR IN for USE" << std::endl;
 			}
 
 			goto reloop;
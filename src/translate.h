@@ -0,0 +1,81 @@
+/**\file translate.h
+ * \brief Translate a BASIC program to C++ in memory
+ *
+ *	The translator as a library, for programs that want to
+ *	translate without running btran: the source comes from a
+ *	string, %INCLUDE files come from a callback, and the C++
+ *	code and the messages come back as strings. No files are
+ *	read or written.
+ *
+ *	The translator keeps its tables in global variables, so
+ *	only one translation runs at a time. Translate() waits for
+ *	any other thread that is using it.
+ */
+#ifndef _TRANSLATE_H_
+#define _TRANSLATE_H_
+
+//
+// Include files
+//
+#include <functional>
+#include <string>
+
+/**
+ * \brief Find the text of a %INCLUDE file
+ *
+ *	Called with the name as written in the source (without the
+ *	quotes, and with any VMS device and directory left on).
+ *	Fills in the text of the file, and returns false if it
+ *	can't be found. ResolvedName starts out as the name, and
+ *	can be changed to what messages, #line directives and the
+ *	line profile should call the file.
+ */
+typedef std::function<bool(const std::string& Name,
+	std::string& Text, std::string& ResolvedName)> IncludeResolver;
+
+/**
+ * \brief How to translate, as the btran options would set it
+ */
+struct TranslateOptions
+{
+	std::string SourceName;	/**< \brief Name of the source, for the header and messages */
+	IncludeResolver Include;	/**< \brief Where %INCLUDE files come from (none if empty) */
+	bool KeepAllLines;	/**< \brief Keep all line numbers (-l) */
+	bool IntegerDefault;	/**< \brief Untyped variables are LONG (-i) */
+	bool Narrow;		/**< \brief Narrow integral REAL variables to LONG (not -r) */
+	bool NarrowReport;	/**< \brief List narrowed variables in the messages (-n) */
+	bool Profile;		/**< \brief Count hits and time for each line (-f) */
+	bool LineDirectives;	/**< \brief Write #line directives (-g) */
+	std::string ChainName;	/**< \brief Register for CHAIN under this name (-k) */
+	std::string CodeName;	/**< \brief What the C++ file will be called, for #line */
+
+	/**
+	 * \brief The defaults btran uses
+	 */
+	TranslateOptions()
+	{
+		SourceName = "Source";
+		KeepAllLines = false;
+		IntegerDefault = false;
+		Narrow = true;
+		NarrowReport = false;
+		Profile = false;
+		LineDirectives = false;
+		CodeName = "<translated>";
+	}
+};
+
+/**
+ * \brief What came out of a translation
+ */
+struct TranslateResult
+{
+	bool Success;		/**< \brief Did the program parse */
+	std::string Code;	/**< \brief C++ code (empty if it didn't) */
+	std::string Diagnostics;	/**< \brief Messages, one per line */
+};
+
+TranslateResult Translate(const std::string& Source,
+	const TranslateOptions& Options = TranslateOptions());
+
+#endif
@@ -433,7 +433,7 @@ std::string OutputVarType(
 
 	case VARTYPE_DECIMAL:
 //	case BAS_S_DECIMAL:
-		result = "Decimal";
+		result = "basic::Decimal<15, 2>";
 		break;
 
 	case VARTYPE_SINGLE:
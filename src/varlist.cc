@@ -537,7 +537,7 @@ void VariableList::Append(
 	{
 		if (back().find(keyname) != back().end())
 		{
-			std::cerr << "Putting in duplicate variable " << keyname << std::endl;
+			*ErrorFile << "Putting in duplicate variable " << keyname << std::endl;
 		}
 		back()[keyname] = Variable;
 	}
@@ -702,9 +702,9 @@ void VariableList::InitFunctions(void)
 	InitOneFunction("DIF$",		"basic::Dif",		VARTYPE_DYNSTR);
 	InitOneFunction("ECHO",		"basic::Echo",		VARTYPE_LONG);
 	InitOneFunction("EDIT$",	"basic::edit",		VARTYPE_DYNSTR);
-	InitOneFunction("ERR",		"Be.err",		VARTYPE_LONG, VARCLASS_NONE);
-	InitOneFunction("ERL",		"Be.erl",		VARTYPE_LONG, VARCLASS_NONE);
-	InitOneFunction("ERN$",		"Be.ern",		VARTYPE_DYNSTR, VARCLASS_NONE);
+	InitOneFunction("ERR",		"basic::err()",	VARTYPE_LONG, VARCLASS_NONE);
+	InitOneFunction("ERL",		"basic::erl()",	VARTYPE_LONG, VARCLASS_NONE);
+	InitOneFunction("ERN$",		"basic::ern()",	VARTYPE_DYNSTR, VARCLASS_NONE);
 	InitOneFunction("ERT$",		"basic::ert",		VARTYPE_DYNSTR);
 	InitOneFunction("EXP",		"basic::exp",		VARTYPE_DOUBLE);
 	InitOneFunction("FIX",		"trunc",		VARTYPE_DOUBLE);
@@ -730,10 +730,10 @@ void VariableList::InitFunctions(void)
 	InitOneFunction("NUM",		"basic::num()",		VARTYPE_DOUBLE, VARCLASS_NONE);
 	InitOneFunction("NUM2",		"basic::num2()",	VARTYPE_DOUBLE, VARCLASS_NONE);
 	InitOneFunction("NUM$",		"basic::Qnum",		VARTYPE_DYNSTR);
-	InitOneFunction("NUM1$",	"std::to_string",	VARTYPE_DYNSTR);
+	InitOneFunction("NUM1$",	"basic::Qnum1",		VARTYPE_DYNSTR);
 	InitOneFunction("ONECHR",	"basic::OneChr",	VARTYPE_LONG);
 	InitOneFunction("PLACE$",	"basic::Place",		VARTYPE_DYNSTR);
-	InitOneFunction("POS",		"basic::Ccpos",		VARTYPE_LONG);
+	InitOneFunction("POS",		"basic::pos",		VARTYPE_LONG);
 	InitOneFunction("PROD$",	"basic::Prod",		VARTYPE_DYNSTR);
 	InitOneFunction("QUO$",		"basic::Quo",		VARTYPE_DYNSTR);
 	InitOneFunction("RAD$",		"basic::Qrad",		VARTYPE_DYNSTR);
@@ -751,7 +751,7 @@ void VariableList::InitFunctions(void)
 	InitOneFunction("SQRT",		"sqrt",			VARTYPE_DOUBLE);
 	InitOneFunction("SQR",		"sqrt",			VARTYPE_DOUBLE);
 	InitOneFunction("STATUS",	"basic::status()",	VARTYPE_LONG, VARCLASS_NONE);
-	InitOneFunction("STR$",		"basic::Qnum",		VARTYPE_DYNSTR);
+	InitOneFunction("STR$",		"basic::str",		VARTYPE_DYNSTR);
 	InitOneFunction("STRING$",	"basic::Qstring",	VARTYPE_DYNSTR);
 	InitOneFunction("STR$FIND_FIRST_IN_SET",
 					"str$find_first_in_set",VARTYPE_DYNSTR);
@@ -762,9 +762,9 @@ void VariableList::InitFunctions(void)
 	InitOneFunction("TAN",		"tan",			VARTYPE_DOUBLE);
 	InitOneFunction("TIME",		"basic::Time",		VARTYPE_DOUBLE);
 	InitOneFunction("TIME$",	"basic::Qtime",		VARTYPE_DYNSTR);
-	InitOneFunction("TRM$",		"boost::trim_right_copy",	VARTYPE_DYNSTR);
-	InitOneFunction("VAL",		"std::stod",		VARTYPE_DOUBLE);
-	InitOneFunction("VAL%",		"std::stol",		VARTYPE_LONG);
+	InitOneFunction("TRM$",		"basic::trm",		VARTYPE_DYNSTR);
+	InitOneFunction("VAL",		"basic::Val",		VARTYPE_DOUBLE);
+	InitOneFunction("VAL%",		"basic::ValInteger",	VARTYPE_LONG);
 	InitOneFunction("XLATE",	"basic::Xlate",		VARTYPE_DYNSTR);
 	InitOneFunction("LIB$SIGNAL",	"exit",			VARTYPE_LONG);
 }